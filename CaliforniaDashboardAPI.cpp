@@ -1,4 +1,9 @@
 #include "CaliforniaDashboardAPI.hh"
+#include "caTrustStore.hh"
+#include "cardRecord.hh"
+#include "indicatorFields.hh"
+#include "tracepoints.hh"
+#include <charconv>
 #include <cstring>
 #include <cstdio>
 #include <stdexcept>
@@ -32,32 +37,23 @@ CaliforniaDashboardAPI::CaliforniaDashboardAPI(long timeout_ms, std::size_t pool
     : timeout_ms_(timeout_ms),
       pool_size_(pool_size),
       max_requests_per_sec_(max_requests_per_sec),
-      tokens_(max_requests_per_sec)
+      limiter_(max_requests_per_sec)
 {
     CURLcode rc = curl_global_init(CURL_GLOBAL_ALL);
     if (rc != CURLE_OK)
         throw std::runtime_error(std::string("curl_global_init: ") +
                                  curl_easy_strerror(rc));
-    clock_gettime(CLOCK_MONOTONIC, &last_refill_);
-
-    // Detect CA bundle path once at construction — avoids races when
-    // many threads all try to auto-detect it simultaneously at startup.
-    const char* ca_candidates[] = {
-        "/etc/ssl/cert.pem",                        // macOS Homebrew curl
-        "/etc/ssl/certs/ca-certificates.crt",       // Debian/Ubuntu
-        "/etc/pki/tls/certs/ca-bundle.crt",         // RHEL/CentOS
-        "/usr/local/etc/openssl/cert.pem",           // macOS MacPorts
-        nullptr
-    };
-    for (int i = 0; ca_candidates[i]; ++i) {
-        if (access(ca_candidates[i], R_OK) == 0) {
-            ca_bundle_path_ = ca_candidates[i];
-            fprintf(stderr, "[SSL] Using CA bundle: %s\n", ca_bundle_path_.c_str());
-            break;
-        }
-    }
-    if (ca_bundle_path_.empty())
-        fprintf(stderr, "[SSL] No CA bundle found — curl will use its default\n");
+
+    // Locate and parse the CA bundle once at construction — avoids races
+    // when many threads all try to auto-detect it simultaneously at startup,
+    // and every worker handle shares the parsed store (see caTrustStore.hh).
+    CaTrustStore::shared();
+
+    // Request headers — one list shared by every handle
+    headers_ = curl_slist_append(headers_, "Referer: https://www.caschooldashboard.org/");
+    headers_ = curl_slist_append(headers_, "Accept: application/json, text/plain, */*");
+    headers_ = curl_slist_append(headers_, "Accept-Language: en-US,en;q=0.9");
+    headers_ = curl_slist_append(headers_, "Connection: keep-alive");
 
     // Initialise share-lock mutexes
     for (int i = 0; i < CURL_LOCK_DATA_LAST; ++i)
@@ -76,7 +72,9 @@ CaliforniaDashboardAPI::CaliforniaDashboardAPI(long timeout_ms, std::size_t pool
 }
 
 CaliforniaDashboardAPI::~CaliforniaDashboardAPI() {
+    for (CURL* curl : idle_handles_) curl_easy_cleanup(curl);
     if (curl_share_) curl_share_cleanup(curl_share_);
+    curl_slist_free_all(headers_);
     for (int i = 0; i < CURL_LOCK_DATA_LAST; ++i)
         pthread_mutex_destroy(&share_locks[i]);
     curl_global_cleanup();
@@ -118,6 +116,44 @@ bool CaliforniaDashboardAPI::loadInURLs(const std::vector<std::string>& urls)
     return true;
 }
 
+// =============================================================================
+// setSourceAddresses
+// =============================================================================
+
+bool CaliforniaDashboardAPI::setSourceAddresses(const std::vector<std::string>& addresses,
+                                                double per_address_rps)
+{
+    const double rps = per_address_rps > 0 ? per_address_rps : max_requests_per_sec_;
+    sources_.clear();
+    for (const auto& addr : addresses) {
+        if (addr.empty()) continue;
+        sources_.push_back(std::make_unique<EgressSource>(addr, rps));
+    }
+    if (sources_.empty() && !addresses.empty()) {
+        fprintf(stderr, "setSourceAddresses: no usable addresses given\n");
+        return false;
+    }
+    return true;
+}
+
+bool CaliforniaDashboardAPI::moveToNextSource(PoolWorkerArg& arg)
+{
+    EgressSource* dead = arg.source;
+    if (!dead->failed.exchange(true))
+        fprintf(stderr, "\n[EGRESS] Cannot bind %s; moving its workers on\n", dead->address.c_str());
+    --dead->workers;
+
+    EgressSource* next = nullptr;
+    for (const auto& src : sources_)
+        if (!src->failed && (!next || src->workers < next->workers)) next = src.get();
+    if (!next) return false;
+
+    ++next->workers;
+    arg.source = next;
+    curl_easy_setopt(arg.curl, CURLOPT_INTERFACE, next->address.c_str());
+    return true;
+}
+
 // =============================================================================
 // runFullURLFetch
 // =============================================================================
@@ -133,22 +169,51 @@ bool CaliforniaDashboardAPI::runFullURLFetch()
     const std::size_t base_slot = allSummaryCardsVector.size(); // existing elements
     total_     = total;
     completed_ = 0;
+    store_failures_ = 0;
     next_slot_ = base_slot; // start slots AFTER any pre-existing cards
 
     // Pre-size the results vector to exactly the number of URLs.
     // Workers write directly into their pre-allocated slot using an atomic
     // index — no mutex required on the hot path at all.
-    allSummaryCardsVector.resize(base_slot + total);
+    // With a result store attached, cards go there instead and the vector
+    // is left untouched.
+    if (!result_store_)
+        allSummaryCardsVector.resize(base_slot + total);
 
     // Fill work queue
     WorkQueue queue;
     {
         std::lock_guard<std::mutex> lk(queue.mtx);
-        for (const auto& url : urls_)
+        for (const auto& url : urls_) {
             queue.items.push(url);
+            CADASH_PROBE2(job_enqueue, url.c_str(), queue.items.size());
+        }
     }
 
-    const std::size_t n = std::min(pool_size_, total);
+    return runPool(queue, std::min(pool_size_, total));
+}
+
+// =============================================================================
+// runStreamingFetch
+// =============================================================================
+
+bool CaliforniaDashboardAPI::runStreamingFetch(const StreamSource& next, const StreamSink& done)
+{
+    total_     = 0;   // unknown — the progress bar is left to the caller
+    completed_ = 0;
+
+    WorkQueue queue;
+    queue.next = &next;
+    queue.sink = &done;
+    return runPool(queue, pool_size_);
+}
+
+// =============================================================================
+// runPool — one persistent CURL handle and thread per worker
+// =============================================================================
+
+bool CaliforniaDashboardAPI::runPool(WorkQueue& queue, std::size_t n)
+{
     std::vector<pthread_t>     tids(n);
     std::vector<PoolWorkerArg> args(n);
 
@@ -189,6 +254,17 @@ bool CaliforniaDashboardAPI::runFullURLFetch()
         }
     }
 
+    // HTTP/2 unless HTTP/3 was asked for and this libcurl can speak it.
+    // CURL_HTTP_VERSION_3 still races a TCP connection and falls back.
+    const long http_version = httpVersion();
+    if (http3_) {
+        if (http_version == CURL_HTTP_VERSION_3)
+            fprintf(stderr, "[HTTP3] Preferring HTTP/3\n");
+        else
+            fprintf(stderr, "[HTTP3] libcurl was built without HTTP/3 — using HTTP/2\n");
+    }
+    http3_responses_ = 0;
+
     // Initialise one persistent CURL handle per worker
     for (std::size_t i = 0; i < n; ++i) {
         CURL* curl = curl_easy_init();
@@ -198,53 +274,21 @@ bool CaliforniaDashboardAPI::runFullURLFetch()
             return false;
         }
 
-        // Attach the shared DNS cache
-        if (curl_share_)
-            curl_easy_setopt(curl, CURLOPT_SHARE, curl_share_);
+        configureHandle(curl, http_version);
 
         // Inject pre-resolved IP — workers never touch DNS again
         if (resolve_list)
             curl_easy_setopt(curl, CURLOPT_RESOLVE, resolve_list);
 
-        // Use the CA bundle path detected once at construction
-        if (!ca_bundle_path_.empty())
-            curl_easy_setopt(curl, CURLOPT_CAINFO, ca_bundle_path_.c_str());
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-
-        // Browser identity — set once, inherited for all requests
-        curl_easy_setopt(curl, CURLOPT_USERAGENT,
-            "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) "
-            "AppleWebKit/537.36 (KHTML, like Gecko) "
-            "Chrome/120.0.0.0 Safari/537.36");
-
-        struct curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, "Referer: https://www.caschooldashboard.org/");
-        headers = curl_slist_append(headers, "Accept: application/json, text/plain, */*");
-        headers = curl_slist_append(headers, "Accept-Language: en-US,en;q=0.9");
-        headers = curl_slist_append(headers, "Connection: keep-alive");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-        // TCP keep-alive so idle sockets don't get closed between requests
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE,  30L);
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
-
-        // Extended DNS cache TTL
-        curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
-
-        // HTTP/2 — allows request multiplexing on a single TCP connection.
-        // Falls back to HTTP/1.1 automatically if the server doesn't support it.
-        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
-
-        // Disable Nagle — reduces latency for small request/response cycles
-        curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
-
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS,     timeout_ms_);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,  &CaliforniaDashboardAPI::write_callback);
-
-        args[i] = { this, &queue, curl, 0 };
+        // Bind this worker's connections to one egress address, round-robin
+        EgressSource* source = nullptr;
+        if (!sources_.empty()) {
+            source = sources_[i % sources_.size()].get();
+            ++source->workers;
+            curl_easy_setopt(curl, CURLOPT_INTERFACE, source->address.c_str());
+        }
+
+        args[i] = { this, &queue, curl, 0, source };
     }
 
     // Spawn workers
@@ -281,9 +325,132 @@ bool CaliforniaDashboardAPI::runFullURLFetch()
     if (resolve_list)
         curl_slist_free_all(resolve_list);
 
+    if (http_version == CURL_HTTP_VERSION_3)
+        fprintf(stderr, "[HTTP3] %zu/%zu responses over HTTP/3\n",
+                http3_responses_.load(), completed_.load());
+
+    for (const auto& src : sources_)
+        fprintf(stderr, "[EGRESS] %-20s %zu requests%s\n", src->address.c_str(),
+                src->requests.load(), src->failed ? " (bind failed)" : "");
+
     return true;
 }
 
+// =============================================================================
+// Handle setup
+// =============================================================================
+
+long CaliforniaDashboardAPI::httpVersion() const
+{
+    if (http3_ && (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP3))
+        return CURL_HTTP_VERSION_3;
+    return CURL_HTTP_VERSION_2TLS;
+}
+
+// Options shared by pool workers and fetchOne() handles.
+void CaliforniaDashboardAPI::configureHandle(CURL* curl, long http_version)
+{
+    // Attach the shared DNS cache
+    if (curl_share_)
+        curl_easy_setopt(curl, CURLOPT_SHARE, curl_share_);
+
+    // Trust anchors parsed once at construction, shared by every handle
+    CaTrustStore::shared().apply(curl);
+
+    // Browser identity — set once, inherited for all requests
+    curl_easy_setopt(curl, CURLOPT_USERAGENT,
+        "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) "
+        "AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/120.0.0.0 Safari/537.36");
+
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_);
+
+    // TCP keep-alive so idle sockets don't get closed between requests
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE,  30L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
+
+    // Extended DNS cache TTL
+    curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+
+    // HTTP/2 — allows request multiplexing on a single TCP connection.
+    // Falls back to HTTP/1.1 automatically if the server doesn't support it.
+    // HTTP/3 when enabled (see setHttp3).
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, http_version);
+
+    // CURLOPT_SSL_OPTIONS is one bitmask: collect every bit, then set it once.
+    long ssl_options = 0;
+#ifdef CURLSSLOPT_EARLYDATA
+    // 0-RTT: every request is an idempotent GET, so replay is harmless.
+    // Sessions are cached per handle, so each worker resumes its own.
+    // Only on handles that actually speak HTTP/3 (httpVersion() falls back
+    // to HTTP/2 when libcurl lacks it).
+    if (http_version == CURL_HTTP_VERSION_3)
+        ssl_options |= CURLSSLOPT_EARLYDATA;
+#endif
+    if (ssl_options)
+        curl_easy_setopt(curl, CURLOPT_SSL_OPTIONS, ssl_options);
+
+    // Disable Nagle — reduces latency for small request/response cycles
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS,     timeout_ms_);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,  &CaliforniaDashboardAPI::write_callback);
+}
+
+// =============================================================================
+// fetchOne
+// =============================================================================
+
+CURL* CaliforniaDashboardAPI::acquireHandle()
+{
+    {
+        std::lock_guard<std::mutex> lk(handles_mutex_);
+        if (!idle_handles_.empty()) {
+            CURL* curl = idle_handles_.back();
+            idle_handles_.pop_back();
+            return curl;
+        }
+    }
+    CURL* curl = curl_easy_init();
+    if (curl) configureHandle(curl, httpVersion());
+    return curl;
+}
+
+void CaliforniaDashboardAPI::releaseHandle(CURL* curl)
+{
+    std::lock_guard<std::mutex> lk(handles_mutex_);
+    idle_handles_.push_back(curl);
+}
+
+bool CaliforniaDashboardAPI::fetchOne(const std::string& cds, const std::string& yearId,
+                                      CardCache::Record& record, CardCache::Source* source)
+{
+    // Validate before parsing: a CDS code is exactly 14 digits, and the year
+    // is a plain integer that fits the cache key.
+    uint32_t year = 0;
+    const auto [end, ec] = std::from_chars(yearId.data(), yearId.data() + yearId.size(), year);
+    if (cds.size() != 14 || cds.find_first_not_of("0123456789") != std::string::npos ||
+        ec != std::errc() || end != yearId.data() + yearId.size() || year == 0 || year > 0xffff) {
+        fprintf(stderr, "Error: fetchOne needs a 14-digit CDS and a numeric yearId (got \"%s\", \"%s\")\n",
+                cds.c_str(), yearId.c_str());
+        return false;
+    }
+    const uint64_t cdsCode = indicatorfields::parseCds(cds);
+
+    return cardCache().getOrLoad(cdsCode, year, [&](std::string& out) {
+        CURL* curl = acquireHandle();
+        if (!curl) return false;
+        SummaryCard card;
+        const CURLcode rc = fetchSummaryCard(curl, base_url_ + cds + "/" + yearId + "/SummaryCards", card);
+        releaseHandle(curl);
+        if (rc != CURLE_OK) return false;
+        CardRecordBuilder::build(card, out);
+        return true;
+    }, record, source);
+}
+
 // =============================================================================
 // poolWorker
 // =============================================================================
@@ -295,6 +462,28 @@ void* CaliforniaDashboardAPI::poolWorker(void* raw)
 
     while (true) {
         std::string url;
+        std::size_t tag = 0;
+
+        if (q.next) {
+            // Streaming mode — pull, fetch into a local card, hand it over.
+            {
+                std::lock_guard<std::mutex> lk(q.mtx);
+                if (!(*q.next)(url, tag)) break;
+                CADASH_PROBE2(job_dequeue, url.c_str(), 0);   // a source has no depth
+            }
+            SummaryCard card;
+            CURLcode rc = a->self->fetchSummaryCard(a->curl, url, card, a->source);
+            while (rc == CURLE_INTERFACE_FAILED && a->source && a->self->moveToNextSource(*a)) {
+                card.clear();
+                rc = a->self->fetchSummaryCard(a->curl, url, card, a->source);
+            }
+            ++a->self->completed_;
+            if (rc == CURLE_OK) {
+                CADASH_PROBE2(card_stored, card.getIndicatorVector().size(), 2);
+            }
+            (*q.sink)(tag, card, rc == CURLE_OK);
+            continue;
+        }
 
         {
             std::unique_lock<std::mutex> lk(q.mtx);
@@ -302,16 +491,42 @@ void* CaliforniaDashboardAPI::poolWorker(void* raw)
             if (q.items.empty()) break;
             url = std::move(q.items.front());
             q.items.pop();
+            CADASH_PROBE2(job_dequeue, url.c_str(), q.items.size());
         }
 
-        // Global rate limiter
-        a->self->acquireToken();
-
-        // Claim a slot in the pre-sized results vector — lock-free
-        std::size_t slot = a->self->next_slot_.fetch_add(1, std::memory_order_relaxed);
-
-        // Fetch directly into the pre-allocated slot — no lock needed
-        a->self->fetchSummaryCard(a->curl, url, a->self->allSummaryCardsVector[slot]);
+        if (CardSpillStore* store = a->self->result_store_) {
+            // Out-of-core mode — fetch into a local card and hand it over.
+            SummaryCard card;
+            CURLcode rc = a->self->fetchSummaryCard(a->curl, url, card, a->source);
+            while (rc == CURLE_INTERFACE_FAILED && a->source && a->self->moveToNextSource(*a)) {
+                card.clear();
+                rc = a->self->fetchSummaryCard(a->curl, url, card, a->source);
+            }
+            if (rc == CURLE_OK) {
+                if (const UrlMetadata* meta = a->self->url_metadata_) {
+                    auto it = meta->find(url);
+                    if (it != meta->end()) card.setMetadata(it->second.first, it->second.second);
+                }
+                CADASH_PROBE2(card_stored, card.getIndicatorVector().size(), 1);
+                store->add(std::move(card));
+            } else {
+                ++a->self->store_failures_;
+            }
+        } else {
+            // Claim a slot in the pre-sized results vector — lock-free
+            std::size_t slot = a->self->next_slot_.fetch_add(1, std::memory_order_relaxed);
+
+            // Fetch directly into the pre-allocated slot — no lock needed
+            SummaryCard& card = a->self->allSummaryCardsVector[slot];
+            CURLcode rc = a->self->fetchSummaryCard(a->curl, url, card, a->source);
+            while (rc == CURLE_INTERFACE_FAILED && a->source && a->self->moveToNextSource(*a)) {
+                card.clear();
+                rc = a->self->fetchSummaryCard(a->curl, url, card, a->source);
+            }
+            if (rc == CURLE_OK) {
+                CADASH_PROBE2(card_stored, card.getIndicatorVector().size(), 0);
+            }
+        }
 
         // Progress bar — atomic increment first, then only lock stderr
         // every ~0.25% of total work to avoid the mutex becoming a bottleneck.
@@ -352,42 +567,36 @@ size_t CaliforniaDashboardAPI::write_callback(char* ptr, size_t size,
 }
 
 // =============================================================================
-// acquireToken  —  global token bucket
+// acquireToken  —  shared token bucket (see rateLimiter.hh)
 // =============================================================================
 
-void CaliforniaDashboardAPI::acquireToken()
+void CaliforniaDashboardAPI::acquireToken(EgressSource* source)
 {
-    // If unlimited, return immediately — zero overhead on the hot path.
-    if (max_requests_per_sec_ >= 1000.0) return;
-
-    std::unique_lock<std::mutex> lk(rate_mutex_);
-    while (true) {
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-
-        double elapsed = (now.tv_sec  - last_refill_.tv_sec) +
-                         (now.tv_nsec - last_refill_.tv_nsec) / 1e9;
-
-        tokens_ += elapsed * max_requests_per_sec_;
-        if (tokens_ > max_requests_per_sec_)
-            tokens_ = max_requests_per_sec_;
-        last_refill_ = now;
-
-        if (tokens_ >= 1.0) { tokens_ -= 1.0; return; }
-
-        double wait_sec = (1.0 - tokens_) / max_requests_per_sec_;
-        long   wait_ns  = static_cast<long>(wait_sec * 1e9);
-        struct timespec ts = { wait_ns / 1'000'000'000L, wait_ns % 1'000'000'000L };
-        lk.unlock();
-        nanosleep(&ts, nullptr);
-        lk.lock();
+    if (source) {
+        // Per-address bucket, still under the host-wide cap if one is shared
+        source->limiter.acquire();
+        ++source->requests;
+        if (shared_limiter_) shared_limiter_->acquire();
+        return;
     }
+    (shared_limiter_ ? shared_limiter_ : &limiter_)->acquire();
 }
 
 // =============================================================================
 // fetchSummaryCard
 // =============================================================================
 
+// A QUIC handshake or HTTP/3 layer failure (UDP blocked, middlebox, server
+// without h3): switch this handle to HTTP/2 for the rest of the run.
+bool CaliforniaDashboardAPI::fallBackToHttp2(CURL* curl, CURLcode result)
+{
+    if (result != CURLE_QUIC_CONNECT_ERROR && result != CURLE_HTTP3) return false;
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    if (!http3_fallback_logged_.exchange(true))
+        fprintf(stderr, "\n[HTTP3] %s — falling back to HTTP/2\n", curl_easy_strerror(result));
+    return true;
+}
+
 static bool isRetryable(CURLcode code) {
     switch (code) {
         case CURLE_OPERATION_TIMEDOUT:
@@ -402,13 +611,21 @@ static bool isRetryable(CURLcode code) {
     }
 }
 
-CURLcode CaliforniaDashboardAPI::fetchSummaryCard(CURL*              curl,
-                                                   const std::string& url,
-                                                   SummaryCard&       card)
+// Performs the request with retries, rate-limited, writing the body into
+// `card`. http_code is set when the transfer completed.
+CURLcode CaliforniaDashboardAPI::performRequest(CURL*              curl,
+                                                const std::string& url,
+                                                SummaryCard&       card,
+                                                long&              http_code,
+                                                EgressSource*      source)
 {
     static constexpr int  MAX_RETRIES   = 3;
     static constexpr long BASE_DELAY_MS = 250; // shorter backoff at high speed
 
+    // Global rate limiter
+    acquireToken(source);
+    CADASH_PROBE1(token_acquired, url.c_str());
+
     curl_easy_setopt(curl, CURLOPT_URL,       url.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &card);
 
@@ -420,11 +637,26 @@ CURLcode CaliforniaDashboardAPI::fetchSummaryCard(CURL*              curl,
             long delay_ms = BASE_DELAY_MS * (1L << (attempt - 1));
             fprintf(stderr, "[RETRY %d/%d] +%ldms  %s\n",
                     attempt, MAX_RETRIES, delay_ms, url.c_str());
+            CADASH_PROBE4(retry, url.c_str(), attempt, delay_ms, static_cast<int>(result));
             struct timespec ts = { delay_ms / 1000, (delay_ms % 1000) * 1'000'000L };
             nanosleep(&ts, nullptr);
         }
 
+        CADASH_PROBE2(transfer_start, url.c_str(), attempt);
         result = curl_easy_perform(curl);
+        if (result != CURLE_OK && http3_ && fallBackToHttp2(curl, result)) {
+            card.clear();
+            result = curl_easy_perform(curl);
+        }
+#ifdef CADASHBOARD_HAVE_USDT
+        {
+            long status = 0;
+            if (result == CURLE_OK)
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            CADASH_PROBE5(transfer_done, url.c_str(), attempt, static_cast<int>(result),
+                          status, card.getRawData().size());
+        }
+#endif
         if (result == CURLE_OK) break;
 
         fprintf(stderr, "CURL Error (attempt %d/%d) [%s]: %s\n",
@@ -432,10 +664,51 @@ CURLcode CaliforniaDashboardAPI::fetchSummaryCard(CURL*              curl,
         if (!isRetryable(result)) break;
     }
 
+    http_code = 0;
+    if (result == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        if (http3_) {
+            long version = 0;
+            curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &version);
+            if (version == CURL_HTTP_VERSION_3) ++http3_responses_;
+        }
+    }
+    return result;
+}
+
+CURLcode CaliforniaDashboardAPI::fetchSummaryCard(CURL*              curl,
+                                                   const std::string& url,
+                                                   SummaryCard&       card,
+                                                   EgressSource*      source)
+{
+    CURLcode result    = CURLE_OK;
+    long     http_code = 0;
+
+    if (cache_) {
+        // Through the shared cache: a hit or an in-flight load of the same
+        // URL (e.g. by the caching proxy) costs no request of our own.
+        // Only JSON bodies are reported as 200, so nothing else is cached.
+        ResponseCache::Source origin;
+        std::string body;
+        http_code = cache_->getOrLoad(url, [&](std::string& out) -> long {
+            long code = 0;
+            result = performRequest(curl, url, card, code, source);
+            if (result != CURLE_OK) return 0;
+            if (code == 200 && !ResponseCache::looksLikeJson(card.getRawData())) return 502;
+            out = card.getRawData();
+            return code;
+        }, body, &origin);
+        if (origin != ResponseCache::Source::MISS) {
+            card.clear();
+            card.appendRawData(body.data(), body.size());
+            if (http_code == 0) result = CURLE_COULDNT_CONNECT;  // the load we joined failed
+        }
+    } else {
+        result = performRequest(curl, url, card, http_code, source);
+    }
+
     if (result != CURLE_OK) return result;
 
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
     if (http_code < 200 || http_code >= 300) {
         fprintf(stderr, "HTTP Error [%ld] for URL: %s\n", http_code, url.c_str());
         return CURLE_HTTP_RETURNED_ERROR;
@@ -447,12 +720,17 @@ CURLcode CaliforniaDashboardAPI::fetchSummaryCard(CURL*              curl,
         return CURLE_GOT_NOTHING;
     }
 
-    size_t first = raw.find_first_not_of(" \t\r\n");
-    if (first == std::string::npos || (raw[first] != '{' && raw[first] != '[')) {
+    if (!ResponseCache::looksLikeJson(raw)) {
         fprintf(stderr, "Invalid JSON for URL: %s\nPreview: %.200s\n", url.c_str(), raw.c_str());
         return CURLE_GOT_NOTHING;
     }
 
     card.parseRawData();
+    if (change_feed_)
+        change_feed_->ingest(card);
+    if (build_records_)
+        card.buildRecord();
+    if (compressor_)
+        card.compressRawData(*compressor_);
     return result;
 }
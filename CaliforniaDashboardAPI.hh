@@ -2,11 +2,20 @@
 #define CALIFORNIADASHBOARDAPI_H
 
 #include "summaryCard.hh"
+#include "cardCache.hh"
+#include "cardSpillStore.hh"
+#include "changeFeed.hh"
+#include "payloadCompressor.hh"
+#include "rateLimiter.hh"
+#include "responseCache.hh"
 #include <curl/curl.h>
 #include <pthread.h>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
 #include <queue>
 #include <string>
 #include <vector>
@@ -30,6 +39,89 @@ public:
     bool loadInURLs(const std::vector<std::string>& urls);
     bool runFullURLFetch();
 
+    // Pull-based alternative to loadInURLs + runFullURLFetch for job streams
+    // of any length. Workers call `next` one at a time for the next URL and a
+    // caller-chosen tag until it returns false; it may block to hold the
+    // workers back. Each card is passed to `done` with its tag and whether
+    // the fetch succeeded, concurrently from the workers. No URL list or
+    // result vector is kept, so memory does not grow with the stream.
+    using StreamSource = std::function<bool(std::string& url, std::size_t& tag)>;
+    using StreamSink   = std::function<void(std::size_t tag, SummaryCard& card, bool ok)>;
+    bool runStreamingFetch(const StreamSource& next, const StreamSink& done);
+
+    // Routes fetched cards into a memory-budgeted store instead of
+    // allSummaryCardsVector, for runs too large to hold in RAM. The store
+    // must outlive runFullURLFetch(). Pass nullptr to restore the default.
+    void setResultStore(CardSpillStore* store) { result_store_ = store; }
+
+    // URL -> (schoolName, year) labels. Cards bound for the result store are
+    // labelled before they are added, since they cannot be enriched after
+    // the run the way allSummaryCardsVector can. Must outlive runFullURLFetch().
+    using UrlMetadata = std::map<std::string, std::pair<std::string, std::string>>;
+    void setUrlMetadata(const UrlMetadata* metadata) { url_metadata_ = metadata; }
+
+    // Fetches that failed in the last run with a result store attached;
+    // those cards are not added to the store.
+    std::size_t storeFailures() const { return store_failures_.load(); }
+
+    // Compresses each card's retained rawData with the given (trained)
+    // compressor right after parsing. Must outlive runFullURLFetch().
+    void setPayloadCompressor(const PayloadCompressor* compressor) { compressor_ = compressor; }
+
+    // Draws request tokens from a limiter shared with other components
+    // (e.g. the caching proxy) instead of this API's own. Must outlive
+    // runFullURLFetch(). Pass nullptr to restore the default.
+    void setRateLimiter(RateLimiter* limiter) { shared_limiter_ = limiter; }
+
+    // Serves responses from (and stores them in) a cache shared with other
+    // components such as the caching proxy. Concurrent requests for the same
+    // URL are coalesced. Must outlive runFullURLFetch().
+    void setResponseCache(ResponseCache* cache) { cache_ = cache; }
+
+    // Diffs each parsed card against the feed's store and emits change
+    // events as cards arrive. Must outlive runFullURLFetch().
+    void setChangeFeed(ChangeFeed* feed) { change_feed_ = feed; }
+
+    // Builds each card's binary CardRecord right after parsing, while the
+    // card is still hot in the worker's cache.
+    void setBuildRecords(bool enabled) { build_records_ = enabled; }
+
+    // Spreads the worker pool across several local source addresses. Each
+    // entry is anything CURLOPT_INTERFACE accepts: an address ("10.0.0.2"),
+    // an interface name ("eth1"), or the explicit "host!"/"if!" forms.
+    // Workers are assigned round-robin, keep their own connections, and
+    // draw tokens from a bucket per address at `per_address_rps` (0 = the
+    // constructor's rate), so the aggregate rate scales with the address
+    // count. A shared limiter, if set, still caps the total. An address
+    // that cannot be bound is retired and its workers move to the
+    // least-loaded remaining one.
+    bool setSourceAddresses(const std::vector<std::string>& addresses,
+                            double per_address_rps = 0);
+
+    // Prefers HTTP/3 (QUIC) for API requests, with TLS 1.3 early data so
+    // resumed connections send the request in the first flight. Needs a
+    // libcurl built with HTTP/3 support; without it, or when a QUIC
+    // connection fails, requests fall back to HTTP/2 over TCP.
+    void setHttp3(bool enabled) { http3_ = enabled; }
+
+    // One card on demand, for services answering "school X, year Y" rather
+    // than running bulk fetches. A fresh card comes from the card cache in
+    // microseconds; a miss costs exactly one request on an idle pooled handle,
+    // and concurrent misses for the same card share that request. `record`
+    // is the card's CardRecord image (read it with CardRecordView). No
+    // worker pool is started; safe to call from any number of threads.
+    bool fetchOne(const std::string& cds, const std::string& yearId,
+                  CardCache::Record& record, CardCache::Source* source = nullptr);
+
+    // Caches fetchOne() cards in a cache shared with other components
+    // instead of this API's own. Must outlive the API. Pass nullptr to
+    // restore the default.
+    void setCardCache(CardCache* cache) { shared_card_cache_ = cache; }
+    CardCache& cardCache() { return shared_card_cache_ ? *shared_card_cache_ : card_cache_; }
+
+    // Prefix of the SummaryCards URLs fetchOne() builds (e.g. a caching proxy).
+    void setBaseUrl(const std::string& url) { base_url_ = url; }
+
     std::vector<SummaryCard> allSummaryCardsVector;
 
 private:
@@ -39,6 +131,21 @@ private:
         std::mutex              mtx;
         std::condition_variable cv;
         bool                    done = false;
+        // Streaming mode (see runStreamingFetch): URLs are pulled from
+        // `next` under mtx instead of `items`, and cards go to `sink`.
+        const StreamSource*     next = nullptr;
+        const StreamSink*       sink = nullptr;
+    };
+
+    // One local egress address and its rate bucket (see setSourceAddresses).
+    struct EgressSource {
+        explicit EgressSource(const std::string& addr, double rps)
+            : address(addr), limiter(rps) {}
+        std::string              address;
+        RateLimiter              limiter;
+        std::atomic<std::size_t> requests{0};
+        std::atomic<std::size_t> workers{0};
+        std::atomic<bool>        failed{false};
     };
 
     struct PoolWorkerArg {
@@ -46,21 +153,34 @@ private:
         WorkQueue*              queue;
         CURL*                   curl;    // persistent handle, one per worker
         std::size_t             slot;    // pre-allocated slot in results vector
+        EgressSource*           source;  // bound address, or nullptr for default route
     };
 
+    bool          runPool(WorkQueue& queue, std::size_t workers);
+    long          httpVersion() const;
+    void          configureHandle(CURL* curl, long http_version);
+    CURL*         acquireHandle();
+    void          releaseHandle(CURL* curl);
     static void*  poolWorker(void* raw);
     static size_t write_callback(char* ptr, size_t size, size_t nmemb, void* userdata);
-    CURLcode      fetchSummaryCard(CURL* curl, const std::string& url, SummaryCard& card);
-    void          acquireToken();
+    CURLcode      fetchSummaryCard(CURL* curl, const std::string& url, SummaryCard& card,
+                                   EgressSource* source = nullptr);
+    CURLcode      performRequest(CURL* curl, const std::string& url, SummaryCard& card,
+                                 long& http_code, EgressSource* source);
+    bool          fallBackToHttp2(CURL* curl, CURLcode result);
+    void          acquireToken(EgressSource* source);
+    bool          moveToNextSource(PoolWorkerArg& arg);
 
     long        timeout_ms_;
     std::size_t pool_size_;
     double      max_requests_per_sec_;
 
-    // Token bucket — protected by rate_mutex_
-    double          tokens_;
-    struct timespec last_refill_;
-    std::mutex      rate_mutex_;
+    // Token bucket — the API's own unless a shared one is set
+    RateLimiter  limiter_;
+    RateLimiter* shared_limiter_{nullptr};
+
+    // Local egress addresses, each with its own bucket (see setSourceAddresses)
+    std::vector<std::unique_ptr<EgressSource>> sources_;
 
     // Progress — separate from results mutex so printing never blocks a push
     std::atomic<std::size_t> completed_{0};
@@ -78,7 +198,38 @@ private:
     // so the first worker to resolve the host shares the result with all others.
     CURLSH* curl_share_{nullptr};
 
-    std::string              ca_bundle_path_; // resolved once at construction
+    // Request headers, one list referenced by every handle
+    struct curl_slist* headers_{nullptr};
+
+    // Idle handles for fetchOne(), created on demand and reused
+    std::vector<CURL*> idle_handles_;
+    std::mutex         handles_mutex_;
+
+    // Cards served by fetchOne() — the API's own unless a shared one is set
+    CardCache   card_cache_;
+    CardCache*  shared_card_cache_{nullptr};
+    std::string base_url_{"https://api.caschooldashboard.org/Reports/"};
+
+    // Optional out-of-core destination for results (see setResultStore).
+    CardSpillStore*          result_store_{nullptr};
+    const UrlMetadata*       url_metadata_{nullptr};
+    std::atomic<std::size_t> store_failures_{0};
+
+    // Optional dictionary compressor for retained rawData (see setPayloadCompressor).
+    const PayloadCompressor* compressor_{nullptr};
+    bool                     build_records_{false};
+
+    // Optional shared response cache (see setResponseCache).
+    ResponseCache* cache_{nullptr};
+
+    // Optional change-feed sink (see setChangeFeed).
+    ChangeFeed* change_feed_{nullptr};
+
+    // HTTP/3 preference (see setHttp3) and how many responses used it
+    bool                     http3_{false};
+    std::atomic<std::size_t> http3_responses_{0};
+    std::atomic<bool>        http3_fallback_logged_{false};
+
     std::vector<std::string> urls_;
 };
 
@@ -0,0 +1,241 @@
+#include "batchRunner.hh"
+#include "perfRegions.hh"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+// =============================================================================
+// Job parsing
+// =============================================================================
+
+// A JSON string or number as text; CDS codes given as numbers get their
+// leading zeros back.
+static std::string textOf(const nlohmann::json& v, bool isCds = false) {
+    if (v.is_string()) return v.get<std::string>();
+    if (v.is_number_integer() || v.is_number_unsigned()) {
+        std::string s = v.dump();
+        if (isCds && s.size() < 14) s.insert(0, 14 - s.size(), '0');
+        return s;
+    }
+    return "";
+}
+
+BatchJob BatchRunner::parseJob(const std::string& line, std::size_t lineNumber) {
+    BatchJob job;
+    job.line = lineNumber;
+
+    const nlohmann::json spec = nlohmann::json::parse(line, nullptr, false);
+    if (spec.is_discarded() || !spec.is_object()) {
+        job.error = "invalid JSON";
+        return job;
+    }
+
+    auto field = [&spec](const char* key) -> const nlohmann::json* {
+        auto it = spec.find(key);
+        return it == spec.end() || it->is_null() ? nullptr : &*it;
+    };
+    if (auto v = field("id"))     job.id     = v->is_string() ? v->get<std::string>() : v->dump();
+    if (auto v = field("school")) job.school = textOf(*v);
+    if (auto v = field("cds"))    job.cds    = textOf(*v, true);
+    if (auto v = field("output")) job.output = textOf(*v);
+    if (auto v = field("priority"); v && v->is_number()) job.priority = v->get<int>();
+    if (auto v = field("years"); v && v->is_array()) {
+        for (const auto& y : *v)
+            if (std::string year = textOf(y); !year.empty()) job.years.push_back(std::move(year));
+    }
+    if (auto v = field("year"))
+        if (std::string year = textOf(*v); !year.empty()) job.years.push_back(std::move(year));
+
+    if (job.school.empty() && job.cds.empty()) job.error = "job has no school or cds";
+    else if (job.years.empty())                job.error = "job has no years";
+    return job;
+}
+
+std::string BatchRunner::resultLine(const BatchJob& job, const std::string& year, bool ok,
+                                    const std::string& error, const SummaryCard* card)
+{
+    nlohmann::ordered_json r;
+    r["line"] = job.line;
+    if (!job.id.empty())     r["id"]     = job.id;
+    if (!job.school.empty()) r["school"] = job.school;
+    if (!job.cds.empty())    r["cds"]    = job.cds;
+    if (!year.empty())       r["year"]   = year;
+    r["ok"] = ok;
+    if (!ok) r["error"] = error;
+
+    std::string line = r.dump();
+    if (card) {
+        // Spliced in rather than copied into `r`: cards are the bulk of the output.
+        line.pop_back();
+        line += ",\"card\":";
+        line += card->getRawJsonData().dump();
+        line += '}';
+    }
+    return line;
+}
+
+// =============================================================================
+// BatchRunner
+// =============================================================================
+
+BatchRunner::BatchRunner(CaliforniaDashboardAPI& api, SchoolResolver resolve, UrlBuilder url,
+                         std::size_t window)
+    : api_(api), resolve_(std::move(resolve)), url_(std::move(url)), window_(std::max<std::size_t>(window, 1))
+{
+}
+
+bool BatchRunner::dispatchesAfter(const Unit& a, const Unit& b) {
+    return a.priority != b.priority ? a.priority < b.priority : a.seq > b.seq;
+}
+
+void BatchRunner::readAhead() {
+    std::string line;
+    while (!exhausted_ || current_) {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (nextSeq_ - nextEmit_ >= window_) return;
+        }
+
+        if (!current_) {
+            if (!std::getline(in_, line)) {
+                exhausted_ = true;
+                return;
+            }
+            ++lineNumber_;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            auto job = std::make_shared<BatchJob>(parseJob(line, lineNumber_));
+            ++jobs_;
+            if (job->error.empty() && job->cds.empty()) {
+                job->cds = resolve_ ? resolve_(job->school) : "";
+                if (job->cds.empty()) job->error = "no school matches \"" + job->school + "\"";
+            }
+            if (!job->error.empty()) {
+                // One result line reports the job as a whole.
+                const std::size_t seq = nextSeq_++;
+                {
+                    std::lock_guard<std::mutex> lk(mtx_);
+                    ring_[seq % window_].job = job;
+                }
+                complete(seq, resultLine(*job, "", false, job->error, nullptr), false);
+                continue;
+            }
+            current_  = job;
+            nextYear_ = 0;
+        }
+
+        const std::string& year = current_->years[nextYear_];
+        const std::size_t  seq  = nextSeq_++;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            Slot& slot = ring_[seq % window_];
+            slot.job   = current_;
+            slot.year  = year;
+        }
+        std::string url = url_(current_->cds, year);
+        if (url.empty()) {
+            complete(seq, resultLine(*current_, year, false, "unsupported year", nullptr), false);
+        } else {
+            heap_.push_back({seq, current_->priority, std::move(url)});
+            std::push_heap(heap_.begin(), heap_.end(), dispatchesAfter);
+        }
+        if (++nextYear_ == current_->years.size()) current_.reset();
+    }
+}
+
+bool BatchRunner::next(std::string& url, std::size_t& seq) {
+    while (true) {
+        readAhead();
+        if (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), dispatchesAfter);
+            url = std::move(heap_.back().url);
+            seq = heap_.back().seq;
+            heap_.pop_back();
+            return true;
+        }
+        if (exhausted_ && !current_) return false;
+
+        // Window full and all of it in flight: wait for the oldest result.
+        std::unique_lock<std::mutex> lk(mtx_);
+        drained_.wait(lk, [this] { return nextSeq_ - nextEmit_ < window_; });
+    }
+}
+
+std::ostream* BatchRunner::outputFor(const std::string& path) {
+    if (path.empty() || path == "-") return out_;
+    auto it = files_.find(path);
+    if (it == files_.end()) {
+        // Bounded file handles: close them all and reopen on demand, which
+        // append mode makes harmless.
+        if (files_.size() >= MAX_OPEN_OUTPUTS) files_.clear();
+        auto file = std::make_unique<std::ofstream>(path, std::ios::app);
+        if (!*file) {
+            std::cerr << "Error: cannot open batch output " << path << "; writing to the default output" << std::endl;
+            file.reset();
+        }
+        it = files_.emplace(path, std::move(file)).first;
+    }
+    return it->second ? it->second.get() : out_;
+}
+
+void BatchRunner::complete(std::size_t seq, std::string line, bool ok) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    Slot& slot = ring_[seq % window_];
+    slot.line  = std::move(line);
+    slot.ready = true;
+    if (!ok) ++failures_;
+
+    const std::size_t before = nextEmit_;
+    for (Slot* head = &ring_[nextEmit_ % window_]; head->ready; head = &ring_[nextEmit_ % window_]) {
+        const std::string out = std::move(head->line);
+        *outputFor(head->job->output) << out << '\n';
+        head->ready = false;
+        head->job.reset();
+        ++nextEmit_;
+        if (++written_ % 1000 == 0)
+            fprintf(stderr, "\r  [BATCH] %zu results written", written_);
+    }
+    if (nextEmit_ != before) drained_.notify_all();
+}
+
+bool BatchRunner::run(const std::string& jobsPath, std::ostream& out) {
+    PerfRegion region("batch_run");
+    in_.close();
+    in_.clear();
+    in_.open(jobsPath);
+    if (!in_) {
+        std::cerr << "Error: cannot open job file " << jobsPath << std::endl;
+        return false;
+    }
+
+    out_        = &out;
+    lineNumber_ = nextYear_ = nextSeq_ = nextEmit_ = 0;
+    jobs_       = written_  = failures_ = 0;
+    exhausted_  = false;
+    current_.reset();
+    heap_.clear();
+    ring_.assign(window_, Slot{});
+
+    const bool ok = api_.runStreamingFetch(
+        [this](std::string& url, std::size_t& seq) { return next(url, seq); },
+        [this](std::size_t seq, SummaryCard& card, bool fetched) {
+            std::shared_ptr<const BatchJob> job;
+            std::string year;
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                job  = ring_[seq % window_].job;
+                year = ring_[seq % window_].year;
+            }
+            complete(seq, resultLine(*job, year, fetched, fetched ? "" : "fetch failed",
+                                     fetched ? &card : nullptr), fetched);
+        });
+
+    if (!ok) return false;
+
+    out.flush();
+    for (auto& [path, file] : files_)
+        if (file) file->flush();
+    files_.clear();
+    if (written_ >= 1000) fputc('\n', stderr);
+    return true;
+}
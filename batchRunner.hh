@@ -0,0 +1,136 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "CaliforniaDashboardAPI.hh"
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// BatchRunner — streams fetch jobs from a JSONL file through the API.
+//
+// One job per line:
+//
+//   {"school": "Pomona High School", "years": ["2023", "2024"]}
+//   {"cds": "19649071995901", "year": "2025", "priority": 5,
+//    "output": "pomona.jsonl", "id": "pomona-25"}
+//
+// A job names a school by CDS code or by name (resolved by the caller's
+// resolver), lists one or more years, and may set a priority (default 0),
+// an output file (default: the stream passed to run()) and an id that is
+// echoed back. Each (job, year) becomes one result line:
+//
+//   {"line": 2, "id": "pomona-25", "school": "...", "cds": "...",
+//    "year": "2025", "ok": true, "card": [ ...API response... ]}
+//
+// Lines that cannot be parsed or resolved give a result with "ok": false
+// and an "error" instead of "card".
+//
+// Jobs are read lazily as workers ask for work, so the file can be of any
+// size. At most `window` results are outstanding at once — read but not
+// yet written — which bounds memory. Within that window, higher-priority
+// jobs are dispatched first. Results are written in file order: a finished
+// result waits in a ring buffer slot until every earlier one is written.
+// Output files are opened in append mode.
+// =============================================================================
+
+struct BatchJob {
+    std::size_t              line     = 0;   // 1-based line in the job file
+    std::string              id;
+    std::string              school;
+    std::string              cds;
+    std::vector<std::string> years;
+    int                      priority = 0;
+    std::string              output;         // empty = run()'s stream
+    std::string              error;          // set when the job cannot run
+};
+
+class BatchRunner {
+public:
+    static constexpr std::size_t DEFAULT_WINDOW   = 4096;
+    static constexpr std::size_t MAX_OPEN_OUTPUTS = 64;
+
+    // CDS code for a school name, or "" when nothing matches.
+    using SchoolResolver = std::function<std::string(const std::string& school)>;
+    // API URL for a CDS code and year, or "" when the year is unsupported.
+    using UrlBuilder     = std::function<std::string(const std::string& cds, const std::string& year)>;
+
+    BatchRunner(CaliforniaDashboardAPI& api, SchoolResolver resolve, UrlBuilder url,
+                std::size_t window = DEFAULT_WINDOW);
+
+    // Runs every job in `jobsPath` and writes the results. False if the
+    // file cannot be opened or the fetch could not start.
+    bool run(const std::string& jobsPath, std::ostream& out);
+
+    std::size_t jobsRead() const       { return jobs_; }
+    std::size_t resultsWritten() const { return written_; }
+    std::size_t failures() const       { return failures_; }
+
+    // Parses one job line; on failure `job.error` says why.
+    static BatchJob parseJob(const std::string& line, std::size_t lineNumber);
+
+private:
+    // One (job, year) waiting for a worker.
+    struct Unit {
+        std::size_t seq      = 0;
+        int         priority = 0;
+        std::string url;
+    };
+
+    // A result from the moment its job is read until it is written.
+    struct Slot {
+        bool                            ready = false;
+        std::shared_ptr<const BatchJob> job;
+        std::string                     year;
+        std::string                     line;
+    };
+
+    // Heap order: highest priority first, then file order.
+    static bool dispatchesAfter(const Unit& a, const Unit& b);
+
+    // Called by the pool, one worker at a time.
+    bool next(std::string& url, std::size_t& seq);
+    // Reads jobs until the window is full or the file is exhausted.
+    void readAhead();
+    // Stores a finished result and writes every result now in order.
+    void complete(std::size_t seq, std::string line, bool ok);
+    std::ostream* outputFor(const std::string& path);
+
+    static std::string resultLine(const BatchJob& job, const std::string& year, bool ok,
+                                  const std::string& error, const SummaryCard* card);
+
+    CaliforniaDashboardAPI& api_;
+    SchoolResolver          resolve_;
+    UrlBuilder              url_;
+    std::size_t             window_;
+
+    // Reader side — touched only from next(), which the pool serialises.
+    std::ifstream                   in_;
+    std::size_t                     lineNumber_ = 0;
+    bool                            exhausted_  = false;
+    std::shared_ptr<const BatchJob> current_;        // job being expanded into units
+    std::size_t                     nextYear_   = 0;
+    std::size_t                     nextSeq_    = 0;
+    std::vector<Unit>               heap_;           // by priority, then seq
+
+    // Writer side.
+    std::mutex                      mtx_;
+    std::condition_variable         drained_;        // nextEmit_ advanced
+    std::vector<Slot>               ring_;           // seq % window
+    std::size_t                     nextEmit_ = 0;
+    std::ostream*                   out_      = nullptr;
+    std::map<std::string, std::unique_ptr<std::ofstream>> files_;
+
+    std::size_t jobs_     = 0;
+    std::size_t written_  = 0;
+    std::size_t failures_ = 0;
+};
+
+#endif // BATCHRUNNER_H
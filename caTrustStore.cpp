@@ -0,0 +1,136 @@
+#include "caTrustStore.hh"
+#include "perfRegions.hh"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+// Sharing needs X509_STORE_up_ref, so OpenSSL 1.1 or later.
+#ifdef CADASHBOARD_HAVE_OPENSSL
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+#define CADASHBOARD_SHARED_CA_STORE 1
+#include <openssl/crypto.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#endif
+#endif
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+#ifdef CADASHBOARD_SHARED_CA_STORE
+// True when libcurl's TLS backend is OpenSSL with the major version this
+// file was compiled against, so its SSL_CTX and our X509_STORE come from the
+// same library (one soname per major version, loaded once per process).
+static bool curlUsesCompatibleOpenSSL() {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    if (!info || !info->ssl_version) return false;
+    static const char PREFIX[] = "OpenSSL/";
+    if (std::strncmp(info->ssl_version, PREFIX, sizeof(PREFIX) - 1) != 0) return false;
+
+    const long curlMajor = std::strtol(info->ssl_version + sizeof(PREFIX) - 1, nullptr, 10);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    return curlMajor == OPENSSL_VERSION_MAJOR && OpenSSL_version_num() >> 28 == OPENSSL_VERSION_MAJOR;
+#else
+    // 1.1: the minor is part of the ABI, so it must match too.
+    const char* dot = std::strchr(info->ssl_version + sizeof(PREFIX) - 1, '.');
+    const long curlMinor = dot ? std::strtol(dot + 1, nullptr, 10) : -1;
+    return curlMajor == 1 && curlMinor == static_cast<long>((OPENSSL_VERSION_NUMBER >> 20) & 0xff)
+        && (OpenSSL_version_num() >> 20) == (OPENSSL_VERSION_NUMBER >> 20);
+#endif
+}
+#endif
+
+// =============================================================================
+// CaTrustStore
+// =============================================================================
+
+const CaTrustStore& CaTrustStore::shared() {
+    static const CaTrustStore store;
+    return store;
+}
+
+CaTrustStore::CaTrustStore() {
+    const char* ca_candidates[] = {
+        "/etc/ssl/cert.pem",                        // macOS Homebrew curl
+        "/etc/ssl/certs/ca-certificates.crt",       // Debian/Ubuntu
+        "/etc/pki/tls/certs/ca-bundle.crt",         // RHEL/CentOS
+        "/usr/local/etc/openssl/cert.pem",           // macOS MacPorts
+        nullptr
+    };
+    for (int i = 0; ca_candidates[i]; ++i) {
+        if (access(ca_candidates[i], R_OK) == 0) {
+            path_ = ca_candidates[i];
+            break;
+        }
+    }
+    if (path_.empty()) {
+        fprintf(stderr, "[SSL] No CA bundle found — curl will use its default\n");
+        return;
+    }
+
+#ifdef CADASHBOARD_SHARED_CA_STORE
+    if (curlUsesCompatibleOpenSSL()) {
+        PerfRegion region("ca_bundle_parse");
+        X509_STORE* store = X509_STORE_new();
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        const bool loaded = store && X509_STORE_load_file(store, path_.c_str()) == 1;
+#else
+        const bool loaded = store && X509_STORE_load_locations(store, path_.c_str(), nullptr) == 1;
+#endif
+        if (loaded) {
+            STACK_OF(X509_OBJECT)* objects = X509_STORE_get0_objects(store);
+            for (int i = 0; i < sk_X509_OBJECT_num(objects); ++i)
+                if (X509_OBJECT_get_type(sk_X509_OBJECT_value(objects, i)) == X509_LU_X509) ++certificates_;
+            store_ = store;
+            fprintf(stderr, "[SSL] Using CA bundle: %s (%zu certificates, parsed once and shared)\n",
+                    path_.c_str(), certificates_);
+            return;
+        }
+        X509_STORE_free(store);
+        fprintf(stderr, "[SSL] Could not parse %s — handles will load it themselves\n", path_.c_str());
+    }
+#endif
+    fprintf(stderr, "[SSL] Using CA bundle: %s\n", path_.c_str());
+}
+
+CaTrustStore::~CaTrustStore() {
+#ifdef CADASHBOARD_SHARED_CA_STORE
+    X509_STORE_free(static_cast<X509_STORE*>(store_));
+#endif
+}
+
+CURLcode CaTrustStore::installStore(CURL*, void* sslCtx, void* store) {
+#ifdef CADASHBOARD_SHARED_CA_STORE
+    // SSL_CTX_set_cert_store takes ownership of one reference.
+    X509_STORE* s = static_cast<X509_STORE*>(store);
+    X509_STORE_up_ref(s);
+    SSL_CTX_set_cert_store(static_cast<SSL_CTX*>(sslCtx), s);
+#else
+    (void)sslCtx;
+    (void)store;
+#endif
+    return CURLE_OK;
+}
+
+void CaTrustStore::apply(CURL* curl) const {
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+
+    if (store_) {
+        // No file for curl to parse: the callback supplies the anchors.
+        curl_easy_setopt(curl, CURLOPT_CAINFO, nullptr);
+        curl_easy_setopt(curl, CURLOPT_CAPATH, nullptr);
+        curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, &CaTrustStore::installStore);
+        curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, store_);
+        return;
+    }
+
+    if (!path_.empty())
+        curl_easy_setopt(curl, CURLOPT_CAINFO, path_.c_str());
+#if LIBCURL_VERSION_NUM >= 0x075700   // 7.87.0
+    curl_easy_setopt(curl, CURLOPT_CA_CACHE_TIMEOUT, 24L * 60 * 60);
+#endif
+}
@@ -0,0 +1,50 @@
+#ifndef CATRUSTSTORE_H
+#define CATRUSTSTORE_H
+
+#include <curl/curl.h>
+#include <cstddef>
+#include <string>
+
+// =============================================================================
+// CaTrustStore — the CA bundle, located and parsed once per process.
+//
+// With CURLOPT_CAINFO, libcurl reads and parses the whole bundle (~150
+// certificates) for every easy handle that connects, so a 50-worker pool
+// parses it 50 times before its first responses arrive. When libcurl runs
+// on OpenSSL and this library was built against the same major version
+// (CADASHBOARD_HAVE_OPENSSL), the bundle is parsed here once into an
+// X509_STORE. A CURLOPT_SSL_CTX_FUNCTION callback installs that
+// reference-counted store into each handle's SSL_CTX; OpenSSL stores are
+// safe to share between threads. Otherwise handles get CURLOPT_CAINFO with
+// CURLOPT_CA_CACHE_TIMEOUT, so each handle keeps its parsed copy across
+// reconnects instead of re-reading the file.
+// =============================================================================
+
+class CaTrustStore {
+public:
+    // The process-wide store, built on first use.
+    static const CaTrustStore& shared();
+
+    ~CaTrustStore();
+    CaTrustStore(const CaTrustStore&)            = delete;
+    CaTrustStore& operator=(const CaTrustStore&) = delete;
+
+    // Sets the trust anchors (and peer/host verification) on `curl`.
+    void apply(CURL* curl) const;
+
+    const std::string& bundlePath() const { return path_; }
+    // True when handles share the parsed store rather than the file path.
+    bool        isShared() const     { return store_ != nullptr; }
+    std::size_t certificates() const { return certificates_; }
+
+private:
+    CaTrustStore();
+
+    static CURLcode installStore(CURL* curl, void* sslCtx, void* store);
+
+    std::string path_;                  // empty = curl's built-in default
+    void*       store_        = nullptr; // X509_STORE*, when shared
+    std::size_t certificates_ = 0;
+};
+
+#endif // CATRUSTSTORE_H
@@ -0,0 +1,445 @@
+#include "cachingProxy.hh"
+#include "caTrustStore.hh"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Largest request head accepted from a client.
+static constexpr std::size_t MAX_REQUEST_HEAD = 16 * 1024;
+// Idle keep-alive connections are dropped after this long.
+static constexpr int IDLE_TIMEOUT_SEC = 30;
+
+static uint64_t nowMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000 + ts.tv_nsec / 1000;
+}
+
+// =============================================================================
+// LatencyHistogram
+// =============================================================================
+
+void CachingProxy::LatencyHistogram::record(uint64_t us) {
+    int b = 0;
+    while (b < BUCKETS - 1 && (1ull << b) < us) ++b;
+    counts[b].fetch_add(1, std::memory_order_relaxed);
+    total_us.fetch_add(us, std::memory_order_relaxed);
+    n.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t CachingProxy::LatencyHistogram::percentile(double p) const {
+    const uint64_t total = n.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    const uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += counts[b].load(std::memory_order_relaxed);
+        if (seen >= rank) return 1ull << b;
+    }
+    return 1ull << (BUCKETS - 1);
+}
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+CachingProxy::CachingProxy(ResponseCache& cache, RateLimiter& limiter,
+                           const std::string& upstream, long timeout_ms)
+    : cache_(cache), limiter_(limiter), upstream_(upstream), timeout_ms_(timeout_ms)
+{
+    CURLcode rc = curl_global_init(CURL_GLOBAL_ALL);
+    if (rc != CURLE_OK)
+        throw std::runtime_error(std::string("curl_global_init: ") +
+                                 curl_easy_strerror(rc));
+
+    CaTrustStore::shared();
+
+    headers_ = curl_slist_append(headers_, "Referer: https://www.caschooldashboard.org/");
+    headers_ = curl_slist_append(headers_, "Accept: application/json, text/plain, */*");
+    headers_ = curl_slist_append(headers_, "Accept-Language: en-US,en;q=0.9");
+    headers_ = curl_slist_append(headers_, "Connection: keep-alive");
+}
+
+CachingProxy::~CachingProxy() {
+    stop();
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    curl_slist_free_all(headers_);
+    curl_global_cleanup();
+}
+
+// =============================================================================
+// Lifecycle
+// =============================================================================
+
+bool CachingProxy::start(uint16_t port, const std::string& bindAddress, std::size_t workers) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        fprintf(stderr, "[PROXY] socket: %s\n", strerror(errno));
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1) {
+        fprintf(stderr, "[PROXY] Invalid bind address: %s\n", bindAddress.c_str());
+        return false;
+    }
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 128) != 0) {
+        fprintf(stderr, "[PROXY] bind/listen %s:%u: %s\n",
+                bindAddress.c_str(), port, strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    stop_ = false;
+    queue_.done = false;
+    workers_.resize(std::max<std::size_t>(1, workers));
+    std::size_t spawned = 0;
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+        int err = pthread_create(&workers_[i], nullptr, &CachingProxy::worker, this);
+        if (err) {
+            fprintf(stderr, "[PROXY] pthread_create failed: %s\n", strerror(err));
+            break;
+        }
+        ++spawned;
+    }
+    workers_.resize(spawned);
+    if (spawned == 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    fprintf(stderr, "[PROXY] Listening on %s:%u -> %s (%zu workers)\n",
+            bindAddress.c_str(), port_, upstream_.c_str(), spawned);
+    return true;
+}
+
+void CachingProxy::run() {
+    while (!stop_) {
+        struct pollfd pfd = { listen_fd_, POLLIN, 0 };
+        int ready = poll(&pfd, 1, 250);   // wake periodically to notice stop()
+        if (ready <= 0) continue;
+
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        struct timeval tv = { IDLE_TIMEOUT_SEC, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        {
+            std::lock_guard<std::mutex> lk(queue_.mtx);
+            queue_.fds.push(fd);
+        }
+        queue_.cv.notify_one();
+    }
+}
+
+void CachingProxy::stop() {
+    stop_ = true;
+    {
+        std::lock_guard<std::mutex> lk(queue_.mtx);
+        queue_.done = true;
+    }
+    queue_.cv.notify_all();
+    for (pthread_t t : workers_) pthread_join(t, nullptr);
+    workers_.clear();
+
+    std::lock_guard<std::mutex> lk(queue_.mtx);
+    while (!queue_.fds.empty()) {
+        ::close(queue_.fds.front());
+        queue_.fds.pop();
+    }
+}
+
+// =============================================================================
+// Workers
+// =============================================================================
+
+CURL* CachingProxy::makeUpstreamHandle() const {
+    CURL* curl = curl_easy_init();
+    if (!curl) return nullptr;
+    CaTrustStore::shared().apply(curl);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT,
+        "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) "
+        "AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/120.0.0.0 Safari/537.36");
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms_);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+        +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
+            static_cast<std::string*>(userdata)->append(ptr, size * nmemb);
+            return size * nmemb;
+        });
+    return curl;
+}
+
+void* CachingProxy::worker(void* raw) {
+    auto* self = static_cast<CachingProxy*>(raw);
+    CURL* curl = self->makeUpstreamHandle();   // persistent, one per worker
+
+    while (true) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lk(self->queue_.mtx);
+            self->queue_.cv.wait(lk, [self] {
+                return !self->queue_.fds.empty() || self->queue_.done;
+            });
+            if (self->queue_.fds.empty()) break;
+            fd = self->queue_.fds.front();
+            self->queue_.fds.pop();
+        }
+        self->serveConnection(curl, fd);
+        ::close(fd);
+    }
+
+    if (curl) curl_easy_cleanup(curl);
+    return nullptr;
+}
+
+long CachingProxy::fetchUpstream(CURL* curl, const std::string& url, std::string& body,
+                                 std::string& contentType) {
+    if (!curl) return 0;
+    limiter_.acquire();
+
+    curl_easy_setopt(curl, CURLOPT_URL,       url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+
+    CURLcode rc = curl_easy_perform(curl);
+    if (rc != CURLE_OK) {
+        fprintf(stderr, "[PROXY] %s: %s\n", url.c_str(), curl_easy_strerror(rc));
+        return 0;
+    }
+    long http_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    char* type = nullptr;
+    curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &type);
+    contentType = type ? type : "";
+    return http_code;
+}
+
+// =============================================================================
+// HTTP handling
+// =============================================================================
+
+static bool writeAll(int fd, const char* data, std::size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len  -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static const char* reasonPhrase(long status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 502: return "Bad Gateway";
+        default:  return "Status";
+    }
+}
+
+static const char* const JSON_TYPE = "application/json";
+
+static bool sendResponse(int fd, long status, const std::string& body, const char* cacheState,
+                         bool keepAlive, bool headOnly, const std::string& contentType = JSON_TYPE) {
+    char head[768];
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 %ld %s\r\n"
+                     "Content-Type: %.256s\r\n"
+                     "Content-Length: %zu\r\n"
+                     "X-Cache: %s\r\n"
+                     "Connection: %s\r\n\r\n",
+                     status, reasonPhrase(status), contentType.c_str(), body.size(), cacheState,
+                     keepAlive ? "keep-alive" : "close");
+    if (!writeAll(fd, head, static_cast<std::size_t>(n))) return false;
+    return headOnly || writeAll(fd, body.data(), body.size());
+}
+
+// Case-insensitive search for a header value in the request head.
+static bool headerEquals(const std::string& head, const char* name, const char* value) {
+    const std::size_t nameLen = std::strlen(name);
+    std::size_t pos = head.find("\r\n");
+    while (pos != std::string::npos && pos + 2 < head.size()) {
+        const std::size_t start = pos + 2;
+        const std::size_t end   = head.find("\r\n", start);
+        const std::size_t stop  = (end == std::string::npos) ? head.size() : end;
+        if (stop - start > nameLen && head[start + nameLen] == ':' &&
+            strncasecmp(head.c_str() + start, name, nameLen) == 0) {
+            std::size_t v = start + nameLen + 1;
+            while (v < stop && head[v] == ' ') ++v;
+            return strncasecmp(head.c_str() + v, value, std::strlen(value)) == 0;
+        }
+        pos = end;
+    }
+    return false;
+}
+
+void CachingProxy::serveConnection(CURL* curl, int fd) {
+    std::string buf;
+    char chunk[4096];
+
+    while (!stop_) {
+        // Read one request head.
+        std::size_t headEnd;
+        while ((headEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+            if (buf.size() > MAX_REQUEST_HEAD) {
+                sendResponse(fd, 400, "{\"error\":\"request too large\"}", "NONE", false, false);
+                return;
+            }
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;   // closed, idle timeout or error
+            buf.append(chunk, static_cast<std::size_t>(n));
+        }
+        const std::string head = buf.substr(0, headEnd + 2);
+        buf.erase(0, headEnd + 4);   // GET/HEAD carry no body
+
+        const uint64_t t0 = nowMicros();
+        ++requests_;
+
+        // Request line: METHOD SP target SP HTTP/x.y
+        const std::size_t sp1 = head.find(' ');
+        const std::size_t sp2 = (sp1 == std::string::npos) ? sp1 : head.find(' ', sp1 + 1);
+        if (sp2 == std::string::npos) {
+            sendResponse(fd, 400, "{\"error\":\"malformed request\"}", "NONE", false, false);
+            return;
+        }
+        const std::string method  = head.substr(0, sp1);
+        std::string       target  = head.substr(sp1 + 1, sp2 - sp1 - 1);
+        const bool        http10  = head.compare(sp2 + 1, 8, "HTTP/1.0") == 0;
+        const bool keepAlive = http10 ? headerEquals(head, "Connection", "keep-alive")
+                                      : !headerEquals(head, "Connection", "close");
+        const bool headOnly  = method == "HEAD";
+
+        if (method != "GET" && !headOnly) {
+            if (!sendResponse(fd, 405, "{\"error\":\"only GET is supported\"}", "NONE",
+                              keepAlive, false) || !keepAlive)
+                return;
+            continue;
+        }
+
+        // Absolute-form targets (client using us as an HTTP proxy): keep the path.
+        if (target.compare(0, 7, "http://") == 0 || target.compare(0, 8, "https://") == 0) {
+            std::size_t path = target.find('/', target.find("//") + 2);
+            target = (path == std::string::npos) ? "/" : target.substr(path);
+        }
+
+        if (target == "/stats") {
+            if (!sendResponse(fd, 200, statsJson(), "NONE", keepAlive, headOnly) || !keepAlive)
+                return;
+            continue;
+        }
+
+        if (target.compare(0, 9, "/Reports/") != 0 || target.find("..") != std::string::npos) {
+            if (!sendResponse(fd, 404, "{\"error\":\"only /Reports/ is proxied\"}", "NONE",
+                              keepAlive, headOnly) || !keepAlive)
+                return;
+            continue;
+        }
+
+        // Same key as the library's own fetches, so the two share entries.
+        const std::string url = upstream_ + target;
+        ResponseCache::Source source;
+        std::string body;
+        std::string upstreamType;
+        long status = cache_.getOrLoad(url, [this, curl, &url, &upstreamType](std::string& out) -> long {
+            const long code = fetchUpstream(curl, url, out, upstreamType);
+            // Same rule as the library's loader: a non-JSON 200 (e.g. a WAF
+            // page) must not land in the shared cache.
+            if (code == 200 && !ResponseCache::looksLikeJson(out)) {
+                ++upstream_errors_;
+                out          = "{\"error\":\"upstream returned a non-JSON body\"}";
+                upstreamType = JSON_TYPE;
+                return 502;
+            }
+            return code;
+        }, body, &source);
+
+        const char* state = source == ResponseCache::Source::HIT       ? "HIT"
+                          : source == ResponseCache::Source::COALESCED ? "COALESCED"
+                                                                       : "MISS";
+        if (status == 0) {
+            ++upstream_errors_;
+            status       = 502;
+            body         = "{\"error\":\"upstream request failed\"}";
+            upstreamType = JSON_TYPE;
+        }
+        // Cached 200s are JSON by construction. Another caller's load (or a
+        // cache hit) doesn't tell us the upstream type, so sniff those.
+        if (source != ResponseCache::Source::MISS || upstreamType.empty())
+            upstreamType = ResponseCache::looksLikeJson(body) ? JSON_TYPE : "application/octet-stream";
+
+        const bool ok = sendResponse(fd, status, body, state, keepAlive, headOnly, upstreamType);
+        (source == ResponseCache::Source::HIT ? hit_latency_ : miss_latency_)
+            .record(nowMicros() - t0);
+        if (!ok || !keepAlive) return;
+    }
+}
+
+// =============================================================================
+// Stats
+// =============================================================================
+
+std::string CachingProxy::statsJson() const {
+    const ResponseCache::Stats s = cache_.stats();
+    const uint64_t lookups = s.hits + s.misses + s.coalesced;
+
+    auto latency = [](const LatencyHistogram& h) {
+        const uint64_t n = h.n.load();
+        return nlohmann::json{
+            {"count",   n},
+            {"mean_us", n ? h.total_us.load() / n : 0},
+            {"p50_us",  h.percentile(0.50)},
+            {"p99_us",  h.percentile(0.99)},
+        };
+    };
+
+    return nlohmann::json{
+        {"requests",        requests_.load()},
+        {"upstream_errors", upstream_errors_.load()},
+        {"cache", {
+            {"hits",        s.hits},
+            {"misses",      s.misses},
+            {"coalesced",   s.coalesced},
+            {"hit_rate",    lookups ? static_cast<double>(s.hits) / lookups : 0.0},
+            {"evictions",   s.evictions},
+            {"expirations", s.expirations},
+            {"entries",     s.entries},
+            {"bytes",       s.bytes},
+        }},
+        {"latency", {
+            {"hit",  latency(hit_latency_)},
+            {"miss", latency(miss_latency_)},
+        }},
+        {"rate_limit_per_sec", limiter_.rate()},
+    }.dump();
+}
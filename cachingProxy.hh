@@ -0,0 +1,102 @@
+#ifndef CACHINGPROXY_H
+#define CACHINGPROXY_H
+
+#include "rateLimiter.hh"
+#include "responseCache.hh"
+#include <curl/curl.h>
+#include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// CachingProxy — local HTTP/1.1 caching proxy for the /Reports/ endpoints.
+//
+// Other tools on the host point at http://127.0.0.1:<port>/Reports/... (or
+// use it as an HTTP proxy) instead of the dashboard API. Every request goes
+// through the same ResponseCache (with single-flight coalescing) and
+// RateLimiter as the library's own fetches, so the host has one
+// cache-backed egress that stays under the configured request rate.
+//
+// GET /stats returns hit/miss counters and latency percentiles as JSON, so
+// the hit rate and the cost of a miss can be benchmarked locally with any
+// HTTP load generator.
+//
+// Connections are served by a fixed pool of pthreads, each with its own
+// persistent upstream CURL handle. Keep-alive is supported.
+// =============================================================================
+
+class CachingProxy {
+public:
+    static constexpr std::size_t DEFAULT_WORKERS = 16;
+
+    CachingProxy(ResponseCache& cache, RateLimiter& limiter,
+                 const std::string& upstream = "https://api.caschooldashboard.org",
+                 long timeout_ms = 10'000);
+    ~CachingProxy();
+
+    CachingProxy(const CachingProxy&)            = delete;
+    CachingProxy& operator=(const CachingProxy&) = delete;
+
+    // Binds and listens. Port 0 picks a free port (see port()).
+    bool start(uint16_t port, const std::string& bindAddress = "127.0.0.1",
+               std::size_t workers = DEFAULT_WORKERS);
+
+    // Accepts connections until stop() is called. Blocks.
+    void run();
+    void stop();
+
+    uint16_t port() const { return port_; }
+
+    // JSON body served at /stats.
+    std::string statsJson() const;
+
+private:
+    // Log2 histogram of request latencies in microseconds.
+    struct LatencyHistogram {
+        static constexpr int BUCKETS = 40;
+        std::atomic<uint64_t> counts[BUCKETS] = {};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint64_t> n{0};
+
+        void     record(uint64_t us);
+        uint64_t percentile(double p) const;   // bucket upper bound, in us
+    };
+
+    struct ConnQueue {
+        std::queue<int>         fds;
+        std::mutex              mtx;
+        std::condition_variable cv;
+        bool                    done = false;
+    };
+
+    static void* worker(void* raw);
+    void         serveConnection(CURL* curl, int fd);
+    long         fetchUpstream(CURL* curl, const std::string& url, std::string& body,
+                               std::string& contentType);
+    CURL*        makeUpstreamHandle() const;
+
+    ResponseCache& cache_;
+    RateLimiter&   limiter_;
+    std::string    upstream_;
+    long           timeout_ms_;
+    curl_slist*    headers_ = nullptr;   // same request headers as the library's handles
+
+    int                    listen_fd_ = -1;
+    uint16_t               port_      = 0;
+    std::atomic<bool>      stop_{false};
+    ConnQueue              queue_;
+    std::vector<pthread_t> workers_;
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> upstream_errors_{0};
+    LatencyHistogram      hit_latency_;
+    LatencyHistogram      miss_latency_;
+};
+
+#endif // CACHINGPROXY_H
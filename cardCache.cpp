@@ -0,0 +1,161 @@
+#include "cardCache.hh"
+#include <time.h>
+
+// Per-entry overhead charged against the budget besides the record itself:
+// list node, index slot and the shared_ptr control block, roughly.
+static constexpr std::size_t ENTRY_OVERHEAD_BYTES = 96;
+
+static bool expired(const struct timespec& expires) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > expires.tv_sec ||
+           (now.tv_sec == expires.tv_sec && now.tv_nsec >= expires.tv_nsec);
+}
+
+CardCache::CardCache(std::size_t capacityBytes, long ttlSeconds)
+    : shard_capacity_(capacityBytes / SHARDS), ttl_seconds_(ttlSeconds) {}
+
+// =============================================================================
+// Internals (caller holds shard.mtx)
+// =============================================================================
+
+void CardCache::eraseLocked(Shard& shard, LruList::iterator it) {
+    shard.bytes -= it->record->size() + ENTRY_OVERHEAD_BYTES;
+    shard.index.erase(it->key);
+    shard.lru.erase(it);
+}
+
+bool CardCache::findLocked(Shard& shard, uint64_t key, Record& record) {
+    auto found = shard.index.find(key);
+    if (found == shard.index.end()) return false;
+
+    LruList::iterator it = found->second;
+    if (expired(it->expires)) {
+        eraseLocked(shard, it);
+        ++shard.stats.expirations;
+        return false;
+    }
+    record = it->record;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it);
+    return true;
+}
+
+void CardCache::insertLocked(Shard& shard, uint64_t key, Record record) {
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) eraseLocked(shard, found->second);
+
+    const std::size_t size = record->size() + ENTRY_OVERHEAD_BYTES;
+    if (size > shard_capacity_) return;   // would evict everything else
+
+    Entry e;
+    e.key    = key;
+    e.record = std::move(record);
+    clock_gettime(CLOCK_MONOTONIC, &e.expires);
+    e.expires.tv_sec += ttl_seconds_;
+
+    shard.lru.push_front(std::move(e));
+    shard.index[key] = shard.lru.begin();
+    shard.bytes += size;
+
+    while (shard.bytes > shard_capacity_ && !shard.lru.empty()) {
+        eraseLocked(shard, std::prev(shard.lru.end()));
+        ++shard.stats.evictions;
+    }
+}
+
+// =============================================================================
+// Public interface
+// =============================================================================
+
+bool CardCache::lookup(uint64_t cds, uint32_t schoolYearId, Record& record) {
+    const uint64_t k = key(cds, schoolYearId);
+    Shard& shard = shardFor(k);
+    std::lock_guard<std::mutex> lk(shard.mtx);
+    if (findLocked(shard, k, record)) { ++shard.stats.hits; return true; }
+    ++shard.stats.misses;
+    return false;
+}
+
+void CardCache::insert(uint64_t cds, uint32_t schoolYearId, Record record) {
+    if (!record) return;
+    const uint64_t k = key(cds, schoolYearId);
+    Shard& shard = shardFor(k);
+    std::lock_guard<std::mutex> lk(shard.mtx);
+    insertLocked(shard, k, std::move(record));
+}
+
+bool CardCache::getOrLoad(uint64_t cds, uint32_t schoolYearId,
+                          const std::function<bool(std::string& record)>& load,
+                          Record& record, Source* source)
+{
+    const uint64_t k = key(cds, schoolYearId);
+    Shard& shard = shardFor(k);
+
+    std::unique_lock<std::mutex> lk(shard.mtx);
+    if (findLocked(shard, k, record)) {
+        ++shard.stats.hits;
+        if (source) *source = Source::HIT;
+        return true;
+    }
+
+    auto running = shard.flights.find(k);
+    if (running != shard.flights.end()) {
+        std::shared_ptr<Flight> flight = running->second;
+        ++shard.stats.coalesced;
+        shard.flight_cv.wait(lk, [&flight] { return flight->done; });
+        record = flight->record;
+        if (source) *source = Source::COALESCED;
+        return flight->ok;
+    }
+
+    auto flight = std::make_shared<Flight>();
+    shard.flights[k] = flight;
+    ++shard.stats.misses;
+    lk.unlock();
+
+    std::string loaded;
+    bool ok = false;
+    try {
+        ok = load(loaded);
+    } catch (...) {
+        ok = false;
+    }
+    Record built = ok ? std::make_shared<const std::string>(std::move(loaded)) : nullptr;
+
+    lk.lock();
+    if (ok) insertLocked(shard, k, built);
+    flight->ok     = ok;
+    flight->record = built;
+    flight->done   = true;
+    shard.flights.erase(k);
+    lk.unlock();
+    shard.flight_cv.notify_all();
+
+    record = std::move(built);
+    if (source) *source = Source::MISS;
+    return ok;
+}
+
+CardCache::Stats CardCache::stats() const {
+    Stats s;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard.mtx);
+        s.hits        += shard.stats.hits;
+        s.misses      += shard.stats.misses;
+        s.coalesced   += shard.stats.coalesced;
+        s.evictions   += shard.stats.evictions;
+        s.expirations += shard.stats.expirations;
+        s.entries     += shard.index.size();
+        s.bytes       += shard.bytes;
+    }
+    return s;
+}
+
+void CardCache::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lk(shard.mtx);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef CARDCACHE_H
+#define CARDCACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+
+// =============================================================================
+// CardCache — in-memory cache of compact cards for on-demand lookups.
+//
+// Keyed by (CDS, schoolYearId). Values are CardRecord images (cardRecord.hh),
+// about a fifth of the JSON body and readable in place with CardRecordView,
+// held through shared_ptr so a lookup hands out the bytes without copying
+// and eviction never invalidates a record a reader still holds.
+//
+// The cache is split into SHARDS independent LRUs, each with its own lock,
+// byte budget (capacity / SHARDS) and single-flight table, so concurrent
+// lookups of different schools rarely contend. Entries expire after the
+// TTL. getOrLoad() coalesces concurrent misses for the same key: one caller
+// runs the loader, the rest wait for its record.
+// =============================================================================
+
+class CardCache {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY_BYTES = 64ull * 1024 * 1024;
+    static constexpr long        DEFAULT_TTL_SECONDS    = 6 * 60 * 60;
+    static constexpr std::size_t SHARDS                 = 16;
+
+    using Record = std::shared_ptr<const std::string>;   // CardRecord image
+
+    enum class Source { HIT, MISS, COALESCED };
+
+    struct Stats {
+        uint64_t    hits        = 0;
+        uint64_t    misses      = 0;
+        uint64_t    coalesced   = 0;   // misses served by another caller's load
+        uint64_t    evictions   = 0;
+        uint64_t    expirations = 0;
+        std::size_t entries     = 0;
+        std::size_t bytes       = 0;
+    };
+
+    explicit CardCache(std::size_t capacityBytes = DEFAULT_CAPACITY_BYTES,
+                       long ttlSeconds = DEFAULT_TTL_SECONDS);
+
+    CardCache(const CardCache&)            = delete;
+    CardCache& operator=(const CardCache&) = delete;
+
+    // A fresh record for the key, if cached. Counts a hit or a miss.
+    bool lookup(uint64_t cds, uint32_t schoolYearId, Record& record);
+    void insert(uint64_t cds, uint32_t schoolYearId, Record record);
+
+    // Cached record, or the one `load` builds. The loader fills `record` and
+    // returns false on failure; failures are not cached, and callers that
+    // joined the failed load get false as well.
+    bool getOrLoad(uint64_t cds, uint32_t schoolYearId,
+                   const std::function<bool(std::string& record)>& load,
+                   Record& record, Source* source = nullptr);
+
+    Stats stats() const;
+    void  clear();
+
+private:
+    struct Entry {
+        uint64_t        key;
+        Record          record;
+        struct timespec expires;
+    };
+
+    struct Flight {
+        bool   done = false;
+        bool   ok   = false;
+        Record record;
+    };
+
+    using LruList = std::list<Entry>;
+
+    struct alignas(64) Shard {   // own cache line: shards are locked independently
+        mutable std::mutex                                     mtx;
+        std::condition_variable                                flight_cv;
+        LruList                                                lru;     // front = most recent
+        std::unordered_map<uint64_t, LruList::iterator>        index;
+        std::unordered_map<uint64_t, std::shared_ptr<Flight>>  flights;
+        std::size_t                                            bytes = 0;
+        Stats                                                  stats;
+    };
+
+    static uint64_t key(uint64_t cds, uint32_t schoolYearId) {
+        return (cds << 16) | (schoolYearId & 0xffff);
+    }
+    Shard& shardFor(uint64_t key) {
+        // Fibonacci hashing: CDS codes share long prefixes, so mix before
+        // taking the top bits.
+        return shards_[(key * 0x9E3779B97F4A7C15ull) >> 60];
+    }
+
+    bool findLocked(Shard& shard, uint64_t key, Record& record);
+    void insertLocked(Shard& shard, uint64_t key, Record record);
+    void eraseLocked(Shard& shard, LruList::iterator it);
+
+    std::size_t shard_capacity_;
+    long        ttl_seconds_;
+    Shard       shards_[SHARDS];
+};
+
+static_assert(CardCache::SHARDS == 16, "shardFor() takes the top 4 hash bits");
+
+#endif // CARDCACHE_H
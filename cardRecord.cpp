@@ -0,0 +1,153 @@
+#include "cardRecord.hh"
+#include "summaryCard.hh"
+
+using json = nlohmann::json;
+using namespace cardrecord;
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+template <typename T>
+static void store(std::string& out, std::size_t at, T v) {
+    std::memcpy(&out[at], &v, sizeof(T));
+}
+
+// Block fields are written, read and converted from the table in
+// indicatorFields.hh; studentGroup lives in the entry's string refs instead.
+static void writeBlock(std::string& out, std::size_t at, const SummaryCard::indicator& b) {
+#define X(type, member, key, rtype, roff, slot) \
+    indicatorfields::storeAt<rtype, roff>(out, at, indicatorfields::toRecord<rtype>(b.member));
+    INDICATOR_BLOCK_FIELDS(X)
+#undef X
+}
+
+static json blockToJson(const BlockRecordView& b, std::string_view group) {
+    json out;
+#define X(type, member, key, rtype, roff, slot) \
+    indicatorfields::loadJson<type, rtype, roff>(out, key, b.data());
+    INDICATOR_BLOCK_FIELDS(X)
+#undef X
+    out["studentGroup"] = std::string(group);
+    return out;
+}
+
+// =============================================================================
+// CardRecordBuilder
+// =============================================================================
+
+void CardRecordBuilder::build(const SummaryCard& card, std::string& out) {
+    const auto& indicators = card.getIndicatorVector();
+    const std::size_t n = std::min<std::size_t>(indicators.size(), UINT16_MAX);
+
+    // String table: student groups, deduplicated by value.
+    std::string                          strings;
+    std::vector<std::pair<uint32_t, uint32_t>> primaryRefs(n), secondaryRefs(n);
+    auto intern = [&strings](const std::string& s) -> std::pair<uint32_t, uint32_t> {
+        if (s.empty()) return {0, 0};
+        std::size_t at = strings.find(s);
+        if (at == std::string::npos) { at = strings.size(); strings += s; }
+        return {static_cast<uint32_t>(at), static_cast<uint32_t>(s.size())};
+    };
+    for (std::size_t i = 0; i < n; ++i) {
+        primaryRefs[i] = intern(indicators[i].studentGroup);
+        const json& sec = indicators[i].secondary;
+        if (sec.is_object()) {
+            std::string group;
+            indicatorfields::readJson(sec, "studentGroup", group);
+            secondaryRefs[i] = intern(group);
+        }
+    }
+
+    const uint32_t entriesOffset = HEADER_BYTES;
+    const uint32_t stringsOffset = entriesOffset + static_cast<uint32_t>(n) * ENTRY_BYTES;
+    const uint32_t total         = stringsOffset + static_cast<uint32_t>(strings.size());
+
+    out.assign(total, '\0');
+    store(out, 0,  MAGIC);
+    store(out, 4,  VERSION);
+    store(out, 6,  HEADER_BYTES);
+    store(out, 8,  total);
+    store(out, 12, static_cast<uint16_t>(n));
+    store(out, 14, ENTRY_BYTES);
+    store(out, 16, entriesOffset);
+    store(out, 20, stringsOffset);
+    if (n > 0) {
+        store(out, 24, indicatorfields::parseCds(indicators[0].cdsCode));
+        store(out, 32, static_cast<uint32_t>(indicators[0].schoolYearId));
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& ind = indicators[i];
+        const std::size_t at = entriesOffset + i * ENTRY_BYTES;
+
+        uint32_t flags = 0;
+        if (ind.primary.is_object())   flags |= FLAG_PRIMARY;
+        if (ind.secondary.is_object()) flags |= FLAG_SECONDARY;
+
+        store(out, at + 0,  static_cast<uint32_t>(ind.indicatorId));
+        store(out, at + 4,  flags);
+        store(out, at + 8,  primaryRefs[i].first);
+        store(out, at + 12, primaryRefs[i].second);
+        store(out, at + 16, secondaryRefs[i].first);
+        store(out, at + 20, secondaryRefs[i].second);
+
+        writeBlock(out, at + 24, ind);
+        SummaryCard::indicator sec;
+        if (ind.secondary.is_object()) SummaryCard::parseBlock(ind.secondary, sec);
+        writeBlock(out, at + 24 + BLOCK_BYTES, sec);
+    }
+    if (!strings.empty())
+        std::memcpy(&out[stringsOffset], strings.data(), strings.size());
+}
+
+// =============================================================================
+// Views
+// =============================================================================
+
+std::string_view IndicatorRecordView::string(std::size_t at) const {
+    uint32_t off = cardrecord::load<uint32_t>(p_ + at);
+    uint32_t len = cardrecord::load<uint32_t>(p_ + at + 4);
+    if (len == 0 || off > stringsBytes_ || len > stringsBytes_ - off) return {};
+    return std::string_view(reinterpret_cast<const char*>(strings_ + off), len);
+}
+
+bool CardRecordView::valid() const {
+    if (!p_ || size_ < HEADER_BYTES) return false;
+    if (load<uint32_t>(p_) != MAGIC || load<uint16_t>(p_ + 4) != VERSION) return false;
+
+    const uint32_t total   = totalBytes();
+    const uint16_t count   = size();
+    const uint16_t stride  = load<uint16_t>(p_ + 14);
+    const uint32_t entries = load<uint32_t>(p_ + 16);
+    const uint32_t strings = load<uint32_t>(p_ + 20);
+    if (total > size_ || load<uint16_t>(p_ + 6) < HEADER_BYTES) return false;
+    if (stride < ENTRY_BYTES || entries < HEADER_BYTES) return false;
+    if (static_cast<uint64_t>(entries) + static_cast<uint64_t>(count) * stride > strings) return false;
+    return strings <= total;
+}
+
+IndicatorRecordView CardRecordView::indicator(std::size_t i) const {
+    const uint16_t stride  = load<uint16_t>(p_ + 14);
+    const uint32_t entries = load<uint32_t>(p_ + 16);
+    const uint32_t strings = load<uint32_t>(p_ + 20);
+    return IndicatorRecordView(p_ + entries + i * stride, p_ + strings, totalBytes() - strings);
+}
+
+json CardRecordView::toJson() const {
+    json arr = json::array();
+    for (std::size_t i = 0; i < size(); ++i) {
+        IndicatorRecordView ind = indicator(i);
+        json entry = {{"indicatorId", ind.indicatorId()}};
+        if (ind.hasPrimary()) {
+            entry["primary"] = blockToJson(ind.primary(), ind.studentGroup());
+            entry["primary"]["indicatorId"] = ind.indicatorId();
+        }
+        if (ind.hasSecondary()) {
+            entry["secondary"] = blockToJson(ind.secondary(), ind.secondaryStudentGroup());
+            entry["secondary"]["indicatorId"] = ind.indicatorId();
+        }
+        arr.push_back(std::move(entry));
+    }
+    return arr;
+}
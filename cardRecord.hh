@@ -0,0 +1,147 @@
+#ifndef CARDRECORD_H
+#define CARDRECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+
+class SummaryCard;
+
+// =============================================================================
+// CardRecord — versioned, little-endian binary image of one SummaryCards body.
+//
+// Read in place: the view classes below are typed accessors over the raw
+// bytes with no decode step, so a record can be mmapped, shipped over a pipe
+// or stored in a segment and consumed directly. Field offsets are fixed per
+// version; entryBytes is stored so newer writers can append fields without
+// breaking older readers.
+//
+//   Header  (48 bytes)
+//     0  u32 magic 'CDRC'      4  u16 version      6  u16 headerBytes
+//     8  u32 totalBytes       12  u16 entryCount  14  u16 entryBytes
+//    16  u32 entriesOffset    20  u32 stringsOffset
+//    24  u64 cds              32  u32 schoolYearId 36  u32 reserved[3]
+//   Entry   (152 bytes each, starting at entriesOffset)
+//     0  u32 indicatorId       4  u32 flags (1 = primary, 2 = secondary)
+//     8  StringRef primary studentGroup   16  StringRef secondary studentGroup
+//    24  Block primary        88  Block secondary
+//   Block   (64 bytes)
+//     0  i64 count             8  u64 cds
+//    16  i32 status (x1000)   20  i32 change (x1000)  24  i32 changeId
+//    28  i32 statusId         32  i32 performance     36  u32 totalGroups
+//    40  i32 red  44 orange   48  yellow  52 green    56  blue
+//    60  u16 schoolYearId     62  u8 isPrivateData    63  u8 reserved
+//   StringRef = u32 offset (from stringsOffset) | u32 length
+// =============================================================================
+
+namespace cardrecord {
+constexpr uint32_t MAGIC         = 0x43524443; // "CDRC" little-endian
+constexpr uint16_t VERSION       = 1;
+constexpr uint16_t HEADER_BYTES  = 48;
+constexpr uint16_t ENTRY_BYTES   = 152;
+constexpr uint16_t BLOCK_BYTES   = 64;
+constexpr int32_t  FIXED_SCALE   = 1000;
+constexpr uint32_t FLAG_PRIMARY   = 1;
+constexpr uint32_t FLAG_SECONDARY = 2;
+
+template <typename T>
+inline T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+} // namespace cardrecord
+
+// One primary or secondary block.
+class BlockRecordView {
+public:
+    explicit BlockRecordView(const uint8_t* p) : p_(p) {}
+
+    int64_t  count()        const { return cardrecord::load<int64_t>(p_ + 0); }
+    uint64_t cds()          const { return cardrecord::load<uint64_t>(p_ + 8); }
+    int32_t  statusFixed()  const { return cardrecord::load<int32_t>(p_ + 16); }
+    int32_t  changeFixed()  const { return cardrecord::load<int32_t>(p_ + 20); }
+    float    status()       const { return static_cast<float>(statusFixed()) / cardrecord::FIXED_SCALE; }
+    float    change()       const { return static_cast<float>(changeFixed()) / cardrecord::FIXED_SCALE; }
+    int32_t  changeId()     const { return cardrecord::load<int32_t>(p_ + 24); }
+    int32_t  statusId()     const { return cardrecord::load<int32_t>(p_ + 28); }
+    int32_t  performance()  const { return cardrecord::load<int32_t>(p_ + 32); }
+    uint32_t totalGroups()  const { return cardrecord::load<uint32_t>(p_ + 36); }
+    int32_t  red()          const { return cardrecord::load<int32_t>(p_ + 40); }
+    int32_t  orange()       const { return cardrecord::load<int32_t>(p_ + 44); }
+    int32_t  yellow()       const { return cardrecord::load<int32_t>(p_ + 48); }
+    int32_t  green()        const { return cardrecord::load<int32_t>(p_ + 52); }
+    int32_t  blue()         const { return cardrecord::load<int32_t>(p_ + 56); }
+    uint16_t schoolYearId() const { return cardrecord::load<uint16_t>(p_ + 60); }
+    bool     isPrivateData() const { return p_[62] != 0; }
+
+    // Start of the block, for the field-table readers in indicatorFields.hh.
+    const uint8_t* data() const { return p_; }
+
+private:
+    const uint8_t* p_;
+};
+
+// One indicator entry.
+class IndicatorRecordView {
+public:
+    IndicatorRecordView(const uint8_t* entry, const uint8_t* strings, uint32_t stringsBytes)
+        : p_(entry), strings_(strings), stringsBytes_(stringsBytes) {}
+
+    uint32_t indicatorId()  const { return cardrecord::load<uint32_t>(p_ + 0); }
+    bool     hasPrimary()   const { return cardrecord::load<uint32_t>(p_ + 4) & cardrecord::FLAG_PRIMARY; }
+    bool     hasSecondary() const { return cardrecord::load<uint32_t>(p_ + 4) & cardrecord::FLAG_SECONDARY; }
+    std::string_view studentGroup()          const { return string(8); }
+    std::string_view secondaryStudentGroup() const { return string(16); }
+    BlockRecordView  primary()   const { return BlockRecordView(p_ + 24); }
+    BlockRecordView  secondary() const { return BlockRecordView(p_ + 24 + cardrecord::BLOCK_BYTES); }
+
+private:
+    std::string_view string(std::size_t at) const;
+
+    const uint8_t* p_;
+    const uint8_t* strings_;
+    uint32_t       stringsBytes_;
+};
+
+class CardRecordView {
+public:
+    CardRecordView() = default;
+    CardRecordView(const void* data, std::size_t size)
+        : p_(static_cast<const uint8_t*>(data)), size_(size) {}
+    explicit CardRecordView(const std::string& bytes)
+        : CardRecordView(bytes.data(), bytes.size()) {}
+
+    // Checks magic, version and that every offset stays inside the buffer.
+    // Accessors assume a valid record.
+    bool valid() const;
+
+    uint32_t totalBytes()   const { return cardrecord::load<uint32_t>(p_ + 8); }
+    uint16_t size()         const { return cardrecord::load<uint16_t>(p_ + 12); }
+    uint64_t cds()          const { return cardrecord::load<uint64_t>(p_ + 24); }
+    uint32_t schoolYearId() const { return cardrecord::load<uint32_t>(p_ + 32); }
+    IndicatorRecordView indicator(std::size_t i) const;
+
+    // Rebuilds the API's JSON shape for consumers that still need it.
+    nlohmann::json toJson() const;
+
+private:
+    const uint8_t* p_    = nullptr;
+    std::size_t    size_ = 0;
+};
+
+// Produces a record from a parsed card.
+class CardRecordBuilder {
+public:
+    static void build(const SummaryCard& card, std::string& out);
+    static std::string build(const SummaryCard& card) {
+        std::string out;
+        build(card, out);
+        return out;
+    }
+};
+
+#endif // CARDRECORD_H
@@ -0,0 +1,389 @@
+#include "cardSpillStore.hh"
+#include "cardRecord.hh"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Sanity bound on a single spilled record when reading the segment back.
+static constexpr uint32_t MAX_RECORD_BYTES = 64u * 1024 * 1024;
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+CardSpillStore::CardSpillStore(const std::string& segmentPath,
+                               std::size_t memoryBudgetBytes,
+                               bool keepSegment)
+    : segmentPath_(segmentPath),
+      budget_(memoryBudgetBytes),
+      keepSegment_(keepSegment)
+{
+    segment_.open(segmentPath_, std::ios::binary | std::ios::trunc);
+    segmentOpen_ = segment_.is_open();
+    if (!segmentOpen_)
+        std::cerr << "Error: Could not open spill segment for writing: "
+                  << segmentPath_ << std::endl;
+}
+
+CardSpillStore::~CardSpillStore() {
+    if (segment_.is_open()) segment_.close();
+    if (!keepSegment_) std::remove(segmentPath_.c_str());
+}
+
+// =============================================================================
+// Add / Spill
+// =============================================================================
+
+// Heap bytes held by a JSON DOM: one node per value, plus string and key
+// buffers and the container bookkeeping.
+static std::size_t jsonBytes(const json& j) {
+    std::size_t bytes = sizeof(json);
+    switch (j.type()) {
+    case json::value_t::object:
+        for (auto it = j.begin(); it != j.end(); ++it)
+            bytes += 48 + sizeof(std::string) + it.key().capacity() + jsonBytes(it.value());  // map node
+        break;
+    case json::value_t::array:
+        for (const auto& v : j) bytes += jsonBytes(v);
+        break;
+    case json::value_t::string:
+        bytes += sizeof(std::string) + j.get_ref<const std::string&>().capacity();
+        break;
+    default:
+        break;
+    }
+    return bytes;
+}
+
+std::size_t CardSpillStore::estimateCardBytes(const SummaryCard& card) {
+    // Whatever text form is retained (raw, compressed or a CardRecord), the
+    // parsed DOM, and each indicator's own copies of its primary/secondary
+    // objects in both the vector and the category map. The DOM is walked
+    // rather than guessed from the text: the text may already be compressed.
+    std::size_t bytes = sizeof(SummaryCard) + card.getRawData().capacity()
+                      + card.getCompressedRawData().size() + card.getRecord().size()
+                      + jsonBytes(card.getRawJsonData())
+                      + card.schoolName.capacity() + card.year.capacity();
+    for (const auto& ind : card.getIndicatorVector())
+        bytes += 2 * (sizeof(SummaryCard::indicator) + ind.indicatorCategory.capacity()
+                      + jsonBytes(ind.primary) + jsonBytes(ind.secondary));
+    return bytes;
+}
+
+void CardSpillStore::add(SummaryCard&& card) {
+    const std::size_t bytes = estimateCardBytes(card);
+
+    SpillBatch batch;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        resident_.push_back(std::move(card));
+        residentBytes_.push_back(bytes);
+        memoryBytes_ += bytes;
+
+        // Always keep the newest card resident, even if it alone is over budget.
+        std::size_t victims = 0;
+        std::size_t freed   = 0;
+        while (segmentOpen_ && memoryBytes_ - freed > budget_ && victims + 1 < resident_.size())
+            freed += residentBytes_[victims++];
+        takeOldestLocked(victims, batch);
+    }
+    spill(batch);
+}
+
+static void writeField(std::string& buf, const std::string& s) {
+    uint32_t len = static_cast<uint32_t>(s.size());
+    buf.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    buf.append(s);
+}
+
+// Payload encodings, stored in the record's encoding byte.
+enum : uint8_t { SPILL_RECORD = 0, SPILL_ZSTD_JSON = 1 };
+
+// Record layout (little-endian):
+//   u32 recordLen | u32 nameLen | name | u32 yearLen | year | u8 encoding | payload
+// where payload is a CardRecord image or a zstd frame of the card's JSON text.
+bool CardSpillStore::encodeRecord(const SummaryCard& card, std::string& record) const {
+    uint8_t     encoding = SPILL_RECORD;
+    std::string payload;
+    if (compressor_) {
+        encoding = SPILL_ZSTD_JSON;
+        if (card.isRawDataCompressed()) {
+            payload = card.getCompressedRawData();  // already in archive form
+        } else if (!compressor_->compress(card.getRawJsonData().dump(), payload)) {
+            return false;
+        }
+    } else if (!card.getRecord().empty()) {
+        payload = card.getRecord();          // built on the fetch path
+    } else {
+        CardRecordBuilder::build(card, payload);
+    }
+
+    const uint32_t len = static_cast<uint32_t>(payload.size() + card.schoolName.size() + card.year.size() +
+                                               2 * sizeof(uint32_t) + 1);
+    record.clear();
+    record.reserve(sizeof(len) + len);
+    record.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    writeField(record, card.schoolName);
+    writeField(record, card.year);
+    record.push_back(static_cast<char>(encoding));
+    record.append(payload);
+    return true;
+}
+
+// Moves the `count` oldest resident cards into `batch` and gives the batch
+// the next place in segment order. Caller holds mtx_.
+void CardSpillStore::takeOldestLocked(std::size_t count, SpillBatch& batch) {
+    if (count == 0) return;
+    for (std::size_t i = 0; i < count; ++i) {
+        batch.cards.push_back(std::move(resident_.front()));
+        batch.bytes.push_back(residentBytes_.front());
+        memoryBytes_ -= residentBytes_.front();
+        resident_.pop_front();
+        residentBytes_.pop_front();
+    }
+    batch.ticket  = nextTicket_++;
+    inFlight_    += count;
+}
+
+// Encodes outside every lock, so fetch workers calling add() never wait on
+// another thread's compression. Batches are written in the order they were
+// taken, so the segment stays in arrival order. Cards that cannot be
+// written go back to the front of the resident queue.
+bool CardSpillStore::spill(SpillBatch& batch) {
+    if (batch.cards.empty()) return true;
+
+    std::vector<std::string> records(batch.cards.size());
+    std::size_t encoded = 0;
+    while (encoded < batch.cards.size() && encodeRecord(batch.cards[encoded], records[encoded])) ++encoded;
+
+    std::size_t written = 0;
+    uint64_t    bytes   = 0;
+    {
+        std::unique_lock<std::mutex> lk(segmentMtx_);
+        segmentCv_.wait(lk, [&] { return nextWrite_ == batch.ticket; });
+        if (segmentOpen_) {
+            for (; written < encoded; ++written) {
+                segment_.write(records[written].data(), static_cast<std::streamsize>(records[written].size()));
+                if (segment_.fail()) {
+                    std::cerr << "Error: Failed to write to spill segment: " << segmentPath_ << std::endl;
+                    break;
+                }
+                bytes += records[written].size();
+            }
+        }
+        ++nextWrite_;
+    }
+    segmentCv_.notify_all();
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        for (std::size_t i = batch.cards.size(); i-- > written;) {
+            resident_.push_front(std::move(batch.cards[i]));
+            residentBytes_.push_front(batch.bytes[i]);
+            memoryBytes_ += batch.bytes[i];
+        }
+        spilled_      += written;
+        segmentBytes_ += bytes;
+        inFlight_     -= batch.cards.size();
+    }
+    drainedCv_.notify_all();
+    return written == batch.cards.size();
+}
+
+// Waits for batches other threads are still writing. Caller holds `lk` on mtx_.
+void CardSpillStore::waitForSpillsLocked(std::unique_lock<std::mutex>& lk) {
+    drainedCv_.wait(lk, [this] { return inFlight_ == 0; });
+}
+
+bool CardSpillStore::flush() {
+    SpillBatch batch;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        takeOldestLocked(resident_.size(), batch);
+    }
+    const bool ok = spill(batch);
+    std::unique_lock<std::mutex> lk(mtx_);
+    waitForSpillsLocked(lk);
+    std::lock_guard<std::mutex> seg(segmentMtx_);
+    segment_.flush();
+    return ok;
+}
+
+// =============================================================================
+// Iteration
+// =============================================================================
+
+static bool readField(const std::string& record, std::size_t& pos, std::string& out) {
+    uint32_t len = 0;
+    if (pos + sizeof(len) > record.size()) return false;
+    std::memcpy(&len, record.data() + pos, sizeof(len));
+    pos += sizeof(len);
+    if (pos + len > record.size()) return false;
+    out.assign(record, pos, len);
+    pos += len;
+    return true;
+}
+
+// Reads the spilled records in order and hands each one's metadata, encoding
+// and payload to `visit`. Caller holds mtx_ and has waited for in-flight
+// spills.
+bool CardSpillStore::readSegmentLocked(
+    const std::function<bool(std::size_t, const std::string&, const std::string&,
+                             uint8_t, const char*, std::size_t)>& visit)
+{
+    if (spilled_ == 0) return true;
+
+    {
+        std::lock_guard<std::mutex> seg(segmentMtx_);
+        segment_.flush();
+    }
+    std::ifstream in(segmentPath_, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open spill segment for reading: "
+                  << segmentPath_ << std::endl;
+        return false;
+    }
+
+    std::string record;
+    for (std::size_t i = 0; i < spilled_; ++i) {
+        uint32_t len = 0;
+        if (!in.read(reinterpret_cast<char*>(&len), sizeof(len)) || len > MAX_RECORD_BYTES) {
+            std::cerr << "Error: Truncated spill segment: " << segmentPath_ << std::endl;
+            return false;
+        }
+        record.resize(len);
+        if (!in.read(&record[0], len)) {
+            std::cerr << "Error: Truncated spill segment: " << segmentPath_ << std::endl;
+            return false;
+        }
+
+        std::size_t pos = 0;
+        std::string school, yr;
+        if (!readField(record, pos, school) || !readField(record, pos, yr) ||
+            pos >= record.size()) {
+            std::cerr << "Error: Corrupt spill record " << i << std::endl;
+            return false;
+        }
+        const uint8_t encoding = static_cast<uint8_t>(record[pos++]);
+
+        if (!visit(i, school, yr, encoding, record.data() + pos, record.size() - pos))
+            return false;
+    }
+    return true;
+}
+
+bool CardSpillStore::forEach(const std::function<bool(const SummaryCard&)>& visit) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    waitForSpillsLocked(lk);
+
+    bool stopped = false;
+    bool ok = readSegmentLocked([&](std::size_t i, const std::string& school, const std::string& yr,
+                                    uint8_t encoding, const char* payload, std::size_t size) {
+        SummaryCard card;
+        try {
+            if (encoding == SPILL_ZSTD_JSON) {
+                std::string text;
+                if (!compressor_ || !compressor_->decompress(payload, size, text)) {
+                    std::cerr << "Error: Cannot decompress spill record " << i << std::endl;
+                    return false;
+                }
+                card.setJsonData(json::parse(text));
+            } else {
+                CardRecordView view(payload, size);
+                if (!view.valid()) {
+                    std::cerr << "Error: Corrupt spill record " << i << std::endl;
+                    return false;
+                }
+                card.setJsonData(view.toJson());
+            }
+        } catch (const json::exception& e) {
+            std::cerr << "Error: Corrupt spill record " << i << ": " << e.what() << std::endl;
+            return false;
+        }
+        card.setMetadata(school, yr);
+        if (!visit(card)) { stopped = true; return false; }
+        return true;
+    });
+    if (stopped) return true;
+    if (!ok) return false;
+
+    for (const auto& card : resident_)
+        if (!visit(card)) return true;
+    return true;
+}
+
+bool CardSpillStore::forEachRecord(
+    const std::function<bool(const CardRecordView&, const std::string&, const std::string&)>& visit)
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    waitForSpillsLocked(lk);
+
+    bool stopped = false;
+    std::string scratch;
+    bool ok = readSegmentLocked([&](std::size_t i, const std::string& school, const std::string& yr,
+                                    uint8_t encoding, const char* payload, std::size_t size) {
+        CardRecordView view(payload, size);
+        if (encoding == SPILL_ZSTD_JSON) {
+            // Archive-form records have no binary image; build one.
+            std::string text;
+            if (!compressor_ || !compressor_->decompress(payload, size, text)) {
+                std::cerr << "Error: Cannot decompress spill record " << i << std::endl;
+                return false;
+            }
+            SummaryCard card;
+            try {
+                card.setJsonData(json::parse(text));
+            } catch (const json::exception& e) {
+                std::cerr << "Error: Corrupt spill record " << i << ": " << e.what() << std::endl;
+                return false;
+            }
+            CardRecordBuilder::build(card, scratch);
+            view = CardRecordView(scratch);
+        }
+        if (!view.valid()) {
+            std::cerr << "Error: Corrupt spill record " << i << std::endl;
+            return false;
+        }
+        if (!visit(view, school, yr)) { stopped = true; return false; }
+        return true;
+    });
+    if (stopped) return true;
+    if (!ok) return false;
+
+    for (const auto& card : resident_) {
+        if (card.getRecord().empty()) {
+            CardRecordBuilder::build(card, scratch);
+            if (!visit(CardRecordView(scratch), card.schoolName, card.year)) return true;
+        } else if (!visit(CardRecordView(card.getRecord()), card.schoolName, card.year)) {
+            return true;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// Stats
+// =============================================================================
+
+std::size_t CardSpillStore::size() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return spilled_ + inFlight_ + resident_.size();
+}
+
+std::size_t CardSpillStore::spilledCount() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return spilled_;
+}
+
+std::size_t CardSpillStore::memoryBytes() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return memoryBytes_;
+}
+
+uint64_t CardSpillStore::segmentBytes() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return segmentBytes_;
+}
@@ -0,0 +1,117 @@
+#ifndef CARDSPILLSTORE_H
+#define CARDSPILLSTORE_H
+
+#include "cardRecord.hh"
+#include "payloadCompressor.hh"
+#include "summaryCard.hh"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// CardSpillStore — memory-budgeted result store.
+//
+// Cards are kept in memory in arrival order until their estimated footprint
+// exceeds the budget, at which point the oldest are serialised as binary
+// CardRecords (see cardRecord.hh) to an append-only segment file and
+// released. forEach() then replays the segment followed by the in-memory
+// tail, so callers iterate all cards in arrival order without knowing which
+// ones were spilled.
+//
+// add() is thread-safe so fetch workers can hand cards over directly. Cards
+// over budget are taken off the queue under the lock but encoded and written
+// outside it, so one worker's compression and disk I/O never stalls the
+// others.
+// =============================================================================
+
+class CardSpillStore {
+public:
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = 512ull * 1024 * 1024;
+
+    // The segment file is truncated on construction and removed on
+    // destruction unless keepSegment is true.
+    explicit CardSpillStore(const std::string& segmentPath,
+                            std::size_t memoryBudgetBytes = DEFAULT_MEMORY_BUDGET,
+                            bool keepSegment = false);
+    ~CardSpillStore();
+
+    CardSpillStore(const CardSpillStore&)            = delete;
+    CardSpillStore& operator=(const CardSpillStore&) = delete;
+
+    void add(SummaryCard&& card);
+
+    // Spill records hold dictionary-compressed JSON instead of a CardRecord
+    // while a compressor is set. The compressor must outlive the store; records
+    // already written keep their original encoding.
+    void setCompressor(const PayloadCompressor* compressor) { compressor_ = compressor; }
+
+    // Visits every card in arrival order. Spilled cards are decoded one at a
+    // time, so iteration needs memory for a single card only. Returning false
+    // from the visitor stops iteration early.
+    bool forEach(const std::function<bool(const SummaryCard&)>& visit);
+
+    // Like forEach() but hands out the binary record of each card, read in
+    // place from the segment buffer without building a SummaryCard. The view
+    // is only valid for the duration of the call.
+    bool forEachRecord(const std::function<bool(const CardRecordView&,
+                                                const std::string& schoolName,
+                                                const std::string& year)>& visit);
+
+    // Spills everything still in memory (e.g. before handing the segment on).
+    bool flush();
+
+    std::size_t size()          const;
+    std::size_t spilledCount()  const;
+    std::size_t memoryBytes()   const;
+    uint64_t    segmentBytes()  const;
+
+    // Rough in-memory footprint of a parsed card: retained text (raw,
+    // compressed or CardRecord), JSON DOM and the indicator vector/map copies.
+    static std::size_t estimateCardBytes(const SummaryCard& card);
+
+private:
+    struct SpillBatch {
+        std::vector<SummaryCard> cards;
+        std::vector<std::size_t> bytes;
+        uint64_t                 ticket = 0;   // position in segment write order
+    };
+
+    void takeOldestLocked(std::size_t count, SpillBatch& batch);
+    bool spill(SpillBatch& batch);
+    bool encodeRecord(const SummaryCard& card, std::string& record) const;
+    void waitForSpillsLocked(std::unique_lock<std::mutex>& lk);
+    bool readSegmentLocked(const std::function<bool(std::size_t index,
+                                                    const std::string& schoolName,
+                                                    const std::string& year,
+                                                    uint8_t encoding,
+                                                    const char* payload,
+                                                    std::size_t size)>& visit);
+
+    std::string             segmentPath_;
+    std::size_t             budget_;
+    bool                    keepSegment_;
+    const PayloadCompressor* compressor_ = nullptr;
+
+    mutable std::mutex      mtx_;             // everything below up to segmentMtx_
+    std::condition_variable drainedCv_;       // inFlight_ reached 0
+    std::deque<SummaryCard> resident_;
+    std::deque<std::size_t> residentBytes_;
+    std::size_t             memoryBytes_  = 0;
+    std::size_t             spilled_      = 0;
+    std::size_t             inFlight_     = 0;   // taken for spilling, not yet written
+    uint64_t                nextTicket_   = 0;
+    uint64_t                segmentBytes_ = 0;
+
+    std::mutex              segmentMtx_;      // segment_ and nextWrite_; never held while taking mtx_
+    std::condition_variable segmentCv_;
+    uint64_t                nextWrite_    = 0;
+    bool                    segmentOpen_  = false;   // set once by the constructor
+    std::ofstream           segment_;
+};
+
+#endif // CARDSPILLSTORE_H
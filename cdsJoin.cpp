@@ -0,0 +1,277 @@
+#include "cdsJoin.hh"
+#include "perfRegions.hh"
+#include <pthread.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+// =============================================================================
+// CsvDataset
+// =============================================================================
+
+// The digits of `s` as a number; `digits` counts them.
+static uint64_t digitsOf(std::string_view s, int& digits) {
+    uint64_t v = 0;
+    digits = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') continue;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+        ++digits;
+    }
+    return v;
+}
+
+int CsvDataset::columnIndex(std::string_view name) const {
+    for (std::size_t c = 0; c < names_.size(); ++c)
+        if (names_[c] == name) return static_cast<int>(c);
+    return -1;
+}
+
+bool CsvDataset::load(const std::string& path, const std::string& cdsColumn) {
+    PerfRegion region("dataset_load");
+    names_.clear();
+    keys_.clear();
+    spans_.clear();
+    if (!csv_.open(path)) return false;
+
+    std::vector<std::string_view> fields;
+    if (!csv_.next(fields)) {
+        fprintf(stderr, "Error: %s is empty\n", path.c_str());
+        return false;
+    }
+    for (std::string_view f : fields) names_.emplace_back(f);
+
+    // Key columns: one full CDS code, or county + district + school codes.
+    int key = -1, county = -1, district = -1, school = -1;
+    if (!cdsColumn.empty()) {
+        key = columnIndex(cdsColumn);
+        if (key < 0) {
+            fprintf(stderr, "Error: %s has no column \"%s\"\n", path.c_str(), cdsColumn.c_str());
+            return false;
+        }
+    } else {
+        for (const char* name : {"CDSCode", "CDS Code", "CDS"})
+            if ((key = columnIndex(name)) >= 0) break;
+        if (key < 0) {
+            county   = columnIndex("County Code");
+            district = columnIndex("District Code");
+            school   = columnIndex("School Code");
+            if (county < 0 || district < 0 || school < 0) {
+                fprintf(stderr, "Error: %s has no CDS column (CDSCode, or County/District/School Code)\n",
+                        path.c_str());
+                return false;
+            }
+        }
+    }
+
+    const std::size_t width = names_.size();
+    std::vector<Span> row(width);
+    while (csv_.next(fields)) {
+        auto field = [&fields](int c) {
+            return static_cast<std::size_t>(c) < fields.size() ? fields[c] : std::string_view();
+        };
+
+        uint64_t cds = 0;
+        int      digits = 0;
+        if (key >= 0) {
+            cds = digitsOf(field(key), digits);
+        } else {
+            // 2 + 5 + 7 digits; the parts are often written without padding.
+            int d1 = 0, d2 = 0, d3 = 0;
+            uint64_t c = digitsOf(field(county), d1);
+            uint64_t d = digitsOf(field(district), d2);
+            uint64_t s = digitsOf(field(school), d3);
+            digits = d1 + d2 + d3;
+            cds = (c * 100000ull + d) * 10000000ull + s;
+        }
+        if (digits == 0) continue;
+
+        for (std::size_t c = 0; c < width; ++c) {
+            std::string_view f = c < fields.size() ? fields[c] : std::string_view();
+            row[c] = { static_cast<uint32_t>(f.data() ? f.data() - csv_.data() : 0),
+                       static_cast<uint32_t>(f.size()) };
+        }
+        keys_.push_back(cds);
+        spans_.insert(spans_.end(), row.begin(), row.end());
+    }
+    return true;
+}
+
+// =============================================================================
+// CdsJoinResult
+// =============================================================================
+
+bool CdsJoinResult::isNumeric(std::size_t column) const {
+    bool any = false;
+    double d;
+    for (std::size_t r = 0; r < size(); ++r) {
+        std::string_view v = value(r, column);
+        if (v.empty() || v == "*") continue;
+        if (!CsvScanner::parseNumber(v, d)) return false;
+        any = true;
+    }
+    return any;
+}
+
+std::vector<double> CdsJoinResult::numericColumn(std::size_t column) const {
+    std::vector<double> out(size(), std::nan(""));
+    for (std::size_t r = 0; r < size(); ++r)
+        CsvScanner::parseNumber(value(r, column), out[r]);
+    return out;
+}
+
+// =============================================================================
+// Hash table
+// =============================================================================
+
+namespace {
+
+// Open-addressing table from CDS to a run of build-side rows. Rows are stored
+// grouped by key in `rows_`; each slot holds its key's [begin, end) in there.
+// Key 0 marks an empty slot, so the statewide code (all zeros) keeps its run
+// in `zero_` instead.
+class CdsTable {
+public:
+    void build(const std::vector<uint64_t>& keys) {
+        std::vector<std::pair<uint64_t, uint32_t>> pairs;
+        pairs.reserve(keys.size());
+        for (std::size_t r = 0; r < keys.size(); ++r)
+            pairs.emplace_back(keys[r], static_cast<uint32_t>(r));
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::size_t distinct = 0;
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+            if (i == 0 || pairs[i].first != pairs[i - 1].first) ++distinct;
+        std::size_t capacity = 16;
+        while (capacity < distinct * 2) capacity <<= 1;
+        slots_.assign(capacity, Slot{});
+        mask_ = capacity - 1;
+
+        rows_.resize(pairs.size());
+        for (std::size_t i = 0; i < pairs.size();) {
+            std::size_t j = i;
+            while (j < pairs.size() && pairs[j].first == pairs[i].first) {
+                rows_[j] = pairs[j].second;
+                ++j;
+            }
+            if (pairs[i].first == 0) {
+                zero_ = { 0, static_cast<uint32_t>(i), static_cast<uint32_t>(j) };
+                i = j;
+                continue;
+            }
+            std::size_t at = hash(pairs[i].first);
+            while (slots_[at].key) at = (at + 1) & mask_;
+            slots_[at] = { pairs[i].first, static_cast<uint32_t>(i), static_cast<uint32_t>(j) };
+            i = j;
+        }
+    }
+
+    // Rows for `key` as [begin, end) pointers into rows_.
+    std::pair<const uint32_t*, const uint32_t*> find(uint64_t key) const {
+        if (!key) return {rows_.data() + zero_.begin, rows_.data() + zero_.end};
+        for (std::size_t at = hash(key);; at = (at + 1) & mask_) {
+            const Slot& s = slots_[at];
+            if (s.key == key) return {rows_.data() + s.begin, rows_.data() + s.end};
+            if (!s.key)       return {nullptr, nullptr};
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t key   = 0;   // 0 = empty
+        uint32_t begin = 0;
+        uint32_t end   = 0;
+    };
+
+    std::size_t hash(uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+    }
+
+    std::vector<Slot>     slots_;
+    Slot                  zero_;
+    std::vector<uint32_t> rows_;
+    std::size_t           mask_ = 0;
+};
+
+struct ProbeArg {
+    const CdsTable*              table;
+    const std::vector<uint64_t>* keys;        // probe side
+    std::size_t                  begin;
+    std::size_t                  end;         // exclusive
+    bool                         probeIsStore;
+    std::vector<std::pair<uint32_t, uint32_t>> out;   // (store row, dataset row)
+};
+
+void* probeWorker(void* raw) {
+    PerfRegion region("join_probe");
+    auto* a = static_cast<ProbeArg*>(raw);
+    for (std::size_t r = a->begin; r < a->end; ++r) {
+        auto [first, last] = a->table->find((*a->keys)[r]);
+        for (const uint32_t* m = first; m != last; ++m) {
+            if (a->probeIsStore) a->out.emplace_back(static_cast<uint32_t>(r), *m);
+            else                 a->out.emplace_back(*m, static_cast<uint32_t>(r));
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// =============================================================================
+// CdsJoin
+// =============================================================================
+
+CdsJoin::CdsJoin(unsigned threads)
+    : threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+bool CdsJoin::run(const IndicatorStore& store, const CsvDataset& dataset, CdsJoinResult& out) const {
+    out.indicators.clear();
+    out.datasetRows.clear();
+    out.dataset = &dataset;
+    if (store.size() > UINT32_MAX || dataset.size() > UINT32_MAX) {
+        fprintf(stderr, "Error: CdsJoin: inputs are limited to 2^32 rows\n");
+        return false;
+    }
+
+    // Build over the smaller side, probe with the larger.
+    const bool probeIsStore = dataset.size() <= store.size();
+    const std::vector<uint64_t>& buildKeys = probeIsStore ? dataset.cdsColumn() : store.cds();
+    const std::vector<uint64_t>& probeKeys = probeIsStore ? store.cds() : dataset.cdsColumn();
+
+    CdsTable table;
+    {
+        PerfRegion region("join_build");
+        table.build(buildKeys);
+    }
+
+    const std::size_t n     = probeKeys.size();
+    const std::size_t parts = std::max<std::size_t>(1, std::min<std::size_t>(threads_, n / 4096));
+    std::vector<ProbeArg>  args(parts);
+    std::vector<pthread_t> tids(parts);
+    std::vector<bool>      spawned(parts, false);
+    for (std::size_t t = 0; t < parts; ++t) {
+        args[t] = { &table, &probeKeys, n * t / parts, n * (t + 1) / parts, probeIsStore, {} };
+        if (parts > 1 && pthread_create(&tids[t], nullptr, probeWorker, &args[t]) == 0)
+            spawned[t] = true;
+        else
+            probeWorker(&args[t]);   // single partition, or no thread to spare
+    }
+    for (std::size_t t = 0; t < parts; ++t)
+        if (spawned[t]) pthread_join(tids[t], nullptr);
+
+    // Stitch the partitions back together in probe order.
+    std::size_t total = 0;
+    for (const auto& a : args) total += a.out.size();
+    std::vector<std::size_t> storeRows;
+    storeRows.reserve(total);
+    out.datasetRows.reserve(total);
+    for (const auto& a : args)
+        for (const auto& [storeRow, dataRow] : a.out) {
+            storeRows.push_back(storeRow);
+            out.datasetRows.push_back(dataRow);
+        }
+    out.indicators.appendRows(store, storeRows);
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef CDSJOIN_H
+#define CDSJOIN_H
+
+#include "csvScanner.hh"
+#include "indicatorStore.hh"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// CsvDataset — any CDE CSV file keyed by CDS code (enrollment, FRPM,
+// staffing...).
+//
+// The file is read once with CsvScanner and kept as that buffer plus one
+// offset/length span per field, so every column stays available without a
+// std::string per value.
+// =============================================================================
+
+class CsvDataset {
+public:
+    // Loads `path`. The CDS key is `cdsColumn` when given; otherwise the
+    // first of CDSCode / CDS Code / CDS, or the County Code + District Code +
+    // School Code triple used by the FRPM and staffing files. Digits are
+    // taken from the key fields and anything else ('-', quotes) is ignored.
+    // Rows whose key has no digits are skipped.
+    bool load(const std::string& path, const std::string& cdsColumn = "");
+
+    std::size_t size() const { return keys_.size(); }
+    const std::vector<std::string>& columnNames() const { return names_; }
+    // Column for a header name, or -1.
+    int columnIndex(std::string_view name) const;
+
+    uint64_t                     cds(std::size_t row) const { return keys_[row]; }
+    const std::vector<uint64_t>& cdsColumn() const          { return keys_; }
+    std::string_view get(std::size_t row, std::size_t column) const {
+        const Span& s = spans_[row * names_.size() + column];
+        return std::string_view(csv_.data() + s.off, s.len);
+    }
+
+private:
+    struct Span {
+        uint32_t off = 0;
+        uint32_t len = 0;
+    };
+
+    CsvScanner               csv_;     // owns the buffer the spans point into
+    std::vector<std::string> names_;
+    std::vector<uint64_t>    keys_;
+    std::vector<Span>        spans_;   // row-major, names_.size() per row
+};
+
+// =============================================================================
+// CdsJoin — inner hash join of indicator rows with a CsvDataset on CDS.
+//
+// The smaller side is loaded into an open-addressing table keyed by CDS
+// (rows grouped per key, so a school with many indicator rows or a file
+// with several rows per school both work). The larger side is then split
+// into one contiguous partition per thread and probed in parallel. Output
+// follows the probe side's row order and is the same for any thread count.
+//
+// Joined indicator rows land in a regular IndicatorStore, so they go
+// straight to saveEncoded(), the partitioned writer or the NumPy bindings.
+// The CSV side stays late-materialised: one dataset row number per joined
+// row, with helpers to pull a column out as text or numbers.
+// =============================================================================
+
+struct CdsJoinResult {
+    IndicatorStore        indicators;    // matched indicator rows
+    std::vector<uint32_t> datasetRows;   // dataset row for each joined row
+    const CsvDataset*     dataset = nullptr;
+
+    std::size_t size() const { return datasetRows.size(); }
+
+    std::string_view value(std::size_t row, std::size_t column) const {
+        return dataset->get(datasetRows[row], column);
+    }
+    // Every non-empty value is a number or CDE's "*" suppression marker.
+    bool isNumeric(std::size_t column) const;
+    // The column as numbers; NaN where a value is empty or not numeric.
+    std::vector<double> numericColumn(std::size_t column) const;
+};
+
+class CdsJoin {
+public:
+    // threads = 0 uses one per hardware core.
+    explicit CdsJoin(unsigned threads = 0);
+
+    // Replaces `out` with the joined rows. `dataset` must outlive `out`.
+    bool run(const IndicatorStore& store, const CsvDataset& dataset, CdsJoinResult& out) const;
+
+private:
+    unsigned threads_;
+};
+
+#endif // CDSJOIN_H
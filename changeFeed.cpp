@@ -0,0 +1,304 @@
+#include "changeFeed.hh"
+#include <nlohmann/json.hpp>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using json  = nlohmann::json;
+using ojson = nlohmann::ordered_json;   // keeps "seq" first on each line
+
+// Diffed fields, in event order. SCHOOL_YEAR_ID and INDICATOR_ID are part of
+// the row key and never "change".
+static const std::pair<const char*, IndicatorStore::IntColumn> DIFF_COLUMNS[] = {
+    {"status",      IndicatorStore::STATUS},
+    {"change",      IndicatorStore::CHANGE},
+    {"changeId",    IndicatorStore::CHANGE_ID},
+    {"statusId",    IndicatorStore::STATUS_ID},
+    {"performance", IndicatorStore::PERFORMANCE},
+    {"totalGroups", IndicatorStore::TOTAL_GROUPS},
+    {"red",         IndicatorStore::RED},
+    {"orange",      IndicatorStore::ORANGE},
+    {"yellow",      IndicatorStore::YELLOW},
+    {"green",       IndicatorStore::GREEN},
+    {"blue",        IndicatorStore::BLUE},
+};
+
+static ojson columnValue(const IndicatorStore& s, IndicatorStore::IntColumn c, std::size_t row) {
+    const int32_t v = s.column(c)[row];
+    if (c == IndicatorStore::STATUS || c == IndicatorStore::CHANGE)
+        return IndicatorStore::toFloat(v);
+    return v;
+}
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+std::size_t ChangeFeed::RowKeyHash::operator()(const RowKey& k) const {
+    std::size_t h = std::hash<uint64_t>()(k.cds);
+    h ^= std::hash<int64_t>()((int64_t(k.schoolYearId) << 32) | uint32_t(k.indicatorId))
+         + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<std::string>()(k.studentGroup) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+ChangeFeed::RowKey ChangeFeed::keyOf(const IndicatorStore& store, std::size_t row) {
+    return RowKey{store.cds()[row],
+                  store.column(IndicatorStore::SCHOOL_YEAR_ID)[row],
+                  store.column(IndicatorStore::INDICATOR_ID)[row],
+                  store.studentGroup(row)};
+}
+
+ChangeFeed::ChangeFeed(IndicatorStore& store) : store_(store) {
+    index_.reserve(store_.size());
+    for (std::size_t row = 0; row < store_.size(); ++row)
+        index_[keyOf(store_, row)] = row;   // later rows win, as in ingest()
+}
+
+ChangeFeed::~ChangeFeed() {
+    close();
+}
+
+// =============================================================================
+// Outputs
+// =============================================================================
+
+// Offset of the last '\n' before `pos`, or -1. Reads backwards in blocks,
+// so a long final line costs no more than its own length.
+static long lastNewlineBefore(FILE* in, long pos) {
+    char block[4096];
+    while (pos > 0) {
+        const long from = pos > static_cast<long>(sizeof(block)) ? pos - static_cast<long>(sizeof(block)) : 0;
+        fseek(in, from, SEEK_SET);
+        const std::size_t n = fread(block, 1, static_cast<std::size_t>(pos - from), in);
+        if (n != static_cast<std::size_t>(pos - from)) return -1;
+        for (std::size_t i = n; i > 0; --i)
+            if (block[i - 1] == '\n') return from + static_cast<long>(i - 1);
+        pos = from;
+    }
+    return -1;
+}
+
+bool ChangeFeed::openLog(const std::string& path) {
+    std::lock_guard<std::mutex> lk(mtx_);
+
+    // Continue the sequence from the last complete line of an existing log.
+    // A final line without its '\n' was torn by a crash mid-write: it is
+    // dropped, and the file cut back to the last complete line, so the
+    // next event starts on a line of its own.
+    if (FILE* in = fopen(path.c_str(), "rb")) {
+        fseek(in, 0, SEEK_END);
+        const long size  = ftell(in);
+        const long end   = lastNewlineBefore(in, size) + 1;   // just past the last complete line
+        const long start = end > 0 ? lastNewlineBefore(in, end - 1) + 1 : 0;
+        std::string last(static_cast<std::size_t>(end > 0 ? end - 1 - start : 0), '\0');
+        fseek(in, start, SEEK_SET);
+        const bool read = last.empty() || fread(&last[0], 1, last.size(), in) == last.size();
+        fclose(in);
+
+        if (!read) {
+            fprintf(stderr, "Error: Could not read change feed log: %s\n", path.c_str());
+            return false;
+        }
+        if (!last.empty()) {
+            try {
+                seq_ = json::parse(last).at("seq").get<uint64_t>();
+            } catch (const json::exception& e) {
+                fprintf(stderr, "Error: Cannot resume change feed %s: %s\n", path.c_str(), e.what());
+                return false;
+            }
+        }
+        if (end < size) {
+            fprintf(stderr, "[WARN] Dropping %ld bytes of a torn last line in %s\n", size - end, path.c_str());
+            if (truncate(path.c_str(), end) != 0) {
+                fprintf(stderr, "Error: Could not truncate change feed log %s: %s\n",
+                        path.c_str(), strerror(errno));
+                return false;
+            }
+        }
+    }
+
+    log_ = fopen(path.c_str(), "ab");
+    if (!log_) {
+        fprintf(stderr, "Error: Could not open change feed log: %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ChangeFeed::listen(const std::string& socketPath) {
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: Socket path too long: %s\n", socketPath.c_str());
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        fprintf(stderr, "Error: socket: %s\n", strerror(errno));
+        return false;
+    }
+    ::unlink(socketPath.c_str());   // stale socket from a previous run
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 16) != 0) {
+        fprintf(stderr, "Error: Could not listen on %s: %s\n", socketPath.c_str(), strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    socket_path_ = socketPath;
+
+    stop_ = false;
+    int err = pthread_create(&accept_thread_, nullptr, &ChangeFeed::acceptLoop, this);
+    if (err) {
+        fprintf(stderr, "Error: pthread_create failed: %s\n", strerror(err));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    accepting_ = true;
+    return true;
+}
+
+void* ChangeFeed::acceptLoop(void* raw) {
+    auto* self = static_cast<ChangeFeed*>(raw);
+    while (!self->stop_) {
+        struct pollfd pfd = { self->listen_fd_, POLLIN, 0 };
+        if (poll(&pfd, 1, 250) <= 0) continue;   // wake periodically to notice close()
+        int fd = accept(self->listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::lock_guard<std::mutex> lk(self->subs_mtx_);
+        self->subs_.push_back(fd);
+    }
+    return nullptr;
+}
+
+void ChangeFeed::close() {
+    if (accepting_) {
+        stop_ = true;
+        pthread_join(accept_thread_, nullptr);
+        accepting_ = false;
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        ::unlink(socket_path_.c_str());
+    }
+    {
+        std::lock_guard<std::mutex> lk(subs_mtx_);
+        for (int fd : subs_) ::close(fd);
+        subs_.clear();
+    }
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (log_) {
+        fclose(log_);
+        log_ = nullptr;
+    }
+}
+
+std::size_t ChangeFeed::subscribers() const {
+    std::lock_guard<std::mutex> lk(subs_mtx_);
+    return subs_.size();
+}
+
+// Caller holds mtx_, which keeps socket output in sequence order.
+void ChangeFeed::publish(const std::string& lines) {
+    if (log_) {
+        fwrite(lines.data(), 1, lines.size(), log_);
+        fflush(log_);   // visible to tail -f as soon as the card is ingested
+    }
+
+    std::lock_guard<std::mutex> lk(subs_mtx_);
+    for (std::size_t i = 0; i < subs_.size();) {
+        ssize_t n = send(subs_[i], lines.data(), lines.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n == static_cast<ssize_t>(lines.size())) {
+            ++i;
+            continue;
+        }
+        // Gone, or too slow to keep up: a partial write would corrupt its
+        // stream, so drop it; it can resume from the log.
+        ::close(subs_[i]);
+        subs_[i] = subs_.back();
+        subs_.pop_back();
+    }
+}
+
+// =============================================================================
+// Diffing
+// =============================================================================
+
+std::string ChangeFeed::eventLine(uint64_t seq, const IndicatorStore& fresh, std::size_t row,
+                                  const std::size_t* oldRow) const
+{
+    ojson e = {
+        {"seq",          seq},
+        {"kind",         oldRow ? "changed" : "added"},
+        {"cds",          IndicatorStore::formatCds(fresh.cds()[row])},
+        {"schoolYearId", fresh.column(IndicatorStore::SCHOOL_YEAR_ID)[row]},
+        {"indicatorId",  fresh.column(IndicatorStore::INDICATOR_ID)[row]},
+        {"studentGroup", fresh.studentGroup(row)},
+    };
+
+    if (oldRow) {
+        ojson changes = ojson::object();
+        for (const auto& [name, c] : DIFF_COLUMNS)
+            if (store_.column(c)[*oldRow] != fresh.column(c)[row])
+                changes[name] = {columnValue(store_, c, *oldRow), columnValue(fresh, c, row)};
+        if (store_.count()[*oldRow] != fresh.count()[row])
+            changes["count"] = {store_.count()[*oldRow], fresh.count()[row]};
+        if (store_.isPrivateData()[*oldRow] != fresh.isPrivateData()[row])
+            changes["isPrivateData"] = {store_.isPrivateData()[*oldRow] != 0,
+                                        fresh.isPrivateData()[row] != 0};
+        e["changes"] = std::move(changes);
+    } else {
+        ojson values = ojson::object();
+        for (const auto& [name, c] : DIFF_COLUMNS)
+            values[name] = columnValue(fresh, c, row);
+        values["count"]         = fresh.count()[row];
+        values["isPrivateData"] = fresh.isPrivateData()[row] != 0;
+        e["values"] = std::move(values);
+    }
+    return e.dump() + "\n";
+}
+
+static bool rowsDiffer(const IndicatorStore& a, std::size_t ra,
+                       const IndicatorStore& b, std::size_t rb) {
+    for (const auto& [name, c] : DIFF_COLUMNS)
+        if (a.column(c)[ra] != b.column(c)[rb]) return true;
+    return a.count()[ra] != b.count()[rb] ||
+           a.isPrivateData()[ra] != b.isPrivateData()[rb];
+}
+
+std::size_t ChangeFeed::ingest(const SummaryCard& card) {
+    // Flatten outside the lock; this is most of the per-card work.
+    IndicatorStore fresh;
+    fresh.append(card);
+    if (fresh.size() == 0) return 0;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    std::string lines;
+    std::size_t events = 0;
+
+    for (std::size_t row = 0; row < fresh.size(); ++row) {
+        RowKey key = keyOf(fresh, row);
+        auto found = index_.find(key);
+        if (found == index_.end()) {
+            lines += eventLine(++seq_, fresh, row, nullptr);
+            store_.appendRows(fresh, {row});
+            index_.emplace(std::move(key), store_.size() - 1);
+            ++events;
+        } else if (rowsDiffer(store_, found->second, fresh, row)) {
+            lines += eventLine(++seq_, fresh, row, &found->second);
+            store_.assignRow(found->second, fresh, row);
+            ++events;
+        }
+    }
+
+    if (!lines.empty()) publish(lines);
+    return events;
+}
@@ -0,0 +1,103 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include "indicatorStore.hh"
+#include "summaryCard.hh"
+#include <pthread.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// =============================================================================
+// ChangeFeed — append-only stream of indicator updates.
+//
+// The feed holds the current state in an IndicatorStore (seeded from the
+// last run's export, or empty). Each ingested card is diffed against it row
+// by row, keyed on (CDS, schoolYearId, indicatorId, studentGroup), and every
+// new or changed row becomes one event with old -> new values for the fields
+// that moved. The store is then updated in place, so the next run diffs
+// against this one.
+//
+// Events are JSON lines with a monotonically increasing "seq":
+//
+//   {"seq":42,"kind":"changed","cds":"19647331934609","schoolYearId":10,
+//    "indicatorId":7,"studentGroup":"ALL","changes":{"red":[1,0],"orange":[0,1]}}
+//   {"seq":43,"kind":"added", ... ,"values":{"status":12.3, ...}}
+//
+// They are appended to a log file (tail -f friendly; the sequence resumes
+// across restarts) and pushed to every client connected to a local unix
+// socket. The socket is live-only: a consumer that falls behind or
+// reconnects catches up from the log by seq. Slow socket clients are
+// dropped rather than allowed to stall ingest.
+// =============================================================================
+
+class ChangeFeed {
+public:
+    // `store` is the baseline and is kept up to date by ingest(); it must
+    // outlive the feed.
+    explicit ChangeFeed(IndicatorStore& store);
+    ~ChangeFeed();
+
+    ChangeFeed(const ChangeFeed&)            = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+    // Opens (or creates) the log for appending and continues its sequence.
+    bool openLog(const std::string& path);
+
+    // Listens on a unix domain socket and streams events to connected
+    // clients from then on.
+    bool listen(const std::string& socketPath);
+
+    void close();
+
+    // Diffs the card against the store, emits events and applies the
+    // changes. Thread-safe. Returns the number of events emitted.
+    std::size_t ingest(const SummaryCard& card);
+
+    uint64_t    sequence()    const { return seq_.load(); }
+    std::size_t subscribers() const;
+
+private:
+    struct RowKey {
+        uint64_t    cds;
+        int32_t     schoolYearId;
+        int32_t     indicatorId;
+        std::string studentGroup;
+        bool operator==(const RowKey& o) const {
+            return cds == o.cds && schoolYearId == o.schoolYearId &&
+                   indicatorId == o.indicatorId && studentGroup == o.studentGroup;
+        }
+    };
+    struct RowKeyHash {
+        std::size_t operator()(const RowKey& k) const;
+    };
+
+    static RowKey keyOf(const IndicatorStore& store, std::size_t row);
+    std::string   eventLine(uint64_t seq, const IndicatorStore& fresh, std::size_t row,
+                            const std::size_t* oldRow) const;
+    void          publish(const std::string& lines);
+
+    static void* acceptLoop(void* raw);
+
+    IndicatorStore&                                  store_;
+    std::unordered_map<RowKey, std::size_t, RowKeyHash> index_;
+    mutable std::mutex                               mtx_;   // store_, index_, log_
+    std::atomic<uint64_t>                            seq_{0};
+
+    FILE* log_ = nullptr;
+
+    std::string           socket_path_;
+    int                   listen_fd_ = -1;
+    pthread_t             accept_thread_;
+    bool                  accepting_ = false;
+    std::atomic<bool>     stop_{false};
+    mutable std::mutex    subs_mtx_;
+    std::vector<int>      subs_;
+};
+
+#endif // CHANGEFEED_H
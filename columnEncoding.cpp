@@ -0,0 +1,468 @@
+#include "columnEncoding.hh"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLUMN_ENCODING_X86 1
+#endif
+
+// =============================================================================
+// Serialisation helpers
+// =============================================================================
+
+// Upper bound on any single element count read back from disk, for streams
+// that cannot report how much is left (see bytesLeft).
+static constexpr uint64_t MAX_SERIALISED_ELEMENTS = uint64_t(1) << 28;
+
+// Bytes between the read position and the end of the stream, so a corrupt
+// length field is rejected before anything is allocated for it. Streams
+// that cannot seek report MAX_SERIALISED_ELEMENTS.
+static uint64_t bytesLeft(std::istream& in) {
+    const std::streampos pos = in.tellg();
+    if (pos < 0) return MAX_SERIALISED_ELEMENTS;
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(pos);
+    return end > pos ? static_cast<uint64_t>(end - pos) : 0;
+}
+
+template <typename T>
+static void writePod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static bool readPod(std::istream& in, T& v) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+template <typename T>
+static void writeVector(std::ostream& out, const std::vector<T>& v) {
+    writePod(out, static_cast<uint64_t>(v.size()));
+    if (!v.empty())
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template <typename T>
+static bool readVector(std::istream& in, std::vector<T>& v) {
+    uint64_t n = 0;
+    if (!readPod(in, n) || n > MAX_SERIALISED_ELEMENTS || n > bytesLeft(in) / sizeof(T)) return false;
+    v.resize(static_cast<std::size_t>(n));
+    if (n == 0) return true;
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()), n * sizeof(T)));
+}
+
+// =============================================================================
+// CPU dispatch
+// =============================================================================
+
+#ifdef COLUMN_ENCODING_X86
+static bool cpuHasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#else
+static bool cpuHasAVX2() { return false; }
+#endif
+
+bool columnEncodingUsesAVX2() {
+    return cpuHasAVX2();
+}
+
+// =============================================================================
+// AVX2 kernels
+// =============================================================================
+
+#ifdef COLUMN_ENCODING_X86
+
+// Unpacks `groups` groups of 8 values of `width` bits (1..25) starting at a
+// byte-aligned position. Each group of 8 consumes exactly `width` bytes, so
+// the gather offsets and shifts are identical for every group and are built
+// once. Widths above 25 can straddle five bytes and take the scalar path.
+__attribute__((target("avx2")))
+static void unpackAVX2(const uint8_t* src, std::size_t groups, unsigned width,
+                       uint32_t base, uint32_t* out)
+{
+    alignas(32) int32_t offsets[8];
+    alignas(32) int32_t shifts[8];
+    for (int k = 0; k < 8; ++k) {
+        offsets[k] = static_cast<int32_t>((k * width) >> 3);
+        shifts[k]  = static_cast<int32_t>((k * width) & 7);
+    }
+    const __m256i vOff  = _mm256_load_si256(reinterpret_cast<const __m256i*>(offsets));
+    const __m256i vSh   = _mm256_load_si256(reinterpret_cast<const __m256i*>(shifts));
+    const __m256i vMask = _mm256_set1_epi32(static_cast<int32_t>((1u << width) - 1u));
+    const __m256i vBase = _mm256_set1_epi32(static_cast<int32_t>(base));
+
+    for (std::size_t g = 0; g < groups; ++g) {
+        const int* p = reinterpret_cast<const int*>(src + g * width);
+        __m256i v = _mm256_i32gather_epi32(p, vOff, 1);
+        v = _mm256_srlv_epi32(v, vSh);
+        v = _mm256_and_si256(v, vMask);
+        v = _mm256_add_epi32(v, vBase);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + g * 8), v);
+    }
+}
+
+// In-place running sum over 64-bit lanes, four at a time, seeded with `carry`.
+// Returns the final running total.
+__attribute__((target("avx2")))
+static uint64_t prefixSumAVX2(uint64_t* data, std::size_t n, uint64_t carry)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i vCarry = _mm256_set1_epi64x(static_cast<long long>(carry));
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        // [a b c d] + [0 a b c]
+        __m256i t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(t, zero, 0x03));
+        // + [0 0 a a+b]
+        t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(t, zero, 0x0F));
+        x = _mm256_add_epi64(x, vCarry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), x);
+        vCarry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    carry = static_cast<uint64_t>(_mm256_extract_epi64(vCarry, 0));
+    for (; i < n; ++i) {
+        carry  += data[i];
+        data[i] = carry;
+    }
+    return carry;
+}
+
+#endif // COLUMN_ENCODING_X86
+
+static uint64_t prefixSumScalar(uint64_t* data, std::size_t n, uint64_t carry) {
+    for (std::size_t i = 0; i < n; ++i) {
+        carry  += data[i];
+        data[i] = carry;
+    }
+    return carry;
+}
+
+// =============================================================================
+// BitPackedColumn
+// =============================================================================
+
+unsigned BitPackedColumn::bitsFor(uint64_t v) {
+    return v == 0 ? 0u : 64u - static_cast<unsigned>(__builtin_clzll(v));
+}
+
+void BitPackedColumn::encode(const uint32_t* values, std::size_t n) {
+    uint32_t maxVal = 0;
+    for (std::size_t i = 0; i < n; ++i) maxVal |= values[i];
+    encode(values, n, bitsFor(maxVal));
+}
+
+void BitPackedColumn::encode(const uint32_t* values, std::size_t n, unsigned width) {
+    n_     = n;
+    width_ = std::min(width, 32u);
+    bytes_.assign((n * width_ + 7) / 8 + 8, 0);
+    if (width_ == 0) return;
+
+    const uint64_t mask = (width_ == 32) ? 0xFFFFFFFFull : ((1ull << width_) - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t bit = i * width_;
+        uint64_t word;
+        std::memcpy(&word, &bytes_[bit >> 3], sizeof(word));
+        word |= (static_cast<uint64_t>(values[i]) & mask) << (bit & 7);
+        std::memcpy(&bytes_[bit >> 3], &word, sizeof(word));
+    }
+}
+
+uint32_t BitPackedColumn::get(std::size_t i) const {
+    if (width_ == 0) return 0;
+    std::size_t bit = i * width_;
+    uint64_t word;
+    std::memcpy(&word, &bytes_[bit >> 3], sizeof(word));
+    const uint64_t mask = (width_ == 32) ? 0xFFFFFFFFull : ((1ull << width_) - 1);
+    return static_cast<uint32_t>((word >> (bit & 7)) & mask);
+}
+
+void BitPackedColumn::decode(uint32_t* out, uint32_t base) const {
+    decodeRange(0, n_, out, base);
+}
+
+void BitPackedColumn::decodeRange(std::size_t start, std::size_t count,
+                                  uint32_t* out, uint32_t base) const
+{
+    if (count == 0) return;
+    if (width_ == 0) {
+        std::fill(out, out + count, base);
+        return;
+    }
+
+    std::size_t done = 0;
+#ifdef COLUMN_ENCODING_X86
+    if (cpuHasAVX2() && width_ <= 25 && (start % 8) == 0) {
+        std::size_t groups = count / 8;
+        unpackAVX2(bytes_.data() + (start * width_) / 8, groups, width_, base, out);
+        done = groups * 8;
+    }
+#endif
+    for (std::size_t i = done; i < count; ++i)
+        out[i] = get(start + i) + base;
+}
+
+bool BitPackedColumn::write(std::ostream& out) const {
+    writePod(out, static_cast<uint64_t>(n_));
+    writePod(out, static_cast<uint32_t>(width_));
+    writeVector(out, bytes_);
+    return static_cast<bool>(out);
+}
+
+bool BitPackedColumn::read(std::istream& in) {
+    uint64_t n = 0;
+    uint32_t width = 0;
+    if (!readPod(in, n) || !readPod(in, width)) return false;
+    if (width > 32 || n > MAX_SERIALISED_ELEMENTS) return false;
+    if (!readVector(in, bytes_)) return false;
+    if (bytes_.size() != (n * width + 7) / 8 + 8) return false;
+    n_     = static_cast<std::size_t>(n);
+    width_ = width;
+    return true;
+}
+
+// =============================================================================
+// FrameOfReferenceColumn
+// =============================================================================
+
+void FrameOfReferenceColumn::encode(const int64_t* values, std::size_t n) {
+    n_ = n;
+    raw_.clear();
+    base_ = 0;
+    if (n == 0) { packed_.encode(nullptr, 0, 0); return; }
+
+    auto [lo, hi] = std::minmax_element(values, values + n);
+    const uint64_t range = static_cast<uint64_t>(*hi) - static_cast<uint64_t>(*lo);
+    if (range > std::numeric_limits<uint32_t>::max()) {
+        raw_.assign(values, values + n);
+        packed_.encode(nullptr, 0, 0);
+        return;
+    }
+
+    base_ = *lo;
+    std::vector<uint32_t> offsets(n);
+    for (std::size_t i = 0; i < n; ++i)
+        offsets[i] = static_cast<uint32_t>(static_cast<uint64_t>(values[i]) -
+                                           static_cast<uint64_t>(base_));
+    packed_.encode(offsets.data(), n, BitPackedColumn::bitsFor(range));
+}
+
+void FrameOfReferenceColumn::encode(const int32_t* values, std::size_t n) {
+    std::vector<int64_t> wide(values, values + n);
+    encode(wide.data(), n);
+}
+
+void FrameOfReferenceColumn::decode(int32_t* out) const {
+    if (!raw_.empty()) {
+        for (std::size_t i = 0; i < n_; ++i) out[i] = static_cast<int32_t>(raw_[i]);
+        return;
+    }
+    // Two's complement: base + offset modulo 2^32 reproduces the int32 value.
+    packed_.decode(reinterpret_cast<uint32_t*>(out), static_cast<uint32_t>(base_));
+}
+
+void FrameOfReferenceColumn::decode(int64_t* out) const {
+    if (!raw_.empty()) {
+        std::copy(raw_.begin(), raw_.end(), out);
+        return;
+    }
+    static constexpr std::size_t CHUNK = 1024;
+    uint32_t tmp[CHUNK];
+    for (std::size_t start = 0; start < n_; start += CHUNK) {
+        std::size_t count = std::min(CHUNK, n_ - start);
+        packed_.decodeRange(start, count, tmp);
+        for (std::size_t i = 0; i < count; ++i)
+            out[start + i] = base_ + static_cast<int64_t>(tmp[i]);
+    }
+}
+
+int64_t FrameOfReferenceColumn::get(std::size_t i) const {
+    if (!raw_.empty()) return raw_[i];
+    return base_ + static_cast<int64_t>(packed_.get(i));
+}
+
+bool FrameOfReferenceColumn::write(std::ostream& out) const {
+    writePod(out, static_cast<uint64_t>(n_));
+    writePod(out, base_);
+    writeVector(out, raw_);
+    return packed_.write(out);
+}
+
+bool FrameOfReferenceColumn::read(std::istream& in) {
+    uint64_t n = 0;
+    if (!readPod(in, n) || !readPod(in, base_)) return false;
+    if (!readVector(in, raw_) || !packed_.read(in)) return false;
+    if (raw_.empty() ? packed_.size() != n : raw_.size() != n) return false;
+    n_ = static_cast<std::size_t>(n);
+    return true;
+}
+
+// =============================================================================
+// DictionaryColumn
+// =============================================================================
+
+void DictionaryColumn::encode(const uint32_t* codes, std::size_t n,
+                              const std::vector<std::string>& dictionary)
+{
+    dictionary_ = dictionary;
+    uint32_t maxCode = dictionary.empty() ? 0 : static_cast<uint32_t>(dictionary.size() - 1);
+    codes_.encode(codes, n, BitPackedColumn::bitsFor(maxCode));
+}
+
+void DictionaryColumn::encode(const std::vector<std::string>& values) {
+    std::vector<std::string>                  dict;
+    std::unordered_map<std::string, uint32_t> index;
+    std::vector<uint32_t>                     codes(values.size());
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        auto [it, inserted] = index.try_emplace(values[i], static_cast<uint32_t>(dict.size()));
+        if (inserted) dict.push_back(values[i]);
+        codes[i] = it->second;
+    }
+    encode(codes.data(), codes.size(), dict);
+}
+
+std::size_t DictionaryColumn::byteSize() const {
+    std::size_t bytes = codes_.byteSize();
+    for (const auto& s : dictionary_) bytes += s.size() + sizeof(uint32_t);
+    return bytes;
+}
+
+bool DictionaryColumn::write(std::ostream& out) const {
+    writePod(out, static_cast<uint32_t>(dictionary_.size()));
+    for (const auto& s : dictionary_) {
+        writePod(out, static_cast<uint32_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+    return codes_.write(out);
+}
+
+bool DictionaryColumn::read(std::istream& in) {
+    uint32_t entries = 0;
+    if (!readPod(in, entries) || entries > bytesLeft(in) / sizeof(uint32_t)) return false;
+    dictionary_.clear();
+    dictionary_.reserve(entries);
+    for (uint32_t i = 0; i < entries; ++i) {
+        uint32_t len = 0;
+        if (!readPod(in, len) || len > (1u << 20) || len > bytesLeft(in)) return false;
+        std::string s(len, '\0');
+        if (len && !in.read(&s[0], len)) return false;
+        dictionary_.push_back(std::move(s));
+    }
+    if (!codes_.read(in)) return false;
+    // Reject codes that would index past the dictionary: the bit width
+    // alone allows up to the next power of two.
+    if (codes_.size() == 0) return true;
+    std::vector<uint32_t> codes(codes_.size());
+    codes_.decode(codes.data());
+    const uint32_t maxCode = *std::max_element(codes.begin(), codes.end());
+    return maxCode < dictionary_.size();
+}
+
+// =============================================================================
+// DeltaColumn
+// =============================================================================
+
+bool DeltaColumn::encode(const uint64_t* values, std::size_t n) {
+    first_ = 0;
+    exceptionIndex_.clear();
+    exceptionValue_.clear();
+    deltas_.encode(nullptr, 0, 0);
+    if (n == 0) return true;
+
+    std::vector<uint64_t> deltas(n);
+    std::size_t           widthHistogram[65] = {};
+    deltas[0] = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        if (values[i] < values[i - 1]) return false;
+        deltas[i] = values[i] - values[i - 1];
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        ++widthHistogram[BitPackedColumn::bitsFor(deltas[i])];
+
+    // Pick the packed width that minimises payload + exception bits.
+    static constexpr std::size_t EXCEPTION_BITS = 8 * (sizeof(uint32_t) + sizeof(uint64_t));
+    std::size_t exceptionsAbove[66] = {};
+    for (int w = 64; w >= 0; --w)
+        exceptionsAbove[w] = exceptionsAbove[w + 1] + widthHistogram[w];
+
+    unsigned    bestWidth = 32;
+    std::size_t bestCost  = std::numeric_limits<std::size_t>::max();
+    for (unsigned w = 0; w <= 32; ++w) {
+        std::size_t cost = n * w + exceptionsAbove[w + 1] * EXCEPTION_BITS;
+        if (cost < bestCost) { bestCost = cost; bestWidth = w; }
+    }
+
+    std::vector<uint32_t> packed(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (BitPackedColumn::bitsFor(deltas[i]) > bestWidth) {
+            exceptionIndex_.push_back(static_cast<uint32_t>(i));
+            exceptionValue_.push_back(deltas[i]);
+            packed[i] = 0;
+        } else {
+            packed[i] = static_cast<uint32_t>(deltas[i]);
+        }
+    }
+    first_ = values[0];
+    deltas_.encode(packed.data(), n, bestWidth);
+    return true;
+}
+
+void DeltaColumn::decode(uint64_t* out) const {
+    const std::size_t n = deltas_.size();
+    static constexpr std::size_t CHUNK = 1024;
+    uint32_t    tmp[CHUNK];
+    uint64_t    carry = first_;
+    std::size_t exc   = 0;
+    const bool  avx2  = cpuHasAVX2();
+
+    for (std::size_t start = 0; start < n; start += CHUNK) {
+        std::size_t count = std::min(CHUNK, n - start);
+        deltas_.decodeRange(start, count, tmp);
+
+        uint64_t* dst = out + start;
+        for (std::size_t i = 0; i < count; ++i) dst[i] = tmp[i];
+        while (exc < exceptionIndex_.size() && exceptionIndex_[exc] < start + count) {
+            dst[exceptionIndex_[exc] - start] = exceptionValue_[exc];
+            ++exc;
+        }
+#ifdef COLUMN_ENCODING_X86
+        if (avx2) { carry = prefixSumAVX2(dst, count, carry); continue; }
+#endif
+        (void)avx2;
+        carry = prefixSumScalar(dst, count, carry);
+    }
+}
+
+std::size_t DeltaColumn::byteSize() const {
+    return sizeof(first_) + deltas_.byteSize() +
+           exceptionIndex_.size() * (sizeof(uint32_t) + sizeof(uint64_t));
+}
+
+bool DeltaColumn::write(std::ostream& out) const {
+    writePod(out, first_);
+    writeVector(out, exceptionIndex_);
+    writeVector(out, exceptionValue_);
+    return deltas_.write(out);
+}
+
+bool DeltaColumn::read(std::istream& in) {
+    if (!readPod(in, first_)) return false;
+    if (!readVector(in, exceptionIndex_) || !readVector(in, exceptionValue_)) return false;
+    if (exceptionIndex_.size() != exceptionValue_.size()) return false;
+    if (!deltas_.read(in)) return false;
+    for (std::size_t i = 0; i < exceptionIndex_.size(); ++i) {
+        if (exceptionIndex_[i] >= deltas_.size()) return false;
+        if (i > 0 && exceptionIndex_[i] <= exceptionIndex_[i - 1]) return false;
+    }
+    return true;
+}
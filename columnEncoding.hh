@@ -0,0 +1,125 @@
+#ifndef COLUMNENCODING_H
+#define COLUMNENCODING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Column encodings for indicator history.
+//
+// Every column decodes in bulk into a caller-provided contiguous array. On
+// x86-64 CPUs with AVX2 the unpack/prefix-sum kernels are selected at runtime;
+// everything else falls back to a portable scalar loop producing identical
+// output. Serialisation is little-endian and assumes a little-endian host.
+// =============================================================================
+
+// Fixed-width bit-packing of unsigned 32-bit values (0..32 bits per value).
+// Value i lives at bit offset i * width, least-significant bit first.
+class BitPackedColumn {
+public:
+    void encode(const uint32_t* values, std::size_t n);
+    void encode(const uint32_t* values, std::size_t n, unsigned width);
+
+    // Decodes every value into out[0 .. size()), adding `base` to each one
+    // (modulo 2^32). The add is fused into the unpack for frame-of-reference.
+    void decode(uint32_t* out, uint32_t base = 0) const;
+    // Decodes values [start, start + count). Starting on a multiple of 8
+    // keeps the AVX2 path byte-aligned.
+    void decodeRange(std::size_t start, std::size_t count, uint32_t* out,
+                     uint32_t base = 0) const;
+    uint32_t get(std::size_t i) const;
+
+    std::size_t size()     const { return n_; }
+    unsigned    bitWidth() const { return width_; }
+    std::size_t byteSize() const { return bytes_.size(); }
+
+    bool write(std::ostream& out) const;
+    bool read(std::istream& in);
+
+    // Number of bits needed to represent v (0 for v == 0).
+    static unsigned bitsFor(uint64_t v);
+
+private:
+    std::size_t          n_     = 0;
+    unsigned             width_ = 0;
+    std::vector<uint8_t> bytes_; // padded so 8-byte unaligned loads never overrun
+};
+
+// Frame-of-reference: values stored as (v - min) bit-packed at the width of
+// the range. Ranges wider than 32 bits fall back to raw 64-bit storage.
+class FrameOfReferenceColumn {
+public:
+    void encode(const int64_t* values, std::size_t n);
+    void encode(const int32_t* values, std::size_t n);
+
+    // decode(int32_t*) requires every value to fit in 32 bits, which holds
+    // for any column that was encoded from int32_t input.
+    void decode(int32_t* out) const;
+    void decode(int64_t* out) const;
+    int64_t get(std::size_t i) const;
+
+    std::size_t size()     const { return n_; }
+    std::size_t byteSize() const { return packed_.byteSize() + raw_.size() * sizeof(int64_t); }
+
+    bool write(std::ostream& out) const;
+    bool read(std::istream& in);
+
+private:
+    std::size_t          n_    = 0;
+    int64_t              base_ = 0;
+    BitPackedColumn      packed_;
+    std::vector<int64_t> raw_;   // non-empty only when the range exceeds 32 bits
+};
+
+// Dictionary encoding for low-cardinality strings (category, studentGroup).
+// Codes index into the dictionary and are bit-packed.
+class DictionaryColumn {
+public:
+    void encode(const uint32_t* codes, std::size_t n, const std::vector<std::string>& dictionary);
+    void encode(const std::vector<std::string>& values);
+
+    void decodeCodes(uint32_t* out) const { codes_.decode(out); }
+    const std::string& get(std::size_t i) const { return dictionary_[codes_.get(i)]; }
+    const std::vector<std::string>& dictionary() const { return dictionary_; }
+
+    std::size_t size()     const { return codes_.size(); }
+    std::size_t byteSize() const;
+
+    bool write(std::ostream& out) const;
+    bool read(std::istream& in);
+
+private:
+    std::vector<std::string> dictionary_;
+    BitPackedColumn          codes_;
+};
+
+// Delta encoding for a non-decreasing uint64 sequence such as sorted CDS
+// codes. Deltas are bit-packed at the width that minimises total size; the
+// few deltas wider than that (county/district boundaries) are patched in from
+// an exception list, PFOR-style.
+class DeltaColumn {
+public:
+    // Returns false (and leaves the column empty) if the input is not sorted.
+    bool encode(const uint64_t* values, std::size_t n);
+    void decode(uint64_t* out) const;
+
+    std::size_t size()     const { return deltas_.size(); }
+    std::size_t byteSize() const;
+
+    bool write(std::ostream& out) const;
+    bool read(std::istream& in);
+
+private:
+    uint64_t              first_ = 0;
+    BitPackedColumn       deltas_;          // exception slots hold 0
+    std::vector<uint32_t> exceptionIndex_;  // ascending
+    std::vector<uint64_t> exceptionValue_;
+};
+
+// True when the AVX2 decode kernels are in use on this CPU.
+bool columnEncodingUsesAVX2();
+
+#endif // COLUMNENCODING_H
@@ -0,0 +1,91 @@
+#include "csvScanner.hh"
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+
+bool CsvScanner::open(const std::string& path) {
+    buf_.clear();
+    pos_ = 0;
+
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open CSV file: %s\n", path.c_str());
+        return false;
+    }
+    fseek(in, 0, SEEK_END);
+    long fileSize = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    // Callers keep uint32_t offsets into the buffer.
+    if (fileSize < 0 || static_cast<unsigned long>(fileSize) > UINT32_MAX) {
+        fprintf(stderr, "Error: CSV file too large: %s\n", path.c_str());
+        fclose(in);
+        return false;
+    }
+    buf_.resize(static_cast<std::size_t>(fileSize));
+    std::size_t got = fread(&buf_[0], 1, buf_.size(), in);
+    fclose(in);
+    buf_.resize(got);
+
+    if (buf_.compare(0, 3, "\xEF\xBB\xBF") == 0) pos_ = 3;
+    return true;
+}
+
+// Scans one field and leaves pos_ after its terminator. Returns the
+// terminator: ',', '\n', or 0 at end of input.
+char CsvScanner::scanField(std::string_view& out) {
+    const std::size_t size = buf_.size();
+    char* p = &buf_[0];
+
+    if (pos_ < size && p[pos_] == '"') {
+        const std::size_t start = ++pos_;
+        std::size_t       write = start;
+        while (pos_ < size) {
+            char c = p[pos_];
+            if (c == '"') {
+                if (pos_ + 1 < size && p[pos_ + 1] == '"') { p[write++] = '"'; pos_ += 2; continue; }
+                ++pos_;
+                break;
+            }
+            p[write++] = c;
+            ++pos_;
+        }
+        out = std::string_view(p + start, write - start);
+        while (pos_ < size && p[pos_] != ',' && p[pos_] != '\n') ++pos_;   // stray bytes after the quote
+    } else {
+        std::size_t begin = pos_;
+        while (pos_ < size && p[pos_] != ',' && p[pos_] != '\n') ++pos_;
+        std::size_t end = pos_;
+        while (begin < end && (p[begin] == ' ' || p[begin] == '\t')) ++begin;
+        while (end > begin && (p[end - 1] == '\r' || p[end - 1] == ' ' || p[end - 1] == '\t')) --end;
+        out = std::string_view(p + begin, end - begin);
+    }
+
+    if (pos_ >= size) return 0;
+    return p[pos_++];
+}
+
+bool CsvScanner::next(std::vector<std::string_view>& fields) {
+    while (pos_ < buf_.size()) {
+        fields.clear();
+        bool blank = true;
+        for (char term = ','; term == ',';) {
+            std::string_view f;
+            term = scanField(f);
+            if (!f.empty()) blank = false;
+            fields.push_back(f);
+        }
+        if (!blank) return true;
+    }
+    fields.clear();
+    return false;
+}
+
+// Text that cannot start a number is turned away up front: from_chars is
+// slow to reject it.
+bool CsvScanner::parseNumber(std::string_view field, double& out) {
+    if (!field.empty() && field.front() == '+') field.remove_prefix(1);
+    if (field.empty() || !((field.front() >= '0' && field.front() <= '9') || field.front() == '-' || field.front() == '.'))
+        return false;
+    auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), out);
+    return ec == std::errc() && end == field.data() + field.size();
+}
@@ -0,0 +1,42 @@
+#ifndef CSVSCANNER_H
+#define CSVSCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// CsvScanner — whole-file CSV reader for the CDE data files.
+//
+// Reads the file into one buffer and splits records in place: fields come
+// back as views into that buffer, with quotes removed and "" unescaped
+// (unescaping only ever shortens a field, so it is done where it lies).
+// Unquoted fields are trimmed of surrounding blanks and a trailing \r.
+// Newlines inside quoted fields are kept. A UTF-8 BOM is skipped.
+// =============================================================================
+
+class CsvScanner {
+public:
+    bool open(const std::string& path);
+
+    // Splits the next record into `fields`. Returns false at end of input.
+    // Views stay valid for the life of the scanner.
+    bool next(std::vector<std::string_view>& fields);
+
+    // The buffer the views point into, for callers that keep offsets.
+    const char* data() const { return buf_.data(); }
+    std::size_t size() const { return buf_.size(); }
+
+    // The whole of `field` as a number ("12", "-3.5", "+.5"). Anything else,
+    // including an empty field or trailing text, is not a number.
+    static bool parseNumber(std::string_view field, double& out);
+
+private:
+    char scanField(std::string_view& out);
+
+    std::string buf_;
+    std::size_t pos_ = 0;
+};
+
+#endif // CSVSCANNER_H
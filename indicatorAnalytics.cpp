@@ -0,0 +1,491 @@
+#include "indicatorAnalytics.hh"
+#include "perfRegions.hh"
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INDICATOR_ANALYTICS_X86 1
+#endif
+
+static constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// Rows per z-score task. A multiple of 64, so no two tasks share a word of
+// the output bitmap.
+static constexpr std::size_t Z_CHUNK_ROWS = std::size_t(1) << 16;
+
+// See IndicatorPanel for what counts as a usable status.
+static bool rowHasStatus(const IndicatorStore& store, std::size_t row) {
+    return !store.isPrivateData()[row] && store.column(IndicatorStore::STATUS_ID)[row] != 0;
+}
+
+std::size_t ValidityBitmap::count() const {
+    std::size_t n = 0;
+    for (uint64_t w : words_) n += static_cast<std::size_t>(__builtin_popcountll(w));
+    return n;
+}
+
+// =============================================================================
+// Task pool
+// =============================================================================
+
+namespace {
+
+struct TaskPoolArg {
+    const std::function<void(std::size_t)>* task;
+    std::atomic<std::size_t>*               next;
+    std::size_t                             count;
+};
+
+void* taskWorker(void* raw) {
+    auto* a = static_cast<TaskPoolArg*>(raw);
+    for (std::size_t i; (i = a->next->fetch_add(1)) < a->count;) (*a->task)(i);
+    return nullptr;
+}
+
+// Runs task(0 .. count-1) on up to `threads` threads, the caller included.
+void runTasks(unsigned threads, std::size_t count, const std::function<void(std::size_t)>& task) {
+    const std::size_t workers = std::min<std::size_t>(threads, count);
+    if (workers <= 1) {
+        for (std::size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+    std::atomic<std::size_t> next{0};
+    TaskPoolArg              arg{&task, &next, count};
+    std::vector<pthread_t>   tids(workers - 1);
+    std::size_t              spawned = 0;
+    while (spawned < tids.size() && pthread_create(&tids[spawned], nullptr, taskWorker, &arg) == 0)
+        ++spawned;
+    taskWorker(&arg);
+    for (std::size_t t = 0; t < spawned; ++t) pthread_join(tids[t], nullptr);
+}
+
+} // namespace
+
+// =============================================================================
+// CPU dispatch
+// =============================================================================
+
+#ifdef INDICATOR_ANALYTICS_X86
+static bool cpuHasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#else
+static bool cpuHasAVX2() { return false; }
+#endif
+
+bool IndicatorAnalytics::usesAVX2() {
+    return cpuHasAVX2();
+}
+
+// =============================================================================
+// Moment kernels
+//
+// Both passes walk the two bitmaps a word at a time; rows outside the
+// combined mask contribute nothing (the AVX2 path ANDs them to +0.0, so NaN
+// placeholders are harmless). Only whole 64-row words go through AVX2; the
+// last partial word is always scalar so no load runs past the columns.
+// =============================================================================
+
+namespace {
+
+struct Moments {
+    std::size_t n     = 0;
+    double      meanX = 0;
+    double      meanY = 0;
+    double      sxx   = 0;   // centred sums of squares and products
+    double      syy   = 0;
+    double      sxy   = 0;
+};
+
+void sumsScalar(const float* x, const float* y, const uint64_t* vx, const uint64_t* vy,
+                std::size_t w, std::size_t words, double acc[3])
+{
+    for (; w < words; ++w) {
+        for (uint64_t m = vx[w] & vy[w]; m; m &= m - 1) {
+            const std::size_t i = w * 64 + static_cast<std::size_t>(__builtin_ctzll(m));
+            acc[0] += 1;
+            acc[1] += x[i];
+            acc[2] += y[i];
+        }
+    }
+}
+
+void centredScalar(const float* x, const float* y, const uint64_t* vx, const uint64_t* vy,
+                   std::size_t w, std::size_t words, double mx, double my, double acc[3])
+{
+    for (; w < words; ++w) {
+        for (uint64_t m = vx[w] & vy[w]; m; m &= m - 1) {
+            const std::size_t i = w * 64 + static_cast<std::size_t>(__builtin_ctzll(m));
+            const double dx = x[i] - mx, dy = y[i] - my;
+            acc[0] += dx * dx;
+            acc[1] += dy * dy;
+            acc[2] += dx * dy;
+        }
+    }
+}
+
+#ifdef INDICATOR_ANALYTICS_X86
+
+// Lane mask for rows k..k+3 of a word: all ones where the row's bit is set.
+__attribute__((target("avx2")))
+inline __m256d laneMask(uint64_t m, int k, __m256i bits) {
+    const __m256i nibble = _mm256_set1_epi64x(static_cast<long long>((m >> k) & 0xF));
+    return _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(nibble, bits), bits));
+}
+
+__attribute__((target("avx2")))
+inline double horizontalSum(__m256d v) {
+    const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+__attribute__((target("avx2")))
+void sumsAVX2(const float* x, const float* y, const uint64_t* vx, const uint64_t* vy,
+              std::size_t words, double acc[3])
+{
+    const __m256i bits = _mm256_set_epi64x(8, 4, 2, 1);
+    const __m256d one  = _mm256_set1_pd(1.0);
+    __m256d n = _mm256_setzero_pd(), sx = n, sy = n;
+    for (std::size_t w = 0; w < words; ++w) {
+        const uint64_t m = vx[w] & vy[w];
+        if (!m) continue;
+        const float* px = x + w * 64;
+        const float* py = y + w * 64;
+        for (int k = 0; k < 64; k += 4) {
+            const __m256d lane = laneMask(m, k, bits);
+            n  = _mm256_add_pd(n,  _mm256_and_pd(one, lane));
+            sx = _mm256_add_pd(sx, _mm256_and_pd(_mm256_cvtps_pd(_mm_loadu_ps(px + k)), lane));
+            sy = _mm256_add_pd(sy, _mm256_and_pd(_mm256_cvtps_pd(_mm_loadu_ps(py + k)), lane));
+        }
+    }
+    acc[0] += horizontalSum(n);
+    acc[1] += horizontalSum(sx);
+    acc[2] += horizontalSum(sy);
+}
+
+__attribute__((target("avx2")))
+void centredAVX2(const float* x, const float* y, const uint64_t* vx, const uint64_t* vy,
+                 std::size_t words, double mx, double my, double acc[3])
+{
+    const __m256i bits = _mm256_set_epi64x(8, 4, 2, 1);
+    const __m256d vmx  = _mm256_set1_pd(mx);
+    const __m256d vmy  = _mm256_set1_pd(my);
+    __m256d xx = _mm256_setzero_pd(), yy = xx, xy = xx;
+    for (std::size_t w = 0; w < words; ++w) {
+        const uint64_t m = vx[w] & vy[w];
+        if (!m) continue;
+        const float* px = x + w * 64;
+        const float* py = y + w * 64;
+        for (int k = 0; k < 64; k += 4) {
+            const __m256d lane = laneMask(m, k, bits);
+            const __m256d dx = _mm256_and_pd(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(px + k)), vmx), lane);
+            const __m256d dy = _mm256_and_pd(_mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(py + k)), vmy), lane);
+            xx = _mm256_add_pd(xx, _mm256_mul_pd(dx, dx));
+            yy = _mm256_add_pd(yy, _mm256_mul_pd(dy, dy));
+            xy = _mm256_add_pd(xy, _mm256_mul_pd(dx, dy));
+        }
+    }
+    acc[0] += horizontalSum(xx);
+    acc[1] += horizontalSum(yy);
+    acc[2] += horizontalSum(xy);
+}
+
+#endif // INDICATOR_ANALYTICS_X86
+
+Moments pairMoments(const float* x, const ValidityBitmap& validX,
+                    const float* y, const ValidityBitmap& validY)
+{
+    const std::size_t rows  = std::min(validX.size(), validY.size());
+    const std::size_t words = (rows + 63) / 64;
+    const uint64_t*   vx    = validX.words();
+    const uint64_t*   vy    = validY.words();
+    // The AVX2 loops read whole words; the last, partial one stays scalar.
+    const std::size_t fast  = cpuHasAVX2() ? rows / 64 : 0;
+
+    Moments m;
+    double sums[3] = {0, 0, 0};
+#ifdef INDICATOR_ANALYTICS_X86
+    if (fast) sumsAVX2(x, y, vx, vy, fast, sums);
+#endif
+    sumsScalar(x, y, vx, vy, fast, words, sums);
+    m.n = static_cast<std::size_t>(sums[0]);
+    if (m.n == 0) return m;
+    m.meanX = sums[1] / sums[0];
+    m.meanY = sums[2] / sums[0];
+
+    double centred[3] = {0, 0, 0};
+#ifdef INDICATOR_ANALYTICS_X86
+    if (fast) centredAVX2(x, y, vx, vy, fast, m.meanX, m.meanY, centred);
+#endif
+    centredScalar(x, y, vx, vy, fast, words, m.meanX, m.meanY, centred);
+    m.sxx = centred[0];
+    m.syy = centred[1];
+    m.sxy = centred[2];
+    return m;
+}
+
+double correlation(const Moments& m) {
+    if (m.n < 2 || m.sxx <= 0 || m.syy <= 0) return NaN;
+    return m.sxy / std::sqrt(m.sxx * m.syy);
+}
+
+} // namespace
+
+// =============================================================================
+// IndicatorPanel
+// =============================================================================
+
+int IndicatorPanel::columnOf(int32_t indicatorId) const {
+    for (std::size_t c = 0; c < indicatorIds.size(); ++c)
+        if (indicatorIds[c] == indicatorId) return static_cast<int>(c);
+    return -1;
+}
+
+IndicatorPanel IndicatorPanel::build(const IndicatorStore& store, const std::vector<int32_t>& ids) {
+    PerfRegion region("analytics_panel");
+    const auto& indicatorCol = store.column(IndicatorStore::INDICATOR_ID);
+    const auto& yearCol      = store.column(IndicatorStore::SCHOOL_YEAR_ID);
+    const auto& statusCol    = store.column(IndicatorStore::STATUS);
+
+    IndicatorPanel panel;
+    panel.indicatorIds = ids;
+    if (panel.indicatorIds.empty()) {
+        panel.indicatorIds = indicatorCol;
+        std::sort(panel.indicatorIds.begin(), panel.indicatorIds.end());
+        panel.indicatorIds.erase(std::unique(panel.indicatorIds.begin(), panel.indicatorIds.end()),
+                                 panel.indicatorIds.end());
+    }
+    std::unordered_map<int32_t, int> columnIndex;
+    for (std::size_t c = 0; c < panel.indicatorIds.size(); ++c)
+        columnIndex.emplace(panel.indicatorIds[c], static_cast<int>(c));
+
+    // (school, year) key for every store row we keep, sorted so rows come
+    // out in CDS order. CDS codes fit in 47 bits, leaving 16 for the year.
+    std::vector<std::pair<uint64_t, uint32_t>> keyed;
+    keyed.reserve(store.size());
+    for (std::size_t r = 0; r < store.size(); ++r) {
+        if (store.cds()[r] == 0 || !columnIndex.count(indicatorCol[r])) continue;
+        const uint64_t key = (store.cds()[r] << 16) | (static_cast<uint32_t>(yearCol[r]) & 0xFFFF);
+        keyed.emplace_back(key, static_cast<uint32_t>(r));
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+            panel.cds.push_back(keyed[i].first >> 16);
+            panel.schoolYearId.push_back(yearCol[keyed[i].second]);
+        }
+    }
+    const std::size_t rows = panel.cds.size();
+    panel.status.assign(panel.columns(), std::vector<float>(rows, std::nanf("")));
+    panel.valid.assign(panel.columns(), ValidityBitmap(rows));
+
+    // Later store rows for the same (school, year, indicator) win.
+    std::size_t row = 0;
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        if (i > 0 && keyed[i].first != keyed[i - 1].first) ++row;
+        const std::size_t r = keyed[i].second;
+        const int         c = columnIndex[indicatorCol[r]];
+        if (rowHasStatus(store, r)) {
+            panel.status[c][row] = IndicatorStore::toFloat(statusCol[r]);
+            panel.valid[c].set(row);
+        } else {
+            panel.status[c][row] = std::nanf("");
+            panel.valid[c].reset(row);
+        }
+    }
+    return panel;
+}
+
+// =============================================================================
+// StatewideReference
+// =============================================================================
+
+void StatewideReference::add(int32_t indicatorId, int32_t schoolYearId, uint64_t cds,
+                             int32_t statusId, bool isPrivate, float status)
+{
+    if (cds != 0 || statusId == 0 || isPrivate) return;
+    status_[key(indicatorId, schoolYearId)] = status;
+}
+
+void StatewideReference::add(const SummaryCard& card) {
+    for (const auto& ind : card.getIndicatorVector()) {
+        if (!ind.secondary.is_object()) continue;
+        SummaryCard::indicator block;
+        SummaryCard::parseBlock(ind.secondary, block);
+        add(static_cast<int32_t>(ind.indicatorId), static_cast<int32_t>(block.schoolYearId),
+            indicatorfields::parseCds(block.cdsCode), block.statusId, block.isPrivateData, block.status);
+    }
+}
+
+void StatewideReference::add(const CardRecordView& record) {
+    for (std::size_t i = 0; i < record.size(); ++i) {
+        const IndicatorRecordView ind = record.indicator(i);
+        if (!ind.hasSecondary()) continue;
+        const BlockRecordView b = ind.secondary();
+        add(static_cast<int32_t>(ind.indicatorId()), b.schoolYearId(), b.cds(),
+            b.statusId(), b.isPrivateData(), b.status());
+    }
+}
+
+void StatewideReference::addStatewideRows(const IndicatorStore& store) {
+    for (std::size_t r = 0; r < store.size(); ++r)
+        add(store.column(IndicatorStore::INDICATOR_ID)[r], store.column(IndicatorStore::SCHOOL_YEAR_ID)[r],
+            store.cds()[r], store.column(IndicatorStore::STATUS_ID)[r], store.isPrivateData()[r] != 0,
+            store.status(r));
+}
+
+bool StatewideReference::find(int32_t indicatorId, int32_t schoolYearId, float& status) const {
+    auto it = status_.find(key(indicatorId, schoolYearId));
+    if (it == status_.end()) return false;
+    status = it->second;
+    return true;
+}
+
+// =============================================================================
+// IndicatorAnalytics
+// =============================================================================
+
+IndicatorAnalytics::IndicatorAnalytics(unsigned threads)
+    : threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+std::vector<double> IndicatorAnalytics::correlationMatrix(const IndicatorPanel& panel,
+                                                          std::vector<std::size_t>* pairCounts) const
+{
+    PerfRegion region("analytics_correlation");
+    const std::size_t k = panel.columns();
+    std::vector<double>      r(k * k, NaN);
+    std::vector<std::size_t> counts(k * k, 0);
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t i = 0; i < k; ++i)
+        for (std::size_t j = i; j < k; ++j) pairs.emplace_back(i, j);
+
+    runTasks(threads_, pairs.size(), [&](std::size_t p) {
+        const auto [i, j] = pairs[p];
+        const Moments m = pairMoments(panel.status[i].data(), panel.valid[i],
+                                      panel.status[j].data(), panel.valid[j]);
+        double v = correlation(m);
+        if (i == j && !std::isnan(v)) v = 1.0;   // exactly, rather than to rounding
+        r[i * k + j]      = r[j * k + i]      = v;
+        counts[i * k + j] = counts[j * k + i] = m.n;
+    });
+    if (pairCounts) *pairCounts = std::move(counts);
+    return r;
+}
+
+Regression IndicatorAnalytics::regress(const float* x, const ValidityBitmap& validX,
+                                       const float* y, const ValidityBitmap& validY)
+{
+    const Moments m = pairMoments(x, validX, y, validY);
+    Regression out;
+    out.n = m.n;
+    if (m.n < 2 || m.sxx <= 0) {
+        out.slope = out.intercept = out.r = NaN;
+        return out;
+    }
+    out.slope     = m.sxy / m.sxx;
+    out.intercept = m.meanY - out.slope * m.meanX;
+    out.r         = correlation(m);
+    return out;
+}
+
+Regression IndicatorAnalytics::regress(const IndicatorPanel& panel, int32_t xIndicatorId, int32_t yIndicatorId) {
+    const int cx = panel.columnOf(xIndicatorId);
+    const int cy = panel.columnOf(yIndicatorId);
+    if (cx < 0 || cy < 0) {
+        Regression none;
+        none.slope = none.intercept = none.r = NaN;
+        return none;
+    }
+    return regress(panel.status[cx].data(), panel.valid[cx], panel.status[cy].data(), panel.valid[cy]);
+}
+
+void IndicatorAnalytics::zScores(const IndicatorStore& store, const StatewideReference& reference,
+                                 std::vector<float>& z, ValidityBitmap& valid) const
+{
+    PerfRegion region("analytics_zscore");
+    const std::size_t rows = store.size();
+    z.assign(rows, std::nanf(""));
+    valid = ValidityBitmap(rows);
+
+    // Group every usable row by (indicator, year); groups without a
+    // statewide value are dropped here.
+    static constexpr uint32_t NO_GROUP = UINT32_MAX;
+    const auto& indicatorCol = store.column(IndicatorStore::INDICATOR_ID);
+    const auto& yearCol      = store.column(IndicatorStore::SCHOOL_YEAR_ID);
+    const auto& statusCol    = store.column(IndicatorStore::STATUS);
+    std::unordered_map<uint64_t, uint32_t> groupIndex;
+    std::vector<double>   statewide;
+    std::vector<uint32_t> groupOf(rows, NO_GROUP);
+    for (std::size_t r = 0; r < rows; ++r) {
+        if (store.cds()[r] == 0 || !rowHasStatus(store, r)) continue;
+        const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(indicatorCol[r])) << 32) |
+                             static_cast<uint32_t>(yearCol[r]);
+        auto [it, inserted] = groupIndex.try_emplace(key, NO_GROUP);
+        if (inserted) {
+            float s;
+            if (reference.find(indicatorCol[r], yearCol[r], s)) {
+                it->second = static_cast<uint32_t>(statewide.size());
+                statewide.push_back(s);
+            }
+        }
+        groupOf[r] = it->second;
+    }
+    const std::size_t groups = statewide.size();
+    if (groups == 0) return;
+
+    // Per-chunk partial sums, merged afterwards, so threads share nothing.
+    const std::size_t chunks = (rows + Z_CHUNK_ROWS - 1) / Z_CHUNK_ROWS;
+    auto chunkRange = [rows](std::size_t c) {
+        return std::make_pair(c * Z_CHUNK_ROWS, std::min(rows, (c + 1) * Z_CHUNK_ROWS));
+    };
+    std::vector<std::vector<double>> partN(chunks), partSum(chunks);
+    runTasks(threads_, chunks, [&](std::size_t c) {
+        partN[c].assign(groups, 0);
+        partSum[c].assign(groups, 0);
+        for (auto [r, end] = chunkRange(c); r < end; ++r) {
+            if (groupOf[r] == NO_GROUP) continue;
+            partN[c][groupOf[r]]   += 1;
+            partSum[c][groupOf[r]] += IndicatorStore::toFloat(statusCol[r]);
+        }
+    });
+    std::vector<double> n(groups, 0), mean(groups, 0);
+    for (std::size_t c = 0; c < chunks; ++c)
+        for (std::size_t g = 0; g < groups; ++g) {
+            n[g]    += partN[c][g];
+            mean[g] += partSum[c][g];
+        }
+    for (std::size_t g = 0; g < groups; ++g) mean[g] = n[g] > 0 ? mean[g] / n[g] : 0;
+
+    runTasks(threads_, chunks, [&](std::size_t c) {
+        partSum[c].assign(groups, 0);
+        for (auto [r, end] = chunkRange(c); r < end; ++r) {
+            if (groupOf[r] == NO_GROUP) continue;
+            const double d = IndicatorStore::toFloat(statusCol[r]) - mean[groupOf[r]];
+            partSum[c][groupOf[r]] += d * d;
+        }
+    });
+    std::vector<double> sd(groups, 0);
+    for (std::size_t g = 0; g < groups; ++g) {
+        double ss = 0;
+        for (std::size_t c = 0; c < chunks; ++c) ss += partSum[c][g];
+        sd[g] = n[g] > 1 ? std::sqrt(ss / (n[g] - 1)) : 0;
+    }
+
+    runTasks(threads_, chunks, [&](std::size_t c) {
+        for (auto [r, end] = chunkRange(c); r < end; ++r) {
+            const uint32_t g = groupOf[r];
+            if (g == NO_GROUP || sd[g] <= 0) continue;
+            z[r] = static_cast<float>((IndicatorStore::toFloat(statusCol[r]) - statewide[g]) / sd[g]);
+            valid.set(r);
+        }
+    });
+}
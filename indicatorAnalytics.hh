@@ -0,0 +1,150 @@
+#ifndef INDICATORANALYTICS_H
+#define INDICATORANALYTICS_H
+
+#include "cardRecord.hh"
+#include "indicatorStore.hh"
+#include "summaryCard.hh"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// =============================================================================
+// ValidityBitmap — one bit per row, set where the row holds a usable value.
+//
+// Kernels read it a 64-bit word at a time, so a block of 64 rows with no
+// valid values costs one test and a fully valid block runs unmasked.
+// =============================================================================
+
+class ValidityBitmap {
+public:
+    ValidityBitmap() = default;
+    explicit ValidityBitmap(std::size_t bits) { resize(bits); }
+
+    // New bits start cleared.
+    void resize(std::size_t bits) {
+        words_.resize((bits + 63) / 64, 0);
+        size_ = bits;
+    }
+    void set(std::size_t i)        { words_[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(std::size_t i)      { words_[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    bool test(std::size_t i) const { return (words_[i >> 6] >> (i & 63)) & 1; }
+
+    std::size_t size() const { return size_; }
+    std::size_t count() const;
+    const uint64_t* words() const { return words_.data(); }
+
+private:
+    std::vector<uint64_t> words_;
+    std::size_t           size_ = 0;
+};
+
+// =============================================================================
+// IndicatorPanel — indicator status pivoted to one float column per
+// indicator and one row per (school, year).
+//
+// Built from the store's fixed-point STATUS column. A row is valid for an
+// indicator when the school has that indicator for the year, the value is
+// not private and the API gave it a status level (statusId != 0; missing
+// statuses arrive as 0 and would otherwise count as real zeros). Statewide
+// rows (CDS 0) are left out.
+// =============================================================================
+
+struct IndicatorPanel {
+    std::vector<uint64_t>           cds;            // per row, ascending
+    std::vector<int32_t>            schoolYearId;   // per row
+    std::vector<int32_t>            indicatorIds;   // per column
+    std::vector<std::vector<float>> status;         // [column][row]
+    std::vector<ValidityBitmap>     valid;          // [column]
+
+    std::size_t rows() const    { return cds.size(); }
+    std::size_t columns() const { return indicatorIds.size(); }
+    // Column for an indicatorId, or -1.
+    int columnOf(int32_t indicatorId) const;
+
+    // Empty `indicatorIds` takes every indicator present in the store.
+    static IndicatorPanel build(const IndicatorStore& store,
+                                const std::vector<int32_t>& indicatorIds = {});
+};
+
+// =============================================================================
+// StatewideReference — the statewide value for each (indicator, year).
+//
+// Every school card carries the statewide figures in its "secondary"
+// blocks (CDS 00000000000000), so adding the cards a store was built from
+// is enough. Statewide cards fetched on their own land in the store as
+// CDS 0 rows and can be added from there.
+// =============================================================================
+
+class StatewideReference {
+public:
+    void add(const SummaryCard& card);
+    void add(const CardRecordView& record);
+    void addStatewideRows(const IndicatorStore& store);
+
+    // False when no statewide value is known.
+    bool find(int32_t indicatorId, int32_t schoolYearId, float& status) const;
+    std::size_t size() const { return status_.size(); }
+
+private:
+    void add(int32_t indicatorId, int32_t schoolYearId, uint64_t cds,
+             int32_t statusId, bool isPrivate, float status);
+
+    static uint64_t key(int32_t indicatorId, int32_t schoolYearId) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(indicatorId)) << 32) |
+               static_cast<uint32_t>(schoolYearId);
+    }
+
+    std::unordered_map<uint64_t, float> status_;
+};
+
+// =============================================================================
+// IndicatorAnalytics — correlation, regression and z-score kernels.
+//
+// Moments are taken in two passes (means, then centred sums) in double
+// precision over float columns, masked by the validity bitmaps of both
+// inputs. On x86-64 CPUs with AVX2 the inner loops run four rows per
+// instruction; other CPUs take a scalar path. Independent work (column
+// pairs, row chunks) is spread over a pool of pthreads.
+// =============================================================================
+
+struct Regression {
+    double      slope     = 0;
+    double      intercept = 0;
+    double      r         = 0;   // Pearson correlation
+    std::size_t n         = 0;   // rows valid in both inputs
+};
+
+class IndicatorAnalytics {
+public:
+    // threads = 0 uses one per hardware core.
+    explicit IndicatorAnalytics(unsigned threads = 0);
+
+    // Pearson r for every pair of panel columns, row-major columns x columns.
+    // NaN where two columns share fewer than two valid rows or one of them
+    // is constant. `pairCounts`, when given, receives the shared row counts.
+    std::vector<double> correlationMatrix(const IndicatorPanel& panel,
+                                          std::vector<std::size_t>* pairCounts = nullptr) const;
+
+    // Ordinary least squares of y on x over rows valid in both. Slope,
+    // intercept and r are NaN when fewer than two rows qualify or x is
+    // constant.
+    static Regression regress(const float* x, const ValidityBitmap& validX,
+                              const float* y, const ValidityBitmap& validY);
+    static Regression regress(const IndicatorPanel& panel, int32_t xIndicatorId, int32_t yIndicatorId);
+
+    // One z-score per store row: (status - statewide) / sd, where sd is the
+    // standard deviation of school statuses for that indicator and year.
+    // Rows that are invalid (see IndicatorPanel), statewide, lack a
+    // reference value or sit in a group with no spread are left invalid.
+    void zScores(const IndicatorStore& store, const StatewideReference& reference,
+                 std::vector<float>& z, ValidityBitmap& valid) const;
+
+    // True when the AVX2 kernels are in use on this CPU.
+    static bool usesAVX2();
+
+private:
+    unsigned threads_;
+};
+
+#endif // INDICATORANALYTICS_H
@@ -0,0 +1,141 @@
+#ifndef INDICATORFIELDS_H
+#define INDICATORFIELDS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// =============================================================================
+// Indicator field table.
+//
+// The fields of one primary/secondary block, listed once. Everything that
+// walks them — the SummaryCard::indicator struct, the JSON parser, the
+// CardRecord writer and reader, and the IndicatorStore column
+// appenders — expands this list, so each path is straight-line code with the
+// conversion for every field chosen at compile time. Adding a field means one
+// new row here (and a record offset / store column if it is to be kept).
+//
+//   X(type, member, jsonKey, recordType, recordOffset, storeSlot)
+//
+//   type          C++ type of the SummaryCard::indicator member
+//   jsonKey       key inside the API's "primary"/"secondary" object
+//   recordType    normalised wire type: fixed-point int32 for floats, the
+//                 numeric CDS for cdsCode (see cardRecord.hh)
+//   recordOffset  byte offset inside a CardRecord block, or -1 if the field
+//                 is not stored in the block
+//   storeSlot     IndicatorStore column the value lands in, or NO_SLOT
+// =============================================================================
+
+#define INDICATOR_BLOCK_FIELDS(X)                                                                  \
+    X(std::string,  cdsCode,        "cdsCode",        uint64_t,               8,   CDS_SLOT)       \
+    X(float,        status,         "status",         int32_t,                16,  STATUS)         \
+    X(float,        change,         "change",         int32_t,                20,  CHANGE)         \
+    X(int,          changeId,       "changeId",       int32_t,                24,  CHANGE_ID)      \
+    X(int,          statusId,       "statusId",       int32_t,                28,  STATUS_ID)      \
+    X(int,          performance,    "performance",    int32_t,                32,  PERFORMANCE)    \
+    X(size_t,       totalGroups,    "totalGroups",    uint32_t,               36,  TOTAL_GROUPS)   \
+    X(int,          red,            "red",            int32_t,                40,  RED)            \
+    X(int,          orange,         "orange",         int32_t,                44,  ORANGE)         \
+    X(int,          yellow,         "yellow",         int32_t,                48,  YELLOW)         \
+    X(int,          green,          "green",          int32_t,                52,  GREEN)          \
+    X(int,          blue,           "blue",           int32_t,                56,  BLUE)           \
+    X(long,         count,          "count",          int64_t,                0,   COUNT_SLOT)     \
+    X(std::string,  studentGroup,   "studentGroup",   indicatorfields::none,  -1,  NO_SLOT)        \
+    X(size_t,       schoolYearId,   "schoolYearId",   uint16_t,               60,  SCHOOL_YEAR_ID) \
+    X(bool,         isPrivateData,  "isPrivateData",  uint8_t,                62,  PRIVATE_SLOT)
+
+namespace indicatorfields {
+
+// Record type of fields that are not part of the fixed block layout.
+struct none {};
+
+constexpr int32_t FIXED_SCALE = 1000;
+
+inline uint64_t parseCds(std::string_view s) {
+    if (s.empty() || s.size() > 19) return 0;
+    uint64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return 0;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return v;
+}
+
+// Reads obj[key] into `out` with the same leniency the API needs: missing,
+// null or wrongly-typed values leave `out` untouched. One lookup per field.
+template <typename T>
+inline void readJson(const nlohmann::json& obj, const char* key, T& out) {
+    auto it = obj.find(key);
+    if (it == obj.end() || it->is_null()) return;
+    if constexpr (std::is_same_v<T, std::string>) {
+        out = it->is_string() ? it->template get<std::string>() : it->dump();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        if (it->is_boolean()) out = it->template get<bool>();
+    } else if constexpr (std::is_unsigned_v<T>) {
+        if (it->is_number_unsigned())  out = it->template get<T>();
+        else if (it->is_number())      out = static_cast<T>(it->template get<long>());
+    } else {
+        if (it->is_number()) out = it->template get<T>();
+    }
+}
+
+// Member value -> normalised record/store value.
+template <typename R, typename T>
+inline R toRecord(const T& v) {
+    if constexpr (std::is_same_v<R, none>)
+        return none{};
+    else if constexpr (std::is_floating_point_v<T>)
+        return static_cast<R>(std::lround(static_cast<double>(v) * FIXED_SCALE));
+    else if constexpr (std::is_same_v<T, std::string>)
+        return static_cast<R>(parseCds(v));
+    else
+        return static_cast<R>(v);
+}
+
+// Normalised value -> JSON, reversing toRecord() for the member type T.
+template <typename T, typename R>
+inline nlohmann::json recordToJson(R v) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<double>(v) / FIXED_SCALE;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%014llu", static_cast<unsigned long long>(v));
+        return std::string(buf);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return v != 0;
+    } else {
+        return v;
+    }
+}
+
+template <typename R, int Offset>
+inline void storeAt(std::string& out, std::size_t at, R v) {
+    if constexpr (Offset >= 0) std::memcpy(&out[at + Offset], &v, sizeof(R));
+}
+
+template <typename R, int Offset>
+inline R loadAt(const uint8_t* p) {
+    if constexpr (Offset >= 0) {
+        R v;
+        std::memcpy(&v, p + Offset, sizeof(R));
+        return v;
+    } else {
+        return R{};
+    }
+}
+
+// Sets out[key] from the block at `p`, if the field is stored in the block.
+template <typename T, typename R, int Offset>
+inline void loadJson(nlohmann::json& out, const char* key, const uint8_t* p) {
+    if constexpr (Offset >= 0) out[key] = recordToJson<T>(loadAt<R, Offset>(p));
+}
+
+} // namespace indicatorfields
+
+#endif // INDICATORFIELDS_H
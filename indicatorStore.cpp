@@ -0,0 +1,277 @@
+#include "indicatorStore.hh"
+#include "perfRegions.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+// File magic and format version for saveEncoded/loadEncoded.
+static constexpr char     STORE_MAGIC[4] = {'C', 'D', 'I', 'X'};
+static constexpr uint32_t STORE_VERSION  = 1;
+
+// =============================================================================
+// Conversions
+// =============================================================================
+
+int32_t IndicatorStore::toFixed(float v) {
+    return static_cast<int32_t>(std::lround(static_cast<double>(v) * FIXED_POINT_SCALE));
+}
+
+uint64_t IndicatorStore::parseCds(const std::string& cds) {
+    return indicatorfields::parseCds(cds);
+}
+
+std::string IndicatorStore::formatCds(uint64_t cds) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%014llu", static_cast<unsigned long long>(cds));
+    return buf;
+}
+
+// =============================================================================
+// Append / Clear
+// =============================================================================
+
+uint32_t IndicatorStore::intern(const std::string& value,
+                                std::vector<std::string>& dict,
+                                std::unordered_map<std::string, uint32_t>& index)
+{
+    auto [it, inserted] = index.try_emplace(value, static_cast<uint32_t>(dict.size()));
+    if (inserted) dict.push_back(value);
+    return it->second;
+}
+
+void IndicatorStore::append(const SummaryCard& card) {
+    for (const auto& ind : card.getIndicatorVector()) {
+#define X(type, member, key, rtype, roff, slot) \
+        push<slot>(indicatorfields::toRecord<rtype>(ind.member));
+        INDICATOR_BLOCK_FIELDS(X)
+#undef X
+        ints_[INDICATOR_ID].push_back(static_cast<int32_t>(ind.indicatorId));
+        categoryCodes_.push_back(intern(ind.indicatorCategory, categoryDict_, categoryIndex_));
+        groupCodes_.push_back(intern(ind.studentGroup, groupDict_, groupIndex_));
+    }
+}
+
+void IndicatorStore::append(const std::vector<SummaryCard>& cards) {
+    for (const auto& card : cards) append(card);
+}
+
+void IndicatorStore::append(const CardRecordView& record) {
+    for (std::size_t i = 0; i < record.size(); ++i) {
+        const IndicatorRecordView ind   = record.indicator(i);
+        const uint8_t*            block = ind.primary().data();
+
+#define X(type, member, key, rtype, roff, slot) \
+        push<slot>(indicatorfields::loadAt<rtype, roff>(block));
+        INDICATOR_BLOCK_FIELDS(X)
+#undef X
+        ints_[INDICATOR_ID].push_back(static_cast<int32_t>(ind.indicatorId()));
+        categoryCodes_.push_back(intern(SummaryCard::categoryName(ind.indicatorId()),
+                                        categoryDict_, categoryIndex_));
+        groupCodes_.push_back(intern(std::string(ind.studentGroup()), groupDict_, groupIndex_));
+    }
+}
+
+void IndicatorStore::appendRows(const IndicatorStore& other,
+                                const std::vector<std::size_t>& rows)
+{
+    // Map the other store's dictionary codes onto ours once, not per row.
+    std::vector<uint32_t> categoryMap(other.categoryDict_.size());
+    for (uint32_t i = 0; i < categoryMap.size(); ++i)
+        categoryMap[i] = intern(other.categoryDict_[i], categoryDict_, categoryIndex_);
+    std::vector<uint32_t> groupMap(other.groupDict_.size());
+    for (uint32_t i = 0; i < groupMap.size(); ++i)
+        groupMap[i] = intern(other.groupDict_[i], groupDict_, groupIndex_);
+
+    for (std::size_t row : rows) {
+        cds_.push_back(other.cds_[row]);
+        for (int c = 0; c < INT_COLUMN_COUNT; ++c)
+            ints_[c].push_back(other.ints_[c][row]);
+        count_.push_back(other.count_[row]);
+        isPrivate_.push_back(other.isPrivate_[row]);
+        categoryCodes_.push_back(categoryMap[other.categoryCodes_[row]]);
+        groupCodes_.push_back(groupMap[other.groupCodes_[row]]);
+    }
+}
+
+void IndicatorStore::assignRow(std::size_t row, const IndicatorStore& other, std::size_t otherRow) {
+    cds_[row] = other.cds_[otherRow];
+    for (int c = 0; c < INT_COLUMN_COUNT; ++c)
+        ints_[c][row] = other.ints_[c][otherRow];
+    count_[row]     = other.count_[otherRow];
+    isPrivate_[row] = other.isPrivate_[otherRow];
+    categoryCodes_[row] = intern(other.category(otherRow), categoryDict_, categoryIndex_);
+    groupCodes_[row]    = intern(other.studentGroup(otherRow), groupDict_, groupIndex_);
+}
+
+void IndicatorStore::clear() {
+    cds_.clear();
+    for (auto& col : ints_) col.clear();
+    count_.clear();
+    isPrivate_.clear();
+    categoryCodes_.clear();
+    groupCodes_.clear();
+    categoryDict_.clear();
+    groupDict_.clear();
+    categoryIndex_.clear();
+    groupIndex_.clear();
+}
+
+std::size_t IndicatorStore::memoryBytes() const {
+    std::size_t bytes = cds_.size() * sizeof(uint64_t)
+                      + count_.size() * sizeof(int64_t)
+                      + isPrivate_.size()
+                      + (categoryCodes_.size() + groupCodes_.size()) * sizeof(uint32_t);
+    for (const auto& col : ints_) bytes += col.size() * sizeof(int32_t);
+    return bytes;
+}
+
+// =============================================================================
+// Save / Load
+// =============================================================================
+
+bool IndicatorStore::saveEncoded(const std::string& filename) const {
+    PerfRegion region("export_encoded");
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        return false;
+    }
+    EncodedIndicatorBlock block;
+    block.encode(*this);
+
+    file.write(STORE_MAGIC, sizeof(STORE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&STORE_VERSION), sizeof(STORE_VERSION));
+    if (!block.write(file)) {
+        std::cerr << "Error: Failed to write to file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool IndicatorStore::loadEncoded(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        return false;
+    }
+    char     magic[4];
+    uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!file || !std::equal(magic, magic + 4, STORE_MAGIC) || version != STORE_VERSION) {
+        std::cerr << "Error: Not an indicator store file: " << filename << std::endl;
+        return false;
+    }
+    EncodedIndicatorBlock block;
+    if (!block.read(file)) {
+        std::cerr << "Error: Corrupt indicator store file: " << filename << std::endl;
+        return false;
+    }
+    block.decodeInto(*this);
+    return true;
+}
+
+// =============================================================================
+// EncodedIndicatorBlock
+// =============================================================================
+
+template <typename T>
+static std::vector<T> gather(const std::vector<T>& src, const std::vector<std::size_t>& order) {
+    std::vector<T> out(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) out[i] = src[order[i]];
+    return out;
+}
+
+void EncodedIndicatorBlock::encode(const IndicatorStore& store) {
+    rows_ = store.size();
+
+    std::vector<std::size_t> order(rows_);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return store.cds_[a] < store.cds_[b]; });
+
+    auto sortedCds = gather(store.cds_, order);
+    cds_.encode(sortedCds.data(), rows_);
+
+    for (int c = 0; c < IndicatorStore::INT_COLUMN_COUNT; ++c) {
+        auto col = gather(store.ints_[c], order);
+        ints_[c].encode(col.data(), rows_);
+    }
+
+    auto counts = gather(store.count_, order);
+    count_.encode(counts.data(), rows_);
+
+    std::vector<uint32_t> flags(rows_);
+    for (std::size_t i = 0; i < rows_; ++i) flags[i] = store.isPrivate_[order[i]];
+    isPrivate_.encode(flags.data(), rows_, 1);
+
+    auto categories = gather(store.categoryCodes_, order);
+    category_.encode(categories.data(), rows_, store.categoryDict_);
+    auto groups = gather(store.groupCodes_, order);
+    studentGroup_.encode(groups.data(), rows_, store.groupDict_);
+}
+
+void EncodedIndicatorBlock::decodeInto(IndicatorStore& store) const {
+    store.clear();
+
+    store.cds_.resize(rows_);
+    cds_.decode(store.cds_.data());
+
+    for (int c = 0; c < IndicatorStore::INT_COLUMN_COUNT; ++c) {
+        store.ints_[c].resize(rows_);
+        ints_[c].decode(store.ints_[c].data());
+    }
+
+    store.count_.resize(rows_);
+    count_.decode(store.count_.data());
+
+    std::vector<uint32_t> flags(rows_);
+    isPrivate_.decode(flags.data());
+    store.isPrivate_.assign(flags.begin(), flags.end());
+
+    store.categoryCodes_.resize(rows_);
+    category_.decodeCodes(store.categoryCodes_.data());
+    store.groupCodes_.resize(rows_);
+    studentGroup_.decodeCodes(store.groupCodes_.data());
+
+    store.categoryDict_ = category_.dictionary();
+    store.groupDict_    = studentGroup_.dictionary();
+    for (uint32_t i = 0; i < store.categoryDict_.size(); ++i)
+        store.categoryIndex_[store.categoryDict_[i]] = i;
+    for (uint32_t i = 0; i < store.groupDict_.size(); ++i)
+        store.groupIndex_[store.groupDict_[i]] = i;
+}
+
+std::size_t EncodedIndicatorBlock::byteSize() const {
+    std::size_t bytes = cds_.byteSize() + count_.byteSize() + isPrivate_.byteSize()
+                      + category_.byteSize() + studentGroup_.byteSize();
+    for (const auto& col : ints_) bytes += col.byteSize();
+    return bytes;
+}
+
+bool EncodedIndicatorBlock::write(std::ostream& out) const {
+    uint64_t rows = rows_;
+    out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    if (!cds_.write(out)) return false;
+    for (const auto& col : ints_)
+        if (!col.write(out)) return false;
+    return count_.write(out) && isPrivate_.write(out) &&
+           category_.write(out) && studentGroup_.write(out);
+}
+
+bool EncodedIndicatorBlock::read(std::istream& in) {
+    uint64_t rows = 0;
+    if (!in.read(reinterpret_cast<char*>(&rows), sizeof(rows))) return false;
+    if (!cds_.read(in) || cds_.size() != rows) return false;
+    for (auto& col : ints_)
+        if (!col.read(in) || col.size() != rows) return false;
+    if (!count_.read(in)     || count_.size()     != rows) return false;
+    if (!isPrivate_.read(in) || isPrivate_.size() != rows) return false;
+    if (!category_.read(in)     || category_.size()     != rows) return false;
+    if (!studentGroup_.read(in) || studentGroup_.size() != rows) return false;
+    rows_ = static_cast<std::size_t>(rows);
+    return true;
+}
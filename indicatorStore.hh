@@ -0,0 +1,158 @@
+#ifndef INDICATORSTORE_H
+#define INDICATORSTORE_H
+
+#include "cardRecord.hh"
+#include "columnEncoding.hh"
+#include "summaryCard.hh"
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// =============================================================================
+// IndicatorStore — columnar indicator history.
+//
+// One row per (card, indicator). Fetched SummaryCards are flattened into
+// contiguous typed columns so multi-year, statewide scans touch only the
+// columns they need. Fractional fields (status, change) are stored as
+// fixed-point integers in thousandths, matching the API's three decimals.
+// =============================================================================
+
+class IndicatorStore {
+public:
+    static constexpr int32_t FIXED_POINT_SCALE = 1000;
+
+    // Small integer columns, all stored as int32_t.
+    enum IntColumn {
+        SCHOOL_YEAR_ID,
+        INDICATOR_ID,
+        STATUS,          // fixed-point, thousandths
+        CHANGE,          // fixed-point, thousandths
+        CHANGE_ID,
+        STATUS_ID,
+        PERFORMANCE,
+        TOTAL_GROUPS,
+        RED,
+        ORANGE,
+        YELLOW,
+        GREEN,
+        BLUE,
+        INT_COLUMN_COUNT
+    };
+
+    // Appends every indicator of the card as one row.
+    void append(const SummaryCard& card);
+    void append(const std::vector<SummaryCard>& cards);
+    // Appends straight from a binary record without touching JSON.
+    void append(const CardRecordView& record);
+    // Copies the listed rows of another store, re-interning its dictionaries.
+    void appendRows(const IndicatorStore& other, const std::vector<std::size_t>& rows);
+    // Overwrites one of our rows with a row of another store.
+    void assignRow(std::size_t row, const IndicatorStore& other, std::size_t otherRow);
+    void clear();
+
+    std::size_t size() const { return cds_.size(); }
+
+    // Column access
+    const std::vector<uint64_t>& cds() const                  { return cds_; }
+    const std::vector<int32_t>&  column(IntColumn c) const    { return ints_[c]; }
+    const std::vector<int64_t>&  count() const                { return count_; }
+    const std::vector<uint8_t>&  isPrivateData() const        { return isPrivate_; }
+    const std::vector<uint32_t>& categoryCodes() const        { return categoryCodes_; }
+    const std::vector<uint32_t>& studentGroupCodes() const    { return groupCodes_; }
+    const std::vector<std::string>& categoryDictionary() const     { return categoryDict_; }
+    const std::vector<std::string>& studentGroupDictionary() const { return groupDict_; }
+
+    // Row helpers
+    float status(std::size_t row) const { return toFloat(ints_[STATUS][row]); }
+    float change(std::size_t row) const { return toFloat(ints_[CHANGE][row]); }
+    const std::string& category(std::size_t row) const     { return categoryDict_[categoryCodes_[row]]; }
+    const std::string& studentGroup(std::size_t row) const { return groupDict_[groupCodes_[row]]; }
+
+    // Bytes held by the uncompressed columns (excluding dictionaries).
+    std::size_t memoryBytes() const;
+
+    // Compressed persistence — see EncodedIndicatorBlock.
+    bool saveEncoded(const std::string& filename) const;
+    bool loadEncoded(const std::string& filename);
+
+    static int32_t toFixed(float v);
+    static float   toFloat(int32_t fixed) { return static_cast<float>(fixed) / FIXED_POINT_SCALE; }
+    // Parses a 14-digit CDS code; returns 0 for anything non-numeric.
+    static uint64_t parseCds(const std::string& cds);
+    static std::string formatCds(uint64_t cds);
+
+private:
+    friend class EncodedIndicatorBlock;
+
+    // Destinations named by the storeSlot column of INDICATOR_BLOCK_FIELDS:
+    // an IntColumn, or one of the typed columns below.
+    enum FieldSlot {
+        CDS_SLOT = INT_COLUMN_COUNT,
+        COUNT_SLOT,
+        PRIVATE_SLOT,
+        NO_SLOT = -1
+    };
+
+    // Appends one normalised field value (see indicatorfields::toRecord).
+    template <int Slot, typename R>
+    void push(R v) {
+        if constexpr (Slot >= 0 && Slot < INT_COLUMN_COUNT) ints_[Slot].push_back(static_cast<int32_t>(v));
+        else if constexpr (Slot == CDS_SLOT)     cds_.push_back(v);
+        else if constexpr (Slot == COUNT_SLOT)   count_.push_back(v);
+        else if constexpr (Slot == PRIVATE_SLOT) isPrivate_.push_back(v ? 1 : 0);
+    }
+
+    uint32_t intern(const std::string& value,
+                    std::vector<std::string>& dict,
+                    std::unordered_map<std::string, uint32_t>& index);
+
+    std::vector<uint64_t>                            cds_;
+    std::array<std::vector<int32_t>, INT_COLUMN_COUNT> ints_;
+    std::vector<int64_t>                             count_;
+    std::vector<uint8_t>                             isPrivate_;
+    std::vector<uint32_t>                            categoryCodes_;
+    std::vector<uint32_t>                            groupCodes_;
+
+    std::vector<std::string>                  categoryDict_;
+    std::vector<std::string>                  groupDict_;
+    std::unordered_map<std::string, uint32_t> categoryIndex_;
+    std::unordered_map<std::string, uint32_t> groupIndex_;
+};
+
+// =============================================================================
+// EncodedIndicatorBlock — compressed, CDS-sorted image of an IndicatorStore.
+//
+//   cds                      sorted delta (PFOR exceptions at boundaries)
+//   category, studentGroup   dictionary
+//   colours, levels, ids     bit-packed via frame-of-reference
+//   status, change           frame-of-reference over fixed-point values
+//   isPrivateData            1-bit packed
+// =============================================================================
+
+class EncodedIndicatorBlock {
+public:
+    // Encodes the store's rows in ascending CDS order (stable).
+    void encode(const IndicatorStore& store);
+    // Replaces the contents of `store` with the decoded rows.
+    void decodeInto(IndicatorStore& store) const;
+
+    std::size_t rows()     const { return rows_; }
+    std::size_t byteSize() const;
+
+    bool write(std::ostream& out) const;
+    bool read(std::istream& in);
+
+private:
+    std::size_t                                                  rows_ = 0;
+    DeltaColumn                                                  cds_;
+    std::array<FrameOfReferenceColumn, IndicatorStore::INT_COLUMN_COUNT> ints_;
+    FrameOfReferenceColumn                                       count_;
+    BitPackedColumn                                              isPrivate_;
+    DictionaryColumn                                             category_;
+    DictionaryColumn                                             studentGroup_;
+};
+
+#endif // INDICATORSTORE_H
@@ -1,5 +1,15 @@
 #include "summaryCard.hh"
 #include "CaliforniaDashboardAPI.hh"
+#include "cachingProxy.hh"
+#include "perfRegions.hh"
+#include "publicationWatcher.hh"
+#include "batchRunner.hh"
+#include "cardRecord.hh"
+#include "queryEngine.hh"
+#include "refreshScheduler.hh"
+#include "samplingPlanner.hh"
+#include "indicatorAnalytics.hh"
+#include "sqliteExporter.hh"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -9,6 +19,9 @@
 #include <unordered_map>
 #include <algorithm>
 #include <stdexcept>
+#include <cstdlib>
+#include <chrono>
+#include <ctime>
 #include <thread>
 #include <pthread.h>
 
@@ -81,6 +94,7 @@ static std::unordered_map<std::string, std::string> buildCDSLookup(
     const std::string& csvPath,
     std::unordered_map<std::string, std::string>& originalNames)
 {
+    PerfRegion region("csv_parse");
     std::unordered_map<std::string, std::string> lookup;
 
     std::ifstream file(csvPath);
@@ -168,9 +182,12 @@ static std::string findBestMatch(
     std::string query = toLower(schoolName);
 
     // -- Tier 1: Exact match (case-insensitive) --
-    auto it = cdsLookup.find(query);
-    if (it != cdsLookup.end()) {
-        return it->second;
+    {
+        PerfRegion region("match_exact");
+        auto it = cdsLookup.find(query);
+        if (it != cdsLookup.end()) {
+            return it->second;
+        }
     }
 
     // -- Tier 2: Substring match --
@@ -181,12 +198,15 @@ static std::string findBestMatch(
     std::string substrMatchKey;
     size_t substrMatchLen = 0; // tracking longest, not shortest
 
-    for (const auto& [key, cds] : cdsLookup) {
-        bool overlap = (key.find(query) != std::string::npos ||
-                        query.find(key) != std::string::npos);
-        if (overlap && key.size() >= MIN_SUBSTR_LEN && key.size() > substrMatchLen) {
-            substrMatchLen = key.size();
-            substrMatchKey = key;
+    {
+        PerfRegion region("match_substring");
+        for (const auto& [key, cds] : cdsLookup) {
+            bool overlap = (key.find(query) != std::string::npos ||
+                            query.find(key) != std::string::npos);
+            if (overlap && key.size() >= MIN_SUBSTR_LEN && key.size() > substrMatchLen) {
+                substrMatchLen = key.size();
+                substrMatchKey = key;
+            }
         }
     }
 
@@ -195,6 +215,7 @@ static std::string findBestMatch(
     }
 
     // -- Tier 3: Levenshtein fuzzy match --
+    PerfRegion region("match_fuzzy");
     std::string bestKey;
     size_t bestDist = std::string::npos;
 
@@ -279,6 +300,7 @@ struct EnrichArg {
 };
 
 static void* enrichWorker(void* raw) {
+    PerfRegion region("enrich");
     auto* a = static_cast<EnrichArg*>(raw);
     for (size_t i = a->start; i < a->end; ++i) {
         SummaryCard& card = (*a->cards)[i];
@@ -381,6 +403,7 @@ std::map<std::string, std::vector<std::string>> buildAllSchoolsMap(
     const std::vector<std::string>& years,
     const std::string& csvPath = "../pubschls.csv")
 {
+    PerfRegion region("csv_parse");
     std::map<std::string, std::vector<std::string>> schools;
 
     std::ifstream file(csvPath);
@@ -445,14 +468,37 @@ std::map<std::string, std::vector<std::string>> buildAllSchoolsMap(
 }
 
 // =============================================================================
-// main
+// fetchYears
 // =============================================================================
 
-int main()
+// Applies the transport settings taken from the environment.
+static bool configureTransport(CaliforniaDashboardAPI& api)
+{
+    // CADASHBOARD_HTTP3=1 prefers QUIC where libcurl supports it.
+    if (const char* h3 = std::getenv("CADASHBOARD_HTTP3"))
+        api.setHttp3(*h3 && std::string(h3) != "0");
+
+    // CADASHBOARD_SOURCE_ADDRS=10.0.0.2,10.0.0.3 spreads the pool across
+    // several local egress addresses, each with its own rate bucket.
+    if (const char* addrs = std::getenv("CADASHBOARD_SOURCE_ADDRS")) {
+        std::vector<std::string> sources;
+        std::stringstream ss(addrs);
+        std::string addr;
+        while (std::getline(ss, addr, ','))
+            if (!addr.empty()) sources.push_back(addr);
+        if (!api.setSourceAddresses(sources)) return false;
+        std::cout << "[INFO] Spreading requests across " << sources.size()
+                  << " source address(es)" << std::endl;
+    }
+    return true;
+}
+
+// Fetches every active school for the given years and prints the cards.
+static int fetchYears(const std::vector<std::string>& years)
 {
     CaliforniaDashboardAPI api;
     std::vector<std::string> urls;
-    std::vector<std::string> years = {"2021", "2022", "2023", "2024"};
+    if (!configureTransport(api)) return 1;
 
     // Build a schools map containing every active CA public school.
     // Swap this for a hand-crafted map to target specific schools instead.
@@ -481,6 +527,23 @@ int main()
 
     std::cout << "\nData fetched successfully!" << std::endl;
 
+    // CADASHBOARD_SQLITE=cards.db bulk-loads the cards (and the school
+    // directory, when ../pubschls.csv is readable) into a SQLite file.
+    if (const char* dbPath = std::getenv("CADASHBOARD_SQLITE")) {
+        const auto start = std::chrono::steady_clock::now();
+        SqliteExporter exporter;
+        SchoolDirectory directory;
+        bool ok = exporter.open(dbPath);
+        if (ok && directory.load("../pubschls.csv")) ok = exporter.addDirectory(directory);
+        ok = ok && exporter.addCards(api.allSummaryCardsVector);
+        ok = exporter.close(ok) && ok;   // rolls back the open batch on failure
+        if (!ok) return 1;
+        std::cout << "[INFO] Wrote " << exporter.cardsWritten() << " cards ("
+                  << exporter.indicatorsWritten() << " indicators) to " << dbPath << " in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                  << "s" << std::endl;
+    }
+
     for (const auto& card : api.allSummaryCardsVector) {
         std::cout << "\n=== Card ===" << std::endl;
         card.printIndicatorVector();
@@ -488,3 +551,423 @@ int main()
 
     return 0;
 }
+
+// =============================================================================
+// watchForPublication
+// =============================================================================
+
+/**
+ * Daemon mode: probes a stratified sample of active schools for `year` with
+ * conditional requests every `intervalSeconds`, and runs a full fetch of that
+ * year only when the sample shows a new publication or revision.
+ * Validators are kept in watch-<yearId>.state across restarts.
+ */
+static int watchForPublication(const std::string& year, long intervalSeconds)
+{
+    if (!validateYear(year)) return 1;
+    const std::string& yearId = YEAR_TO_ID.at(year);
+
+    std::unordered_map<std::string, std::string> originalNames;
+    std::unordered_map<std::string, std::string> cdsLookup;
+    try {
+        cdsLookup = buildCDSLookup("../pubschls.csv", originalNames);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Failed to load CDS lookup: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<std::string> codes;
+    codes.reserve(cdsLookup.size());
+    for (const auto& [name, cds] : cdsLookup) codes.push_back(cds);
+
+    PublicationWatcher watcher(BASE_URL, yearId);
+    watcher.setSample(PublicationWatcher::stratifiedSample(codes));
+
+    const std::string statePath = "watch-" + yearId + ".state";
+    if (!watcher.loadState(statePath)) return 1;
+
+    std::cout << "[INFO] Watching " << watcher.sample().size() << " schools for "
+              << year << " every " << intervalSeconds << "s" << std::endl;
+
+    watcher.run(intervalSeconds, [&year](const PublicationWatcher::RoundResult& round) {
+        std::cout << "[INFO] " << round.changed.size()
+                  << " sampled card(s) changed; refetching " << year << std::endl;
+        fetchYears({year});
+    }, statePath);
+    return 0;
+}
+
+// =============================================================================
+// runProxy
+// =============================================================================
+
+/**
+ * Proxy mode: serves /Reports/ requests from other local tools through one
+ * shared response cache and rate limiter. GET /stats reports hit rate and
+ * latency. Runs until killed.
+ */
+static int runProxy(uint16_t port, double maxRequestsPerSec)
+{
+    ResponseCache cache;
+    RateLimiter   limiter(maxRequestsPerSec);
+    CachingProxy  proxy(cache, limiter);
+
+    if (!proxy.start(port)) return 1;
+    proxy.run();
+    return 0;
+}
+
+// =============================================================================
+// runQuery
+// =============================================================================
+
+/**
+ * Query mode: runs SQL against a saved store (saveEncoded or partitioned
+ * file), with pubschls.csv columns available when the directory loads.
+ * With `sql` empty, reads one query per line from stdin against the store
+ * held in memory.
+ */
+static int runQuery(const std::string& path, const std::string& sql)
+{
+    SchoolDirectory directory;
+    const bool haveDirectory = directory.load("../pubschls.csv");
+    if (!haveDirectory)
+        std::cerr << "[WARN] No school directory; directory columns are unavailable" << std::endl;
+    QueryEngine engine(haveDirectory ? &directory : nullptr);
+
+    char magic[4] = {};
+    std::ifstream(path, std::ios::binary).read(magic, sizeof(magic));
+    const bool partitioned = std::string(magic, 4) == "CDIP";
+
+    auto report = [](const QueryResult& result, double ms) {
+        result.print(std::cout);
+        std::cerr << "[INFO] " << result.rowsScanned << " rows scanned";
+        if (result.partitions.partitionsTotal)
+            std::cerr << ", " << result.partitions.partitionsScanned << "/"
+                      << result.partitions.partitionsTotal << " partitions";
+        std::cerr << ", " << ms << " ms" << std::endl;
+    };
+    auto elapsedMs = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+
+    // One-off query on a partitioned file: prune, decode, run.
+    PartitionedStoreReader reader;
+    if (partitioned && !reader.open(path)) return 1;
+    if (partitioned && !sql.empty()) {
+        QueryResult result;
+        auto start = std::chrono::steady_clock::now();
+        if (!engine.run(sql, reader, result)) return 1;
+        report(result, elapsedMs(start));
+        return 0;
+    }
+
+    IndicatorStore store;
+    if (partitioned ? !reader.scan(IndicatorFilter(), store) : !store.loadEncoded(path)) return 1;
+    engine.attach(store);
+
+    auto runOne = [&](const std::string& text) {
+        QueryResult result;
+        auto start = std::chrono::steady_clock::now();
+        if (!engine.run(text, result)) return false;
+        report(result, elapsedMs(start));
+        return true;
+    };
+    if (!sql.empty()) return runOne(sql) ? 0 : 1;
+
+    std::cerr << "[INFO] " << store.size() << " rows loaded; one query per line" << std::endl;
+    for (std::string line; std::getline(std::cin, line);) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        runOne(line);
+    }
+    return 0;
+}
+
+// =============================================================================
+// runBatch
+// =============================================================================
+
+// Streams the jobs in `jobsPath` through the API, writing results to
+// `outPath` (stdout when empty) in job order.
+static int runBatch(const std::string& jobsPath, const std::string& outPath)
+{
+    std::unordered_map<std::string, std::string> originalNames;
+    std::unordered_map<std::string, std::string> cdsLookup;
+    try {
+        cdsLookup = buildCDSLookup("../pubschls.csv", originalNames);
+    } catch (const std::exception& e) {
+        std::cerr << "[WARN] No CDS lookup (" << e.what() << "); only jobs with a cds will run\n";
+    }
+
+    // Job files tend to repeat names, and the fuzzy tiers scan every school.
+    // Capped so a file of distinct names cannot grow it without bound.
+    static constexpr std::size_t MAX_REMEMBERED_NAMES = 65536;
+    std::unordered_map<std::string, std::string> resolved;
+    auto resolve = [&](const std::string& school) {
+        auto it = resolved.find(school);
+        if (it != resolved.end()) return it->second;
+        if (resolved.size() >= MAX_REMEMBERED_NAMES) resolved.clear();
+        return resolved[school] = findBestMatch(school, cdsLookup, originalNames);
+    };
+    auto url = [](const std::string& cds, const std::string& year) -> std::string {
+        auto it = YEAR_TO_ID.find(year);
+        if (it == YEAR_TO_ID.end()) return "";
+        return BASE_URL + cds + "/" + it->second + "/SummaryCards";
+    };
+
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath, std::ios::app);
+        if (!file) {
+            std::cerr << "[ERROR] Cannot open " << outPath << "\n";
+            return 1;
+        }
+    }
+
+    CaliforniaDashboardAPI api;
+    if (!configureTransport(api)) return 1;
+    BatchRunner runner(api, resolve, url);
+    if (!runner.run(jobsPath, outPath.empty() ? std::cout : file)) return 1;
+
+    std::cerr << "[INFO] " << runner.jobsRead() << " jobs, " << runner.resultsWritten()
+              << " results, " << runner.failures() << " failed" << std::endl;
+    return 0;
+}
+
+// =============================================================================
+// runRefresh
+// =============================================================================
+
+/**
+ * Refresh daemon: keeps every eligible school's cards for every supported
+ * year current while spending at most `hourlyBudget` requests an hour.
+ * Past years are fetched once; the current year is rechecked weekly, hourly
+ * around the dates in CADASHBOARD_RELEASE_DATES (comma-separated
+ * YYYY-MM-DD) and after a card changes. Progress is kept in refresh.state.
+ */
+static int runRefresh(std::size_t hourlyBudget)
+{
+    SchoolDirectory directory;
+    if (!directory.load("../pubschls.csv")) return 1;
+
+    uint32_t currentYear = 0;
+    for (const auto& [year, id] : YEAR_TO_ID)
+        currentYear = std::max(currentYear, static_cast<uint32_t>(std::stoul(id)));
+
+    RefreshScheduler scheduler(hourlyBudget);
+    scheduler.setCurrentYear(currentYear);
+    if (const char* dates = std::getenv("CADASHBOARD_RELEASE_DATES")) {
+        std::stringstream ss(dates);
+        for (std::string date; std::getline(ss, date, ',');) {
+            struct tm tm = {};
+            if (!strptime(date.c_str(), "%Y-%m-%d", &tm)) {
+                std::cerr << "[WARN] Ignoring release date \"" << date << "\" (want YYYY-MM-DD)" << std::endl;
+                continue;
+            }
+            scheduler.addReleaseDate(currentYear, static_cast<int64_t>(timegm(&tm)));
+        }
+    }
+
+    const std::string statePath = "refresh.state";
+    if (!scheduler.loadState(statePath)) return 1;
+    for (std::size_t row = 0; row < directory.size(); ++row) {
+        if (!directory.hasDashboardCard(row)) continue;
+        for (const auto& [year, id] : YEAR_TO_ID)
+            scheduler.track(directory.cds(row), static_cast<uint32_t>(std::stoul(id)));
+    }
+    std::cout << "[INFO] Tracking " << scheduler.size() << " cards, at most "
+              << hourlyBudget << " requests/hour" << std::endl;
+
+    // schedule() can hand out a whole hour's budget at once; spread those
+    // requests over the hour instead of bursting them.
+    RateLimiter            pace(static_cast<double>(hourlyBudget) / 3600.0);
+    CaliforniaDashboardAPI api;
+    if (!configureTransport(api)) return 1;
+    api.setRateLimiter(&pace);
+
+    while (true) {
+        const std::vector<RefreshScheduler::Card> due = scheduler.schedule(std::time(nullptr));
+        if (!due.empty()) {
+            std::mutex  mtx;
+            std::size_t next = 0, changed = 0, failed = 0;
+            api.runStreamingFetch(
+                [&](std::string& url, std::size_t& tag) {
+                    if (next == due.size()) return false;
+                    tag = next++;
+                    url = BASE_URL + IndicatorStore::formatCds(due[tag].cds) + "/" +
+                          std::to_string(due[tag].schoolYearId) + "/SummaryCards";
+                    return true;
+                },
+                [&](std::size_t tag, SummaryCard& card, bool ok) {
+                    const uint64_t hash = ok && !card.getIndicatorVector().empty()
+                        ? RefreshScheduler::contentHash(CardRecordBuilder::build(card)) : 0;
+                    const RefreshScheduler::Card& c = due[tag];
+                    std::lock_guard<std::mutex> lk(mtx);
+                    if (ok && c.fetched && hash != c.contentHash) ++changed;
+                    if (!ok) ++failed;
+                    scheduler.record(c.cds, c.schoolYearId, std::time(nullptr), ok, hash);
+                });
+            if (!scheduler.saveState(statePath)) return 1;
+            std::cout << "[INFO] Refreshed " << due.size() << " cards: " << changed << " changed, "
+                      << failed << " failed" << std::endl;
+        }
+
+        // Sleep until something is due (or the budget frees up), at most an hour.
+        const int64_t now  = std::time(nullptr);
+        const int64_t wake = scheduler.nextWake(now);
+        const int64_t wait = std::clamp<int64_t>(wake - now, 1, 3600);
+        std::this_thread::sleep_for(std::chrono::seconds(wait));
+    }
+}
+
+// =============================================================================
+// runSample
+// =============================================================================
+
+/**
+ * Sample mode: fetches a stratified random `fraction` of schools for `year`
+ * and prints student-weighted estimates with 95% confidence intervals,
+ * statewide (next to the published statewide value every card carries)
+ * and per county.
+ */
+static int runSample(const std::string& year, double fraction, uint64_t seed)
+{
+    if (!validateYear(year)) return 1;
+    SchoolDirectory directory;
+    if (!directory.load("../pubschls.csv")) return 1;
+
+    SamplingPlan plan;
+    if (!SamplingPlanner(directory).plan(fraction, seed, plan)) return 1;
+    std::cerr << "[INFO] Sampling " << plan.sampleSize() << " of " << plan.population()
+              << " schools in " << plan.strata.size() << " strata (seed " << seed << ")" << std::endl;
+
+    std::vector<std::string> urls;
+    for (uint64_t cds : plan.cds())
+        urls.push_back(BASE_URL + IndicatorStore::formatCds(cds) + "/" + YEAR_TO_ID.at(year) + "/SummaryCards");
+
+    CaliforniaDashboardAPI api;
+    if (!configureTransport(api)) return 1;
+    if (!api.loadInURLs(urls) || !api.runFullURLFetch()) {
+        std::cerr << "Failed to fetch data" << std::endl;
+        return 1;
+    }
+
+    IndicatorStore     store;
+    StatewideReference published;
+    for (const auto& card : api.allSummaryCardsVector) {
+        store.append(card);
+        published.add(card);
+    }
+
+    EstimateSpec spec;
+    spec.studentWeighted = true;
+    spec.domainColumn    = SchoolDirectory::COUNTY;
+    std::cout << "indicator\tyear\tdomain\testimate\tlow\thigh\tschools\tpublished\n";
+    for (const SampleEstimate& e : SampleEstimator::estimate(plan, store, spec, &directory)) {
+        float statewide = 0;
+        const bool known = e.domain.empty() && published.find(e.indicatorId, e.schoolYearId, statewide);
+        std::cout << e.indicatorId << '\t' << e.schoolYearId << '\t'
+                  << (e.domain.empty() ? "Statewide" : e.domain) << '\t'
+                  << e.value << '\t' << e.low << '\t' << e.high << '\t' << e.schools << '\t';
+        if (known) std::cout << statewide;
+        std::cout << '\n';
+    }
+    return 0;
+}
+
+// =============================================================================
+// runLookup
+// =============================================================================
+
+/**
+ * Lookup mode: answers "<cds> <year>" lines from stdin one card at a time,
+ * printing each card as JSON and its source and latency to stderr. Repeat
+ * lookups are served from the card cache. CADASHBOARD_BASE_URL overrides
+ * the API prefix (e.g. a local caching proxy).
+ */
+static int runLookup()
+{
+    CaliforniaDashboardAPI api;
+    if (!configureTransport(api)) return 1;
+    if (const char* base = std::getenv("CADASHBOARD_BASE_URL"))
+        if (*base) api.setBaseUrl(base);
+
+    static const char* SOURCES[] = {"cache", "fetched", "coalesced"};
+    for (std::string line; std::getline(std::cin, line);) {
+        std::istringstream fields(line);
+        std::string cds, year;
+        if (!(fields >> cds >> year)) continue;
+        if (!validateYear(year)) continue;
+
+        CardCache::Record  record;
+        CardCache::Source  source;
+        auto start = std::chrono::steady_clock::now();
+        const bool ok = api.fetchOne(cds, YEAR_TO_ID.at(year), record, &source);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (!ok) {
+            std::cerr << "[WARN] No card for " << cds << " " << year << std::endl;
+            continue;
+        }
+        std::cout << CardRecordView(*record).toJson().dump() << "\n";
+        std::cerr << "[INFO] " << cds << " " << year << ": " << SOURCES[static_cast<int>(source)]
+                  << ", " << us << " us" << std::endl;
+    }
+
+    const CardCache::Stats stats = api.cardCache().stats();
+    std::cerr << "[INFO] " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.entries << " cards cached (" << stats.bytes / 1024 << " KiB)" << std::endl;
+    return 0;
+}
+
+// =============================================================================
+// main
+// =============================================================================
+
+int main(int argc, char** argv)
+{
+    // main watch <year> [intervalSeconds]
+    if (argc >= 3 && std::string(argv[1]) == "watch") {
+        long interval = (argc >= 4) ? std::atol(argv[3])
+                                    : PublicationWatcher::DEFAULT_INTERVAL_SECONDS;
+        return watchForPublication(argv[2], interval > 0 ? interval
+                                            : PublicationWatcher::DEFAULT_INTERVAL_SECONDS);
+    }
+
+    // main proxy [port] [maxRequestsPerSec]
+    if (argc >= 2 && std::string(argv[1]) == "proxy") {
+        int    port = (argc >= 3) ? std::atoi(argv[2]) : 8765;
+        double rate = (argc >= 4) ? std::atof(argv[3]) : 20.0;
+        return runProxy(static_cast<uint16_t>(port), rate);
+    }
+
+    // main query <store-file> ["<sql>"]
+    if (argc >= 3 && std::string(argv[1]) == "query") {
+        return runQuery(argv[2], (argc >= 4) ? argv[3] : "");
+    }
+
+    // main batch <jobs.jsonl> [results.jsonl]
+    if (argc >= 3 && std::string(argv[1]) == "batch") {
+        return runBatch(argv[2], (argc >= 4) ? argv[3] : "");
+    }
+
+    // main refresh [requestsPerHour]
+    if (argc >= 2 && std::string(argv[1]) == "refresh") {
+        long budget = (argc >= 3) ? std::atol(argv[2]) : 0;
+        return runRefresh(budget > 0 ? static_cast<std::size_t>(budget)
+                                     : RefreshScheduler::DEFAULT_HOURLY_BUDGET);
+    }
+
+    // main sample <year> [fraction] [seed]
+    if (argc >= 3 && std::string(argv[1]) == "sample") {
+        double   fraction = (argc >= 4) ? std::atof(argv[3]) : SamplingPlanner::DEFAULT_FRACTION;
+        uint64_t seed     = (argc >= 5) ? std::strtoull(argv[4], nullptr, 10) : 1;
+        return runSample(argv[2], fraction, seed);
+    }
+
+    // main lookup   (reads "<cds> <year>" lines from stdin)
+    if (argc >= 2 && std::string(argv[1]) == "lookup") {
+        return runLookup();
+    }
+
+    return fetchYears({"2021", "2022", "2023", "2024"});
+}
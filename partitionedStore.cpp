@@ -0,0 +1,278 @@
+#include "partitionedStore.hh"
+#include "perfRegions.hh"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+static constexpr char     PARTITION_MAGIC[4] = {'C', 'D', 'I', 'P'};
+static constexpr uint32_t PARTITION_VERSION  = 1;
+
+// Blocks start on page boundaries so pruned partitions are never faulted in
+// by read-ahead of a neighbouring partition.
+static constexpr uint64_t PARTITION_ALIGN = 4096;
+
+// Serialised size of one directory entry (see writeEntry/readEntry).
+static constexpr uint64_t DIRECTORY_ENTRY_BYTES = 6 * sizeof(int32_t) + 3 * sizeof(uint64_t);
+
+// Sanity bound when reading the partition count back from disk.
+static constexpr uint32_t MAX_PARTITIONS = 1u << 20;
+
+// =============================================================================
+// Filter / Pruning
+// =============================================================================
+
+int32_t countyOfCds(uint64_t cds) {
+    // CDS = CC DDDDD SSSSSSS
+    return static_cast<int32_t>(cds / 1'000'000'000'000ULL);
+}
+
+static bool hasCounty(const std::vector<int32_t>& counties, int32_t county) {
+    return counties.empty() ||
+           std::find(counties.begin(), counties.end(), county) != counties.end();
+}
+
+bool IndicatorFilter::matchesRow(const IndicatorStore& store, std::size_t row) const {
+    int32_t year = store.column(IndicatorStore::SCHOOL_YEAR_ID)[row];
+    if (year < minYearId || year > maxYearId) return false;
+    if (indicatorId && store.column(IndicatorStore::INDICATOR_ID)[row] != *indicatorId)
+        return false;
+    if (!hasCounty(counties, countyOfCds(store.cds()[row]))) return false;
+
+    int32_t status = store.column(IndicatorStore::STATUS)[row];
+    if (minStatus && status < IndicatorStore::toFixed(*minStatus)) return false;
+    if (maxStatus && status > IndicatorStore::toFixed(*maxStatus)) return false;
+
+    int32_t perf = store.column(IndicatorStore::PERFORMANCE)[row];
+    if (minPerformance && perf < *minPerformance) return false;
+    if (maxPerformance && perf > *maxPerformance) return false;
+    return true;
+}
+
+bool PartitionInfo::mayMatch(const IndicatorFilter& f) const {
+    if (rows == 0) return false;
+    if (schoolYearId < f.minYearId || schoolYearId > f.maxYearId) return false;
+    if (county >= 0 && !hasCounty(f.counties, county)) return false;
+    if (f.minStatus && maxStatus < IndicatorStore::toFixed(*f.minStatus)) return false;
+    if (f.maxStatus && minStatus > IndicatorStore::toFixed(*f.maxStatus)) return false;
+    if (f.minPerformance && maxPerformance < *f.minPerformance) return false;
+    if (f.maxPerformance && minPerformance > *f.maxPerformance) return false;
+    return true;
+}
+
+// =============================================================================
+// Directory serialisation
+// =============================================================================
+
+template <typename T>
+static void writePod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static bool readPod(std::istream& in, T& v) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+static void writeEntry(std::ostream& out, const PartitionInfo& p) {
+    writePod(out, p.schoolYearId);
+    writePod(out, p.county);
+    writePod(out, p.rows);
+    writePod(out, p.minStatus);
+    writePod(out, p.maxStatus);
+    writePod(out, p.minPerformance);
+    writePod(out, p.maxPerformance);
+    writePod(out, p.offset);
+    writePod(out, p.length);
+}
+
+static bool readEntry(std::istream& in, PartitionInfo& p) {
+    return readPod(in, p.schoolYearId) && readPod(in, p.county) &&
+           readPod(in, p.rows) &&
+           readPod(in, p.minStatus) && readPod(in, p.maxStatus) &&
+           readPod(in, p.minPerformance) && readPod(in, p.maxPerformance) &&
+           readPod(in, p.offset) && readPod(in, p.length);
+}
+
+// =============================================================================
+// PartitionedStoreWriter
+// =============================================================================
+
+bool PartitionedStoreWriter::write(const std::string& filename,
+                                   const IndicatorStore& store,
+                                   bool partitionByCounty)
+{
+    PerfRegion region("export_partitioned");
+    // Group row indices by partition key; std::map keeps the directory
+    // ordered by (year, county).
+    std::map<std::pair<int32_t, int32_t>, std::vector<std::size_t>> groups;
+    const auto& years = store.column(IndicatorStore::SCHOOL_YEAR_ID);
+    for (std::size_t row = 0; row < store.size(); ++row) {
+        int32_t county = partitionByCounty ? countyOfCds(store.cds()[row]) : -1;
+        groups[{years[row], county}].push_back(row);
+    }
+
+    std::vector<PartitionInfo> directory;
+    std::vector<std::string>   blobs;
+    directory.reserve(groups.size());
+    blobs.reserve(groups.size());
+
+    const auto& status = store.column(IndicatorStore::STATUS);
+    const auto& perf   = store.column(IndicatorStore::PERFORMANCE);
+
+    for (const auto& [key, rows] : groups) {
+        PartitionInfo info;
+        info.schoolYearId   = key.first;
+        info.county         = key.second;
+        info.rows           = rows.size();
+        info.minStatus      = info.maxStatus      = status[rows[0]];
+        info.minPerformance = info.maxPerformance = perf[rows[0]];
+        for (std::size_t row : rows) {
+            info.minStatus      = std::min(info.minStatus,      status[row]);
+            info.maxStatus      = std::max(info.maxStatus,      status[row]);
+            info.minPerformance = std::min(info.minPerformance, perf[row]);
+            info.maxPerformance = std::max(info.maxPerformance, perf[row]);
+        }
+
+        IndicatorStore part;
+        part.appendRows(store, rows);
+        EncodedIndicatorBlock block;
+        block.encode(part);
+
+        std::ostringstream buf(std::ios::binary);
+        if (!block.write(buf)) {
+            std::cerr << "Error: Failed to encode partition for year "
+                      << info.schoolYearId << std::endl;
+            return false;
+        }
+        info.length = buf.str().size();
+        directory.push_back(info);
+        blobs.push_back(std::move(buf).str());
+    }
+
+    // Lay out blocks after the header and directory, page-aligned.
+    const uint64_t headerBytes = sizeof(PARTITION_MAGIC) + 3 * sizeof(uint32_t)
+                               + directory.size() * DIRECTORY_ENTRY_BYTES;
+    uint64_t offset = headerBytes;
+    for (auto& info : directory) {
+        offset      = (offset + PARTITION_ALIGN - 1) / PARTITION_ALIGN * PARTITION_ALIGN;
+        info.offset = offset;
+        offset     += info.length;
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        return false;
+    }
+    file.write(PARTITION_MAGIC, sizeof(PARTITION_MAGIC));
+    writePod(file, PARTITION_VERSION);
+    writePod(file, static_cast<uint32_t>(partitionByCounty ? 1 : 0));
+    writePod(file, static_cast<uint32_t>(directory.size()));
+    for (const auto& info : directory) writeEntry(file, info);
+
+    uint64_t pos = headerBytes;
+    static const char zeros[PARTITION_ALIGN] = {};
+    for (std::size_t i = 0; i < directory.size(); ++i) {
+        file.write(zeros, static_cast<std::streamsize>(directory[i].offset - pos));
+        file.write(blobs[i].data(), static_cast<std::streamsize>(blobs[i].size()));
+        pos = directory[i].offset + directory[i].length;
+    }
+
+    if (file.fail()) {
+        std::cerr << "Error: Failed to write to file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// PartitionedStoreReader
+// =============================================================================
+
+bool PartitionedStoreReader::open(const std::string& filename) {
+    close();
+    file_.open(filename, std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        return false;
+    }
+    filename_ = filename;
+
+    char     magic[4];
+    uint32_t version = 0, flags = 0, count = 0;
+    file_.read(magic, sizeof(magic));
+    if (!file_ || !std::equal(magic, magic + 4, PARTITION_MAGIC) ||
+        !readPod(file_, version) || version != PARTITION_VERSION ||
+        !readPod(file_, flags) || !readPod(file_, count) || count > MAX_PARTITIONS) {
+        std::cerr << "Error: Not a partitioned indicator file: " << filename << std::endl;
+        close();
+        return false;
+    }
+    byCounty_ = (flags & 1) != 0;
+
+    partitions_.resize(count);
+    for (auto& info : partitions_) {
+        if (!readEntry(file_, info)) {
+            std::cerr << "Error: Truncated partition directory: " << filename << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void PartitionedStoreReader::close() {
+    if (file_.is_open()) file_.close();
+    file_.clear();
+    partitions_.clear();
+    filename_.clear();
+    byCounty_ = false;
+}
+
+bool PartitionedStoreReader::loadPartition(std::size_t index, IndicatorStore& out) {
+    if (index >= partitions_.size()) return false;
+    const PartitionInfo& info = partitions_[index];
+
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(info.offset));
+    EncodedIndicatorBlock block;
+    if (!block.read(file_) || block.rows() != info.rows) {
+        std::cerr << "Error: Corrupt partition " << index << " in " << filename_ << std::endl;
+        return false;
+    }
+    block.decodeInto(out);
+    return true;
+}
+
+bool PartitionedStoreReader::scan(const IndicatorFilter& filter, IndicatorStore& out,
+                                  PartitionScanStats* stats)
+{
+    if (!file_.is_open()) {
+        std::cerr << "Error: scan called on a closed partitioned file" << std::endl;
+        return false;
+    }
+    PartitionScanStats local;
+    local.partitionsTotal = partitions_.size();
+
+    IndicatorStore           part;
+    std::vector<std::size_t> matches;
+    for (std::size_t i = 0; i < partitions_.size(); ++i) {
+        if (!partitions_[i].mayMatch(filter)) continue;
+        if (!loadPartition(i, part)) return false;
+
+        ++local.partitionsScanned;
+        local.rowsScanned += part.size();
+        local.bytesRead   += partitions_[i].length;
+
+        matches.clear();
+        for (std::size_t row = 0; row < part.size(); ++row)
+            if (filter.matchesRow(part, row)) matches.push_back(row);
+        local.rowsMatched += matches.size();
+        out.appendRows(part, matches);
+    }
+
+    if (stats) *stats = local;
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef PARTITIONEDSTORE_H
+#define PARTITIONEDSTORE_H
+
+#include "indicatorStore.hh"
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Year-partitioned indicator files with partition pruning.
+//
+// Rows are split by schoolYearId (and optionally by county, the first two
+// digits of the CDS code). Each partition is an EncodedIndicatorBlock stored
+// at a page-aligned offset and described by a directory entry carrying its
+// min/max statistics, so a reader can rule partitions out from the directory
+// alone and never seek into their pages.
+// =============================================================================
+
+// Row predicate used both for pruning and for the final row-level filter.
+// Unset bounds match everything.
+struct IndicatorFilter {
+    int32_t minYearId = std::numeric_limits<int32_t>::min();
+    int32_t maxYearId = std::numeric_limits<int32_t>::max();
+    std::vector<int32_t>   counties;        // county codes (1..58); empty = all
+    std::optional<int32_t> indicatorId;
+    std::optional<float>   minStatus, maxStatus;
+    std::optional<int32_t> minPerformance, maxPerformance;
+
+    bool matchesRow(const IndicatorStore& store, std::size_t row) const;
+};
+
+struct PartitionInfo {
+    int32_t  schoolYearId   = 0;
+    int32_t  county         = -1;   // -1 when the file is year-partitioned only
+    uint64_t rows           = 0;
+    int32_t  minStatus      = 0;    // fixed-point, IndicatorStore::FIXED_POINT_SCALE
+    int32_t  maxStatus      = 0;
+    int32_t  minPerformance = 0;
+    int32_t  maxPerformance = 0;
+    uint64_t offset         = 0;    // byte offset of the encoded block
+    uint64_t length         = 0;
+
+    // False only when no row in the partition can satisfy the filter.
+    bool mayMatch(const IndicatorFilter& filter) const;
+};
+
+// Counters reported by PartitionedStoreReader::scan.
+struct PartitionScanStats {
+    std::size_t partitionsTotal   = 0;
+    std::size_t partitionsScanned = 0;
+    std::size_t rowsScanned       = 0;
+    std::size_t rowsMatched       = 0;
+    uint64_t    bytesRead         = 0;
+};
+
+// County code of a CDS code (first two digits), or 0 if unknown.
+int32_t countyOfCds(uint64_t cds);
+
+class PartitionedStoreWriter {
+public:
+    // Splits the store into partitions and writes them with a directory.
+    static bool write(const std::string& filename, const IndicatorStore& store,
+                      bool partitionByCounty = false);
+};
+
+class PartitionedStoreReader {
+public:
+    // Opens the file and reads only the header and partition directory.
+    bool open(const std::string& filename);
+    void close();
+
+    const std::vector<PartitionInfo>& partitions() const { return partitions_; }
+    bool partitionedByCounty() const { return byCounty_; }
+
+    // Appends every matching row to `out`, decoding only partitions whose
+    // directory entry may match the filter.
+    bool scan(const IndicatorFilter& filter, IndicatorStore& out,
+              PartitionScanStats* stats = nullptr);
+
+    // Decodes a single partition in full.
+    bool loadPartition(std::size_t index, IndicatorStore& out);
+
+private:
+    std::ifstream              file_;
+    std::string                filename_;
+    bool                       byCounty_ = false;
+    std::vector<PartitionInfo> partitions_;
+};
+
+#endif // PARTITIONEDSTORE_H
@@ -0,0 +1,164 @@
+#include "payloadCompressor.hh"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <zdict.h>
+#include <zstd.h>
+
+// Largest decompressed payload accepted — a SummaryCards body is a few KB.
+static constexpr unsigned long long MAX_PAYLOAD_BYTES = 64ull * 1024 * 1024;
+
+// =============================================================================
+// Per-thread contexts
+// =============================================================================
+
+namespace {
+struct ThreadContexts {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    ~ThreadContexts() {
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+ThreadContexts& contexts() {
+    thread_local ThreadContexts ctx;
+    return ctx;
+}
+} // namespace
+
+// =============================================================================
+// Dictionary management
+// =============================================================================
+
+PayloadCompressor::~PayloadCompressor() {
+    releaseDictionaries();
+}
+
+void PayloadCompressor::releaseDictionaries() {
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+    cdict_ = nullptr;
+    ddict_ = nullptr;
+}
+
+bool PayloadCompressor::train(const std::vector<std::string>& samples,
+                              std::size_t dictionaryBytes)
+{
+    std::string         buffer;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& s : samples) {
+        if (s.empty()) continue;
+        buffer += s;
+        sizes.push_back(s.size());
+    }
+    if (sizes.empty()) {
+        std::cerr << "Error: No samples to train a dictionary from." << std::endl;
+        return false;
+    }
+
+    std::string dict(dictionaryBytes, '\0');
+    size_t n = ZDICT_trainFromBuffer(&dict[0], dict.size(), buffer.data(),
+                                     sizes.data(), static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(n)) {
+        std::cerr << "Error: Dictionary training failed: " << ZDICT_getErrorName(n) << std::endl;
+        return false;
+    }
+    dict.resize(n);
+    return setDictionary(dict);
+}
+
+bool PayloadCompressor::setDictionary(const std::string& dictionary) {
+    releaseDictionaries();
+    dictionary_ = dictionary;
+    if (dictionary_.empty()) return true;
+
+    cdict_ = ZSTD_createCDict(dictionary_.data(), dictionary_.size(), level_);
+    ddict_ = ZSTD_createDDict(dictionary_.data(), dictionary_.size());
+    if (!cdict_ || !ddict_) {
+        std::cerr << "Error: Could not digest zstd dictionary." << std::endl;
+        releaseDictionaries();
+        dictionary_.clear();
+        return false;
+    }
+    return true;
+}
+
+void PayloadCompressor::setLevel(int level) {
+    level_ = level;
+    if (!dictionary_.empty()) {
+        std::string dict = dictionary_;
+        setDictionary(dict);
+    }
+}
+
+bool PayloadCompressor::loadDictionary(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    return setDictionary(content);
+}
+
+bool PayloadCompressor::saveDictionary(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        return false;
+    }
+    file.write(dictionary_.data(), static_cast<std::streamsize>(dictionary_.size()));
+    if (file.fail()) {
+        std::cerr << "Error: Failed to write to file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// Compress / Decompress
+// =============================================================================
+
+bool PayloadCompressor::compress(const std::string& in, std::string& out) const {
+    ZSTD_CCtx* cctx = contexts().cctx;
+    out.resize(ZSTD_compressBound(in.size()));
+
+    size_t n = cdict_
+        ? ZSTD_compress_usingCDict(cctx, &out[0], out.size(), in.data(), in.size(), cdict_)
+        : ZSTD_compressCCtx(cctx, &out[0], out.size(), in.data(), in.size(), level_);
+    if (ZSTD_isError(n)) {
+        std::cerr << "Error: zstd compression failed: " << ZSTD_getErrorName(n) << std::endl;
+        out.clear();
+        return false;
+    }
+    out.resize(n);
+    return true;
+}
+
+bool PayloadCompressor::decompress(const std::string& in, std::string& out) const {
+    return decompress(in.data(), in.size(), out);
+}
+
+bool PayloadCompressor::decompress(const char* data, std::size_t size, std::string& out) const {
+    unsigned long long content = ZSTD_getFrameContentSize(data, size);
+    if (content == ZSTD_CONTENTSIZE_ERROR || content == ZSTD_CONTENTSIZE_UNKNOWN ||
+        content > MAX_PAYLOAD_BYTES) {
+        out.clear();
+        return false;
+    }
+
+    out.resize(static_cast<std::size_t>(content));
+    ZSTD_DCtx* dctx = contexts().dctx;
+    size_t n = ddict_
+        ? ZSTD_decompress_usingDDict(dctx, &out[0], out.size(), data, size, ddict_)
+        : ZSTD_decompressDCtx(dctx, &out[0], out.size(), data, size);
+    if (ZSTD_isError(n) || n != content) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
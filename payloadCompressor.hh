@@ -0,0 +1,64 @@
+#ifndef PAYLOADCOMPRESSOR_H
+#define PAYLOADCOMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+// =============================================================================
+// PayloadCompressor — zstd with a dictionary trained on SummaryCards bodies.
+//
+// Every card repeats the same 17 field names and the same statewide secondary
+// block, so a few kilobytes of trained dictionary let zstd encode a body as
+// little more than its numbers. Digested dictionaries are built once and are
+// read-only afterwards; compression contexts are per thread, so one instance
+// can be shared by every fetch worker.
+// =============================================================================
+
+class PayloadCompressor {
+public:
+    static constexpr std::size_t DEFAULT_DICTIONARY_BYTES = 16 * 1024;
+    static constexpr int         DEFAULT_LEVEL            = 9;
+
+    PayloadCompressor() = default;
+    ~PayloadCompressor();
+
+    PayloadCompressor(const PayloadCompressor&)            = delete;
+    PayloadCompressor& operator=(const PayloadCompressor&) = delete;
+
+    // Trains a dictionary from sample payloads (a few hundred responses is
+    // plenty). Returns false if zstd rejects the sample set.
+    bool train(const std::vector<std::string>& samples,
+               std::size_t dictionaryBytes = DEFAULT_DICTIONARY_BYTES);
+
+    // Uses an existing dictionary (e.g. one saved by saveDictionary).
+    bool setDictionary(const std::string& dictionary);
+    bool loadDictionary(const std::string& filename);
+    bool saveDictionary(const std::string& filename) const;
+
+    // Re-digests the dictionary at the new level if one is loaded.
+    void setLevel(int level);
+
+    bool hasDictionary() const { return !dictionary_.empty(); }
+    const std::string& dictionary() const { return dictionary_; }
+
+    // Compress/decompress a single payload. Without a dictionary these fall
+    // back to plain zstd. decompress returns false on corrupt input or a
+    // frame produced with a different dictionary.
+    bool compress(const std::string& in, std::string& out) const;
+    bool decompress(const std::string& in, std::string& out) const;
+    bool decompress(const char* data, std::size_t size, std::string& out) const;
+
+private:
+    void releaseDictionaries();
+
+    std::string   dictionary_;
+    int           level_ = DEFAULT_LEVEL;
+    ZSTD_CDict_s* cdict_ = nullptr;
+    ZSTD_DDict_s* ddict_ = nullptr;
+};
+
+#endif // PAYLOADCOMPRESSOR_H
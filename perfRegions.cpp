@@ -0,0 +1,206 @@
+#include "perfRegions.hh"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+// =============================================================================
+// Per-thread counter groups and totals
+// =============================================================================
+
+namespace {
+
+constexpr int COUNTERS = 4;
+const char* const COUNTER_NAMES[COUNTERS] = {"cycles", "instructions", "cache-miss", "branch-miss"};
+
+struct RegionTotals {
+    uint64_t calls = 0;
+    uint64_t ns    = 0;
+    uint64_t counters[COUNTERS] = {};
+};
+
+// Owned by the registry so totals survive the thread that produced them.
+struct ThreadTotals {
+    unsigned long                                    tid = 0;
+    std::mutex                                       mtx;   // vs. perfReport()
+    std::map<std::string, RegionTotals, std::less<>> regions;   // by name, not pointer
+};
+
+struct Registry {
+    std::mutex                                 mtx;
+    std::vector<std::shared_ptr<ThreadTotals>> threads;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull + ts.tv_nsec;
+}
+
+#ifdef __linux__
+int openCounter(uint64_t config, int groupFd) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = config;
+    attr.disabled       = groupFd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+#endif
+
+std::atomic<bool> g_broken{false};   // counters unavailable on this host
+
+// The calling thread's counter group, opened on first use.
+struct ThreadCounters {
+    int                           fds[COUNTERS] = {-1, -1, -1, -1};
+    bool                          ok = false;
+    std::shared_ptr<ThreadTotals> totals;
+
+    ThreadCounters() {
+#ifdef __linux__
+        static const uint64_t configs[COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int i = 0; i < COUNTERS; ++i) {
+            fds[i] = openCounter(configs[i], i == 0 ? -1 : fds[0]);
+            if (fds[i] < 0) break;
+        }
+        ok = fds[COUNTERS - 1] >= 0;
+        if (ok) {
+            ioctl(fds[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        } else if (!g_broken.exchange(true)) {
+            fprintf(stderr, "[PERF] perf_event_open failed (%s); hardware counters disabled. "
+                            "Check /proc/sys/kernel/perf_event_paranoid.\n", strerror(errno));
+        }
+#endif
+        totals = std::make_shared<ThreadTotals>();
+        totals->tid = static_cast<unsigned long>(syscall(SYS_gettid));
+        std::lock_guard<std::mutex> lk(registry().mtx);
+        registry().threads.push_back(totals);
+    }
+
+    ~ThreadCounters() {
+        for (int fd : fds)
+            if (fd >= 0) close(fd);
+    }
+
+    bool read(uint64_t out[COUNTERS]) const {
+        if (!ok) return false;
+        struct { uint64_t nr; uint64_t values[COUNTERS]; } buf;
+        if (::read(fds[0], &buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) return false;
+        std::memcpy(out, buf.values, sizeof(buf.values));
+        return true;
+    }
+};
+
+ThreadCounters& threadCounters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+} // namespace
+
+// =============================================================================
+// Public interface
+// =============================================================================
+
+bool perfEnabledFromEnv() {
+    const char* v = std::getenv("CADASHBOARD_PERF");
+    bool on = v && *v && std::strcmp(v, "0") != 0;
+    if (on) {
+        registry();   // constructed first so it outlives the exit report
+        std::atexit([] { perfReport(stderr); });
+    }
+    return on;
+}
+
+void PerfRegion::begin(const char* name) {
+    name_   = name;
+    active_ = true;
+    threadCounters().read(start_);
+    start_ns_ = nowNs();
+}
+
+void PerfRegion::end() {
+    const uint64_t ns = nowNs() - start_ns_;
+    ThreadCounters& tc = threadCounters();
+    uint64_t now[COUNTERS] = {};
+    const bool haveCounters = tc.read(now);
+
+    std::lock_guard<std::mutex> lk(tc.totals->mtx);
+    auto it = tc.totals->regions.find(name_);   // no allocation once the region exists
+    if (it == tc.totals->regions.end()) it = tc.totals->regions.emplace(name_, RegionTotals()).first;
+    RegionTotals& r = it->second;
+    ++r.calls;
+    r.ns += ns;
+    if (haveCounters)
+        for (int i = 0; i < COUNTERS; ++i) r.counters[i] += now[i] - start_[i];
+}
+
+void perfReport(FILE* out) {
+    std::vector<std::shared_ptr<ThreadTotals>> threads;
+    {
+        std::lock_guard<std::mutex> lk(registry().mtx);
+        threads = registry().threads;
+    }
+
+    // Snapshot every thread's totals, then print per region: all threads
+    // combined first, followed by each thread that ran it.
+    std::map<std::string, std::vector<std::pair<unsigned long, RegionTotals>>> byRegion;
+    for (const auto& t : threads) {
+        std::lock_guard<std::mutex> lk(t->mtx);
+        for (const auto& [name, totals] : t->regions)
+            byRegion[name].push_back({t->tid, totals});
+    }
+    if (byRegion.empty()) return;
+
+    auto line = [out](const char* label, unsigned long tid, const RegionTotals& r) {
+        const double ipc = r.counters[0] ? double(r.counters[1]) / double(r.counters[0]) : 0.0;
+        char who[32];
+        if (tid) snprintf(who, sizeof(who), "  tid %lu", tid);
+        else     snprintf(who, sizeof(who), "%s", label);
+        fprintf(out, "%-24s %8llu %12.3f %14llu %14llu %5.2f %12llu %12llu\n",
+                who, (unsigned long long)r.calls, r.ns / 1e6,
+                (unsigned long long)r.counters[0], (unsigned long long)r.counters[1], ipc,
+                (unsigned long long)r.counters[2], (unsigned long long)r.counters[3]);
+    };
+
+    fprintf(out, "\n[PERF] %-17s %8s %12s %14s %14s %5s %12s %12s\n", "region", "calls", "ms",
+            COUNTER_NAMES[0], COUNTER_NAMES[1], "IPC", COUNTER_NAMES[2], COUNTER_NAMES[3]);
+    for (const auto& [name, perThread] : byRegion) {
+        RegionTotals sum;
+        for (const auto& [tid, r] : perThread) {
+            sum.calls += r.calls;
+            sum.ns    += r.ns;
+            for (int i = 0; i < COUNTERS; ++i) sum.counters[i] += r.counters[i];
+        }
+        line(name.c_str(), 0, sum);
+        if (perThread.size() > 1)
+            for (const auto& [tid, r] : perThread) line(nullptr, tid, r);
+    }
+}
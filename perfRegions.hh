@@ -0,0 +1,62 @@
+#ifndef PERFREGIONS_H
+#define PERFREGIONS_H
+
+#include <cstdint>
+#include <cstdio>
+
+// =============================================================================
+// Hardware performance counters around named regions.
+//
+// Opt-in: set CADASHBOARD_PERF=1 in the environment. When enabled, each
+// thread opens one perf_event_open counter group (cycles, instructions,
+// cache misses, branch misses; user space only) on first use, and every
+// PerfRegion reads the group on entry and exit and adds the difference to
+// that thread's totals for the region. A report per region and per thread
+// is printed to stderr at exit, or on demand with perfReport().
+//
+// When disabled, a PerfRegion costs a check of a once-initialized flag and
+// one predictable branch: no clock reads, locks or map lookups. When the
+// kernel refuses the counters (perf_event_paranoid, containers), regions
+// still count calls and wall time, and pay a clock read on entry and exit
+// and a per-thread lock on exit.
+//
+// Regions are keyed by name, so every PerfRegion("csv_parse") adds to the
+// same totals. Nested regions are counted inclusively.
+// =============================================================================
+
+// Reads CADASHBOARD_PERF; call perfEnabled() instead.
+bool perfEnabledFromEnv();
+
+inline bool perfEnabled() {
+    static const bool enabled = perfEnabledFromEnv();
+    return enabled;
+}
+
+class PerfRegion {
+public:
+    explicit PerfRegion(const char* name) {
+        if (perfEnabled()) begin(name);
+    }
+    ~PerfRegion() {
+        if (active_) end();
+    }
+
+    PerfRegion(const PerfRegion&)            = delete;
+    PerfRegion& operator=(const PerfRegion&) = delete;
+
+private:
+    static constexpr int COUNTERS = 4;   // cycles, instructions, cache, branch
+
+    void begin(const char* name);
+    void end();
+
+    const char* name_   = nullptr;
+    bool        active_ = false;
+    uint64_t    start_[COUNTERS] = {};
+    uint64_t    start_ns_ = 0;
+};
+
+// Prints accumulated counters for every region and thread seen so far.
+void perfReport(FILE* out = stderr);
+
+#endif // PERFREGIONS_H
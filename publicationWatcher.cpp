@@ -0,0 +1,291 @@
+#include "publicationWatcher.hh"
+#include "caTrustStore.hh"
+#include "cardRecord.hh"
+#include "summaryCard.hh"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <time.h>
+#include <unistd.h>
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+PublicationWatcher::PublicationWatcher(const std::string& baseUrl, const std::string& yearId,
+                                       long timeoutMs)
+    : baseUrl_(baseUrl), yearId_(yearId)
+{
+    CURLcode rc = curl_global_init(CURL_GLOBAL_ALL);
+    if (rc != CURLE_OK)
+        throw std::runtime_error(std::string("curl_global_init: ") +
+                                 curl_easy_strerror(rc));
+
+    curl_ = curl_easy_init();
+    if (!curl_)
+        throw std::runtime_error("PublicationWatcher: curl_easy_init failed");
+
+    CaTrustStore::shared().apply(curl_);
+    curl_easy_setopt(curl_, CURLOPT_USERAGENT,
+        "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) "
+        "AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/120.0.0.0 Safari/537.36");
+    curl_easy_setopt(curl_, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS,     timeoutMs);
+    curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION,  &PublicationWatcher::bodyCallback);
+    curl_easy_setopt(curl_, CURLOPT_WRITEDATA,      this);
+    curl_easy_setopt(curl_, CURLOPT_HEADERFUNCTION, &PublicationWatcher::headerCallback);
+    curl_easy_setopt(curl_, CURLOPT_HEADERDATA,     this);
+    // Let curl decompress so the content hash is of the JSON itself.
+    curl_easy_setopt(curl_, CURLOPT_ACCEPT_ENCODING, "");
+}
+
+PublicationWatcher::~PublicationWatcher() {
+    if (curl_) curl_easy_cleanup(curl_);
+    curl_global_cleanup();
+}
+
+// =============================================================================
+// Sampling
+// =============================================================================
+
+std::vector<std::string> PublicationWatcher::stratifiedSample(std::vector<std::string> cdsCodes,
+                                                              std::size_t sampleSize)
+{
+    std::sort(cdsCodes.begin(), cdsCodes.end());
+    cdsCodes.erase(std::unique(cdsCodes.begin(), cdsCodes.end()), cdsCodes.end());
+
+    // Group by county: codes are sorted, so each county is one contiguous run.
+    std::vector<std::pair<std::size_t, std::size_t>> counties; // [begin, end)
+    for (std::size_t i = 0; i < cdsCodes.size(); ++i) {
+        if (cdsCodes[i].size() < 2) continue;
+        if (counties.empty() ||
+            cdsCodes[i].compare(0, 2, cdsCodes[counties.back().first], 0, 2) != 0)
+            counties.push_back({i, i + 1});
+        else
+            counties.back().second = i + 1;
+    }
+
+    std::vector<std::string> sample;
+    if (counties.empty() || sampleSize == 0) return sample;
+
+    // One code from each of sampleSize evenly spaced counties; if there are
+    // fewer counties than requested, go round again taking the next school.
+    for (std::size_t k = 0; k < sampleSize; ++k) {
+        const std::size_t pass   = k / counties.size();
+        const std::size_t within = k % counties.size();
+        const std::size_t perPass = std::min(sampleSize - pass * counties.size(), counties.size());
+        const auto& [begin, end] = counties[within * counties.size() / perPass];
+        const std::size_t n = end - begin;
+        if (pass >= n) continue;
+        // Middle of the county's run, then its neighbours on later passes.
+        sample.push_back(cdsCodes[begin + (n / 2 + pass) % n]);
+    }
+    return sample;
+}
+
+// =============================================================================
+// State file
+// =============================================================================
+
+bool PublicationWatcher::loadState(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return true;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string cds, etag, lastModified, hash, status;
+        if (!std::getline(fields, cds, '\t') || !std::getline(fields, etag, '\t') ||
+            !std::getline(fields, lastModified, '\t') || !std::getline(fields, hash, '\t')) {
+            std::cerr << "Error: Malformed watcher state line in " << path << std::endl;
+            return false;
+        }
+        std::getline(fields, status);
+        ProbeState& s = state_[cds];
+        s.etag         = etag;
+        s.lastModified = lastModified;
+        s.contentHash  = std::strtoull(hash.c_str(), nullptr, 16);
+        s.lastStatus   = status.empty() ? 200 : std::strtol(status.c_str(), nullptr, 10);
+    }
+    return true;
+}
+
+bool PublicationWatcher::saveState(const std::string& path) const {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open file for writing: " << tmp << std::endl;
+            return false;
+        }
+        char hex[17];
+        for (const auto& [cds, s] : state_) {
+            snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(s.contentHash));
+            out << cds << '\t' << s.etag << '\t' << s.lastModified << '\t' << hex << '\t'
+                << s.lastStatus << '\n';
+        }
+        if (!out.good()) return false;
+    }
+    // Rename so a crash mid-write never leaves a truncated state file.
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Could not replace state file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// Probing
+// =============================================================================
+
+size_t PublicationWatcher::bodyCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    const size_t bytes = size * nmemb;
+    static_cast<PublicationWatcher*>(userdata)->body_.append(ptr, bytes);
+    return bytes;
+}
+
+// Value of a "Name: value" header line if the name matches, trimmed.
+static bool headerValue(const char* line, size_t len, const char* name, std::string& out) {
+    const size_t n = std::strlen(name);
+    if (len <= n || line[n] != ':') return false;
+    for (size_t i = 0; i < n; ++i)
+        if (std::tolower(static_cast<unsigned char>(line[i])) != name[i]) return false;
+    size_t b = n + 1, e = len;
+    while (b < e && (line[b] == ' ' || line[b] == '\t')) ++b;
+    while (e > b && (line[e - 1] == '\r' || line[e - 1] == '\n' || line[e - 1] == ' ')) --e;
+    out.assign(line + b, e - b);
+    return true;
+}
+
+size_t PublicationWatcher::headerCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* self = static_cast<PublicationWatcher*>(userdata);
+    const size_t bytes = size * nmemb;
+    // A redirect starts a new header block; keep only the final response's.
+    if (bytes > 5 && std::strncmp(ptr, "HTTP/", 5) == 0) {
+        self->etag_.clear();
+        self->lastModified_.clear();
+    }
+    headerValue(ptr, bytes, "etag", self->etag_) ||
+        headerValue(ptr, bytes, "last-modified", self->lastModified_);
+    return bytes;
+}
+
+// FNV-1a over the card's binary record: field values only, so key order,
+// whitespace and fields the store ignores don't register as changes.
+static uint64_t contentHash(const std::string& body) {
+    SummaryCard card;
+    card.appendRawData(body.data(), body.size());
+    card.parseRawData();
+    if (card.getIndicatorVector().empty()) return 0;
+
+    const std::string record = CardRecordBuilder::build(card);
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : record) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h ? h : 1;
+}
+
+bool PublicationWatcher::probe(const std::string& cds, RoundResult& round) {
+    const std::string url = baseUrl_ + cds + "/" + yearId_ + "/SummaryCards";
+    ProbeState& s = state_[cds];
+    const bool baseline   = s.lastStatus == 0;
+    const bool wasMissing = s.lastStatus == 404 || s.lastStatus == 204;
+
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Referer: https://www.caschooldashboard.org/");
+    headers = curl_slist_append(headers, "Accept: application/json, text/plain, */*");
+    if (!s.etag.empty())
+        headers = curl_slist_append(headers, ("If-None-Match: " + s.etag).c_str());
+    if (!s.lastModified.empty())
+        headers = curl_slist_append(headers, ("If-Modified-Since: " + s.lastModified).c_str());
+
+    body_.clear();
+    etag_.clear();
+    lastModified_.clear();
+    curl_easy_setopt(curl_, CURLOPT_URL,        url.c_str());
+    curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
+
+    CURLcode rc = curl_easy_perform(curl_);
+    curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, nullptr);
+    curl_slist_free_all(headers);
+    ++round.requests;
+
+    if (rc != CURLE_OK) {
+        fprintf(stderr, "[WATCH] %s: %s\n", url.c_str(), curl_easy_strerror(rc));
+        ++round.errors;
+        return false;
+    }
+
+    long http_code = 0;
+    curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &http_code);
+    if (http_code == 304) {
+        ++round.notModified;
+        return true;
+    }
+    // Not published yet for this year: remember that, so the first card
+    // to appear counts as a publication.
+    if (http_code == 404 || http_code == 204) {
+        s.lastStatus = http_code;
+        return true;
+    }
+    if (http_code < 200 || http_code >= 300) {
+        fprintf(stderr, "[WATCH] HTTP %ld for %s\n", http_code, url.c_str());
+        ++round.errors;
+        return false;
+    }
+
+    const uint64_t hash = contentHash(body_);
+    s.etag         = etag_;
+    s.lastModified = lastModified_;
+    if (hash == 0) {                     // empty card, nothing published yet
+        s.lastStatus = 204;
+        return true;
+    }
+
+    if (!baseline && (wasMissing || hash != s.contentHash))
+        round.changed.push_back(cds);
+    s.contentHash = hash;
+    s.lastStatus  = 200;
+    return true;
+}
+
+PublicationWatcher::RoundResult PublicationWatcher::probeOnce() {
+    RoundResult round;
+    // Finish the whole round even after a hit so every validator is current
+    // and the next round doesn't report the same publication again.
+    for (const std::string& cds : sample_) {
+        if (stop_) break;
+        probe(cds, round);
+    }
+    return round;
+}
+
+void PublicationWatcher::run(long intervalSeconds,
+                             const std::function<void(const RoundResult&)>& onChange,
+                             const std::string& statePath)
+{
+    stop_ = false;
+    while (!stop_) {
+        RoundResult round = probeOnce();
+        fprintf(stderr, "[WATCH] yearId=%s  %zu requests, %zu not modified, %zu errors, %zu changed\n",
+                yearId_.c_str(), round.requests, round.notModified, round.errors,
+                round.changed.size());
+
+        if (!statePath.empty()) saveState(statePath);
+        if (!round.changed.empty() && onChange) onChange(round);
+
+        // Sleep in short steps so stop() takes effect promptly.
+        for (long waited = 0; waited < intervalSeconds && !stop_; ++waited) {
+            struct timespec ts = { 1, 0 };
+            nanosleep(&ts, nullptr);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef PUBLICATIONWATCHER_H
+#define PUBLICATIONWATCHER_H
+
+#include <curl/curl.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// PublicationWatcher — cheap detection of new dashboard releases.
+//
+// Instead of refetching every school to find out whether anything changed,
+// the watcher probes a small sample of CDS codes for one yearId on a long
+// interval. Each probe is a conditional GET (If-None-Match/If-Modified-Since
+// from the previous response), so an unchanged card usually costs a 304
+// with no body. When the server does send a body, its parsed content is
+// hashed and compared with the last one seen, so header churn alone does
+// not count as a change. A sample CDS that starts answering (or changes its
+// content) means a publication or revision; the caller's callback then runs
+// the real fetch.
+//
+// Validators persist to a small state file so a restarted daemon does not
+// mistake its first round for a publication.
+// =============================================================================
+
+class PublicationWatcher {
+public:
+    static constexpr std::size_t DEFAULT_SAMPLE_SIZE      = 6;
+    static constexpr long        DEFAULT_INTERVAL_SECONDS = 30 * 60;
+    static constexpr long        DEFAULT_TIMEOUT_MS       = 15'000;
+
+    // Last known state of one sampled card.
+    struct ProbeState {
+        std::string etag;
+        std::string lastModified;
+        uint64_t    contentHash = 0;   // 0 = no card seen yet
+        long        lastStatus  = 0;   // 200, or 404/204 while unpublished; 0 = never probed
+    };
+
+    // Outcome of one probe round.
+    struct RoundResult {
+        std::size_t              requests    = 0;
+        std::size_t              notModified = 0;   // 304 responses
+        std::size_t              errors      = 0;
+        std::vector<std::string> changed;           // CDS codes whose content changed
+    };
+
+    PublicationWatcher(const std::string& baseUrl, const std::string& yearId,
+                       long timeoutMs = DEFAULT_TIMEOUT_MS);
+    ~PublicationWatcher();
+
+    PublicationWatcher(const PublicationWatcher&)            = delete;
+    PublicationWatcher& operator=(const PublicationWatcher&) = delete;
+
+    // Picks sampleSize codes spread across counties (the first two CDS
+    // digits): counties are taken at even spacing, and within a county the
+    // school at a fixed position, so the same input always yields the same
+    // sample and consecutive rounds probe the same cards.
+    static std::vector<std::string> stratifiedSample(std::vector<std::string> cdsCodes,
+                                                     std::size_t sampleSize = DEFAULT_SAMPLE_SIZE);
+
+    void setSample(const std::vector<std::string>& cdsCodes) { sample_ = cdsCodes; }
+    const std::vector<std::string>& sample() const { return sample_; }
+
+    // State file: one line per CDS, "cds\tetag\tlastModified\thash\tstatus".
+    // A missing file is not an error (first run); lines from before the
+    // status column was added load as probed with a 200.
+    bool loadState(const std::string& path);
+    bool saveState(const std::string& path) const;
+
+    // Probes every sampled CDS once. A CDS probed for the first time
+    // establishes a baseline and is not reported as changed. A CDS whose
+    // previous probe found no card (404, 204 or an empty card) and that now
+    // answers with one is reported: that is a first publication.
+    RoundResult probeOnce();
+
+    // Probes every intervalSeconds until stop() is called. Whenever a round
+    // reports changes, onChange runs with that round's result (on this
+    // thread, so the probe loop pauses while the fetch runs). The state file,
+    // if given, is rewritten after every round.
+    void run(long intervalSeconds,
+             const std::function<void(const RoundResult&)>& onChange,
+             const std::string& statePath = "");
+    void stop() { stop_ = true; }
+
+    const std::map<std::string, ProbeState>& state() const { return state_; }
+
+private:
+    bool probe(const std::string& cds, RoundResult& round);
+
+    static size_t bodyCallback(char* ptr, size_t size, size_t nmemb, void* userdata);
+    static size_t headerCallback(char* ptr, size_t size, size_t nmemb, void* userdata);
+
+    std::string baseUrl_;
+    std::string yearId_;
+    CURL*       curl_ = nullptr;
+
+    std::vector<std::string>          sample_;
+    std::map<std::string, ProbeState> state_;
+    std::atomic<bool>                 stop_{false};
+
+    // Per-request scratch filled by the callbacks.
+    std::string body_;
+    std::string etag_;
+    std::string lastModified_;
+};
+
+#endif // PUBLICATIONWATCHER_H
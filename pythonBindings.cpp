@@ -0,0 +1,208 @@
+// =============================================================================
+// cadashboard — Python bindings over the caDashboard library.
+//
+// Indicator columns are exposed as read-only NumPy arrays that point straight
+// into the IndicatorStore's vectors; the store object is each array's base, so
+// nothing is copied and the data lives as long as any view of it. Stores
+// handed to Python are immutable, which keeps those views valid.
+// =============================================================================
+
+#include "CaliforniaDashboardAPI.hh"
+#include "cardRecord.hh"
+#include "cdsJoin.hh"
+#include "indicatorStore.hh"
+#include "partitionedStore.hh"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <optional>
+#include <stdexcept>
+
+namespace py = pybind11;
+
+// Wraps a store-owned column as a read-only 1-D array without copying.
+template <typename T>
+static py::array columnView(const std::vector<T>& column, py::handle owner) {
+    py::array arr(py::dtype::of<T>(),
+                  {static_cast<py::ssize_t>(column.size())},
+                  {static_cast<py::ssize_t>(sizeof(T))},
+                  column.data(), owner);
+    arr.attr("setflags")(py::arg("write") = false);
+    return arr;
+}
+
+static const IndicatorStore& storeOf(const py::object& self) {
+    return self.cast<const IndicatorStore&>();
+}
+
+// Python attribute name for every IndicatorStore::IntColumn.
+static const std::pair<const char*, IndicatorStore::IntColumn> INT_COLUMNS[] = {
+    {"school_year_id", IndicatorStore::SCHOOL_YEAR_ID},
+    {"indicator_id",   IndicatorStore::INDICATOR_ID},
+    {"status_fixed",   IndicatorStore::STATUS},
+    {"change_fixed",   IndicatorStore::CHANGE},
+    {"change_id",      IndicatorStore::CHANGE_ID},
+    {"status_id",      IndicatorStore::STATUS_ID},
+    {"performance",    IndicatorStore::PERFORMANCE},
+    {"total_groups",   IndicatorStore::TOTAL_GROUPS},
+    {"red",            IndicatorStore::RED},
+    {"orange",         IndicatorStore::ORANGE},
+    {"yellow",         IndicatorStore::YELLOW},
+    {"green",          IndicatorStore::GREEN},
+    {"blue",           IndicatorStore::BLUE},
+};
+
+PYBIND11_MODULE(cadashboard, m) {
+    m.doc() = "California School Dashboard indicators as zero-copy NumPy columns";
+
+    m.attr("FIXED_POINT_SCALE") = IndicatorStore::FIXED_POINT_SCALE;
+
+    py::class_<IndicatorStore> store(m, "IndicatorStore");
+    store
+        .def("__len__", &IndicatorStore::size)
+        .def_property_readonly("cds", [](py::object self) {
+            return columnView(storeOf(self).cds(), self);
+        })
+        .def_property_readonly("count", [](py::object self) {
+            return columnView(storeOf(self).count(), self);
+        })
+        .def_property_readonly("is_private_data", [](py::object self) {
+            return columnView(storeOf(self).isPrivateData(), self);
+        })
+        .def_property_readonly("category_codes", [](py::object self) {
+            return columnView(storeOf(self).categoryCodes(), self);
+        })
+        .def_property_readonly("student_group_codes", [](py::object self) {
+            return columnView(storeOf(self).studentGroupCodes(), self);
+        })
+        .def_property_readonly("category_dictionary", &IndicatorStore::categoryDictionary)
+        .def_property_readonly("student_group_dictionary", &IndicatorStore::studentGroupDictionary)
+        .def("columns", [](py::object self) {
+            // Every column keyed by attribute name, all zero-copy.
+            const IndicatorStore& s = storeOf(self);
+            py::dict cols;
+            cols["cds"]                 = columnView(s.cds(), self);
+            cols["count"]               = columnView(s.count(), self);
+            cols["is_private_data"]     = columnView(s.isPrivateData(), self);
+            cols["category_codes"]      = columnView(s.categoryCodes(), self);
+            cols["student_group_codes"] = columnView(s.studentGroupCodes(), self);
+            for (const auto& [name, col] : INT_COLUMNS)
+                cols[name] = columnView(s.column(col), self);
+            return cols;
+        })
+        .def("save_encoded", [](const IndicatorStore& s, const std::string& path) {
+            if (!s.saveEncoded(path)) throw std::runtime_error("could not write " + path);
+        }, py::arg("path"));
+
+    for (const auto& [name, col] : INT_COLUMNS) {
+        const IndicatorStore::IntColumn c = col;
+        store.def_property_readonly(name, [c](py::object self) {
+            return columnView(storeOf(self).column(c), self);
+        });
+    }
+
+    m.def("load_encoded", [](const std::string& path) {
+        IndicatorStore s;
+        bool ok;
+        {
+            py::gil_scoped_release release;
+            ok = s.loadEncoded(path);
+        }
+        if (!ok) throw std::runtime_error("could not load " + path);
+        return s;
+    }, py::arg("path"), "Loads a file written by IndicatorStore.save_encoded.");
+
+    m.def("from_records", [](const std::vector<py::bytes>& records) {
+        IndicatorStore s;
+        for (const auto& r : records) {
+            char*      data = nullptr;
+            Py_ssize_t size = 0;
+            PyBytes_AsStringAndSize(r.ptr(), &data, &size);
+            CardRecordView view(data, static_cast<std::size_t>(size));
+            if (!view.valid()) throw std::runtime_error("invalid card record");
+            s.append(view);
+        }
+        return s;
+    }, py::arg("records"), "Builds a store from binary CardRecords without parsing JSON.");
+
+    m.def("join_csv", [](const IndicatorStore& indicators, const std::string& path,
+                         const std::string& cds_column, unsigned threads) {
+        CsvDataset    dataset;
+        CdsJoinResult joined;
+        bool ok;
+        {
+            py::gil_scoped_release release;
+            ok = dataset.load(path, cds_column) && CdsJoin(threads).run(indicators, dataset, joined);
+        }
+        if (!ok) throw std::runtime_error("could not join " + path);
+
+        // Numeric CSV columns become float64 arrays (NaN for "*" and blanks),
+        // the rest lists of str.
+        py::dict cols;
+        for (std::size_t c = 0; c < dataset.columnNames().size(); ++c) {
+            const std::string& name = dataset.columnNames()[c];
+            if (joined.isNumeric(c)) {
+                std::vector<double> values = joined.numericColumn(c);
+                cols[name.c_str()] = py::array_t<double>(values.size(), values.data());
+            } else {
+                py::list values(joined.size());
+                for (std::size_t r = 0; r < joined.size(); ++r)
+                    values[r] = py::str(joined.value(r, c).data(), joined.value(r, c).size());
+                cols[name.c_str()] = values;
+            }
+        }
+        return py::make_tuple(std::move(joined.indicators), cols);
+    }, py::arg("indicators"), py::arg("path"), py::arg("cds_column") = "", py::arg("threads") = 0,
+       "Inner-joins indicator rows with a CDE CSV file on CDS code. Returns "
+       "(IndicatorStore of matched rows, dict of the CSV's columns aligned to it).");
+
+    m.def("scan_partitioned", [](const std::string& path,
+                                 std::optional<int32_t> min_year_id,
+                                 std::optional<int32_t> max_year_id,
+                                 std::vector<int32_t> counties,
+                                 std::optional<int32_t> indicator_id,
+                                 std::optional<float> min_status,
+                                 std::optional<float> max_status) {
+        IndicatorFilter filter;
+        if (min_year_id) filter.minYearId = *min_year_id;
+        if (max_year_id) filter.maxYearId = *max_year_id;
+        filter.counties    = std::move(counties);
+        filter.indicatorId = indicator_id;
+        filter.minStatus   = min_status;
+        filter.maxStatus   = max_status;
+
+        IndicatorStore s;
+        bool ok;
+        {
+            py::gil_scoped_release release;
+            PartitionedStoreReader reader;
+            ok = reader.open(path) && reader.scan(filter, s);
+        }
+        if (!ok) throw std::runtime_error("could not scan " + path);
+        return s;
+    }, py::arg("path"),
+       py::arg("min_year_id")  = py::none(),
+       py::arg("max_year_id")  = py::none(),
+       py::arg("counties")     = std::vector<int32_t>{},
+       py::arg("indicator_id") = py::none(),
+       py::arg("min_status")   = py::none(),
+       py::arg("max_status")   = py::none(),
+       "Reads matching rows from a year-partitioned file, skipping pruned partitions.");
+
+    m.def("fetch", [](const std::vector<std::string>& urls, long timeout_ms,
+                      std::size_t pool_size, double max_requests_per_sec) {
+        IndicatorStore s;
+        // The whole fetch runs without the GIL so other Python threads
+        // keep running while workers wait on the network.
+        py::gil_scoped_release release;
+        CaliforniaDashboardAPI api(timeout_ms, pool_size, max_requests_per_sec);
+        if (!api.loadInURLs(urls))  throw std::runtime_error("no valid URLs to fetch");
+        if (!api.runFullURLFetch()) throw std::runtime_error("fetch failed");
+        s.append(api.allSummaryCardsVector);
+        return s;
+    }, py::arg("urls"),
+       py::arg("timeout_ms")           = CaliforniaDashboardAPI::DEFAULT_TIMEOUT_MS,
+       py::arg("pool_size")            = CaliforniaDashboardAPI::DEFAULT_POOL_SIZE,
+       py::arg("max_requests_per_sec") = CaliforniaDashboardAPI::DEFAULT_MAX_REQUESTS_PER_SEC,
+       "Fetches SummaryCards URLs concurrently and returns their indicators.");
+}
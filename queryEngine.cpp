@@ -0,0 +1,1205 @@
+#include "queryEngine.hh"
+#include "csvScanner.hh"
+#include "perfRegions.hh"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+static constexpr std::size_t BATCH_ROWS       = 1024;
+static constexpr uint32_t    NO_DIRECTORY_ROW = UINT32_MAX;
+
+static bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    return true;
+}
+
+// =============================================================================
+// QueryValue / QueryResult
+// =============================================================================
+
+std::string QueryValue::toString() const {
+    if (kind == NUL)  return "NULL";
+    if (kind == TEXT) return text;
+    char buf[32];
+    if (number == std::floor(number) && std::fabs(number) < 1e15)
+        snprintf(buf, sizeof(buf), "%.0f", number);
+    else
+        snprintf(buf, sizeof(buf), "%.6g", number);
+    return buf;
+}
+
+void QueryResult::print(std::ostream& out) const {
+    std::vector<std::vector<std::string>> cells(rows.size());
+    std::vector<std::size_t>              width(columns.size());
+    std::vector<bool>                     numeric(columns.size(), true);
+    for (std::size_t c = 0; c < columns.size(); ++c) width[c] = columns[c].size();
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            cells[r].push_back(rows[r][c].toString());
+            width[c] = std::max(width[c], cells[r][c].size());
+            if (rows[r][c].kind == QueryValue::TEXT) numeric[c] = false;
+        }
+    }
+
+    auto line = [&](const std::vector<std::string>& values, bool header) {
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            if (c) out << "  ";
+            if (numeric[c] && !header)         out << std::right << std::setw(static_cast<int>(width[c]));
+            else if (c + 1 < columns.size())   out << std::left << std::setw(static_cast<int>(width[c]));
+            out << values[c];
+        }
+        out << std::left << "\n";
+    };
+    line(columns, true);
+    for (std::size_t c = 0; c < columns.size(); ++c)
+        out << (c ? "  " : "") << std::string(width[c], '-');
+    out << "\n";
+    for (const auto& row : cells) line(row, false);
+    out << "(" << rows.size() << (rows.size() == 1 ? " row)" : " rows)") << "\n";
+}
+
+// =============================================================================
+// Columns
+// =============================================================================
+
+namespace {
+
+enum class Source { INT, CDS, COUNT, PRIVATE, COUNTY, CATEGORY, GROUP, DIRECTORY };
+
+struct ColumnRef {
+    Source      source = Source::INT;
+    int         index  = 0;   // IntColumn or SchoolDirectory::Column
+    double      scale  = 1;   // fixed-point divisor (status, change)
+    std::string name;
+
+    bool text() const {
+        return source == Source::CATEGORY || source == Source::GROUP || source == Source::DIRECTORY;
+    }
+    bool operator==(const ColumnRef& o) const {
+        return source == o.source &&
+               ((source != Source::INT && source != Source::DIRECTORY) || index == o.index);
+    }
+};
+
+struct StoreColumn {
+    const char* name;
+    Source      source;
+    int         index;
+    double      scale;
+};
+
+const StoreColumn STORE_COLUMNS[] = {
+    {"cds",             Source::CDS,      0,                             1},
+    {"school_year_id",  Source::INT,      IndicatorStore::SCHOOL_YEAR_ID, 1},
+    {"indicator_id",    Source::INT,      IndicatorStore::INDICATOR_ID,  1},
+    {"category",        Source::CATEGORY, 0,                             1},
+    {"student_group",   Source::GROUP,    0,                             1},
+    {"status",          Source::INT,      IndicatorStore::STATUS,        IndicatorStore::FIXED_POINT_SCALE},
+    {"change",          Source::INT,      IndicatorStore::CHANGE,        IndicatorStore::FIXED_POINT_SCALE},
+    {"change_id",       Source::INT,      IndicatorStore::CHANGE_ID,     1},
+    {"status_id",       Source::INT,      IndicatorStore::STATUS_ID,     1},
+    {"performance",     Source::INT,      IndicatorStore::PERFORMANCE,   1},
+    {"total_groups",    Source::INT,      IndicatorStore::TOTAL_GROUPS,  1},
+    {"red",             Source::INT,      IndicatorStore::RED,           1},
+    {"orange",          Source::INT,      IndicatorStore::ORANGE,        1},
+    {"yellow",          Source::INT,      IndicatorStore::YELLOW,        1},
+    {"green",           Source::INT,      IndicatorStore::GREEN,         1},
+    {"blue",            Source::INT,      IndicatorStore::BLUE,          1},
+    {"count",           Source::COUNT,    0,                             1},
+    {"is_private_data", Source::PRIVATE,  0,                             1},
+    {"county_code",     Source::COUNTY,   0,                             1},
+};
+
+// Key of a column in QueryEngine::indexes_, or -1 when it is not indexed.
+int indexKey(const ColumnRef& c) {
+    switch (c.source) {
+    case Source::INT:
+        if (c.index == IndicatorStore::SCHOOL_YEAR_ID) return 0;
+        if (c.index == IndicatorStore::INDICATOR_ID)   return 1;
+        return -1;
+    case Source::CATEGORY: return 2;
+    case Source::GROUP:    return 3;
+    case Source::COUNTY:   return 4;
+    default:               return -1;
+    }
+}
+
+// Everything a query reads rows from.
+struct Context {
+    const IndicatorStore&        store;
+    const SchoolDirectory*       directory;
+    const std::vector<uint32_t>& directoryRow;
+
+    std::string_view text(const ColumnRef& c, std::size_t row) const {
+        switch (c.source) {
+        case Source::CATEGORY: return store.category(row);
+        case Source::GROUP:    return store.studentGroup(row);
+        case Source::DIRECTORY: {
+            const uint32_t d = directoryRow[row];
+            return d == NO_DIRECTORY_ROW ? std::string_view()
+                                         : directory->get(d, static_cast<SchoolDirectory::Column>(c.index));
+        }
+        default: return std::string_view();
+        }
+    }
+
+    // NaN for text that is not a number.
+    double number(const ColumnRef& c, std::size_t row) const {
+        switch (c.source) {
+        case Source::INT:     return store.column(static_cast<IndicatorStore::IntColumn>(c.index))[row] / c.scale;
+        case Source::CDS:     return static_cast<double>(store.cds()[row]);
+        case Source::COUNT:   return static_cast<double>(store.count()[row]);
+        case Source::PRIVATE: return store.isPrivateData()[row];
+        case Source::COUNTY:  return countyOfCds(store.cds()[row]);
+        default: {
+            double v;
+            return CsvScanner::parseNumber(text(c, row), v) ? v : std::nan("");
+        }
+        }
+    }
+
+    // Whether the row has a value for `c`: integer columns always do, text
+    // columns (and schools missing from the directory) only when non-empty.
+    bool present(const ColumnRef& c, std::size_t row) const {
+        return !c.text() || !text(c, row).empty();
+    }
+
+    QueryValue value(const ColumnRef& c, std::size_t row) const {
+        return c.text() ? QueryValue::ofText(std::string(text(c, row))) : QueryValue::ofNumber(number(c, row));
+    }
+};
+
+// =============================================================================
+// Parser
+// =============================================================================
+
+enum class Op { EQ, NE, LT, LE, GT, GE };
+
+struct Condition {
+    enum Kind { COMPARE, IN, AND, OR, NOT };
+
+    Kind                    kind = COMPARE;
+    ColumnRef               column;
+    Op                      op = Op::EQ;
+    std::vector<QueryValue> values;     // one for COMPARE, the list for IN
+    std::vector<Condition>  children;   // AND, OR, NOT
+};
+
+enum class Aggregate { NONE, COUNT_ROWS, COUNT, SUM, AVG, MIN, MAX };
+
+struct SelectItem {
+    Aggregate   aggregate = Aggregate::NONE;
+    ColumnRef   column;
+    std::string label;
+};
+
+struct OrderKey {
+    std::size_t item;
+    bool        descending;
+};
+
+struct ParsedQuery {
+    std::vector<SelectItem>    items;
+    std::optional<Condition>   where;
+    std::vector<ColumnRef>     groupBy;
+    std::vector<OrderKey>      orderBy;
+    std::optional<std::size_t> limit;
+
+    bool aggregates() const {
+        if (!groupBy.empty()) return true;
+        for (const auto& item : items)
+            if (item.aggregate != Aggregate::NONE) return true;
+        return false;
+    }
+};
+
+struct Token {
+    enum Type { IDENT, QUOTED, STRING, NUMBER, SYMBOL, END };
+
+    Type        type = END;
+    std::string text;
+    double      number = 0;
+};
+
+class Parser {
+public:
+    Parser(const std::string& sql, const SchoolDirectory* directory) : directory_(directory) {
+        tokenize(sql);
+    }
+
+    ParsedQuery parse() {
+        ParsedQuery q;
+        expectKeyword("SELECT");
+        do {
+            if (peekSymbol("*")) {
+                next();
+                for (const auto& sc : STORE_COLUMNS) {
+                    SelectItem item;
+                    item.column = storeColumn(sc);
+                    item.label  = sc.name;
+                    q.items.push_back(item);
+                }
+            } else {
+                q.items.push_back(selectItem(true));
+            }
+        } while (acceptSymbol(","));
+
+        if (acceptKeyword("FROM")) {
+            Token t = next();
+            if (t.type != Token::IDENT || !(iequals(t.text, "indicators") || iequals(t.text, "cards")))
+                throw std::runtime_error("FROM takes 'indicators' (or 'cards'), not '" + t.text + "'");
+        }
+        if (acceptKeyword("WHERE")) q.where = orCondition();
+        if (acceptKeyword("GROUP")) {
+            expectKeyword("BY");
+            do q.groupBy.push_back(column()); while (acceptSymbol(","));
+        }
+        if (acceptKeyword("ORDER")) {
+            expectKeyword("BY");
+            do q.orderBy.push_back(orderKey(q)); while (acceptSymbol(","));
+        }
+        if (acceptKeyword("LIMIT")) {
+            Token t = next();
+            if (t.type != Token::NUMBER || t.number < 0 || t.number != std::floor(t.number))
+                throw std::runtime_error("LIMIT takes a whole number");
+            q.limit = static_cast<std::size_t>(t.number);
+        }
+        acceptSymbol(";");
+        if (peek().type != Token::END) throw std::runtime_error("unexpected '" + peek().text + "'");
+
+        if (q.aggregates()) {
+            for (const auto& item : q.items) {
+                if (item.aggregate != Aggregate::NONE) continue;
+                if (std::find(q.groupBy.begin(), q.groupBy.end(), item.column) == q.groupBy.end())
+                    throw std::runtime_error("'" + item.label + "' must appear in GROUP BY or inside an aggregate");
+            }
+        }
+        return q;
+    }
+
+private:
+    // ---- Tokens ----
+
+    void tokenize(const std::string& sql) {
+        std::size_t i = 0;
+        while (i < sql.size()) {
+            const char c = sql[i];
+            if (std::isspace(static_cast<unsigned char>(c))) { ++i; continue; }
+            Token t;
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                std::size_t j = i;
+                while (j < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[j])) || sql[j] == '_')) ++j;
+                t.type = Token::IDENT;
+                t.text = sql.substr(i, j - i);
+                i = j;
+            } else if (c == '"' || c == '\'') {
+                std::size_t j = i + 1;
+                for (;; ++j) {
+                    if (j >= sql.size()) throw std::runtime_error("unterminated quote");
+                    if (sql[j] == c) {
+                        if (j + 1 < sql.size() && sql[j + 1] == c) { t.text += c; ++j; continue; }
+                        break;
+                    }
+                    t.text += sql[j];
+                }
+                t.type = (c == '"') ? Token::QUOTED : Token::STRING;
+                i = j + 1;
+            } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.' ||
+                       (c == '-' && i + 1 < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[i + 1])) || sql[i + 1] == '.'))) {
+                std::size_t j = i + 1;
+                while (j < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[j])) || sql[j] == '.')) ++j;
+                t.type = Token::NUMBER;
+                t.text = sql.substr(i, j - i);
+                if (!CsvScanner::parseNumber(t.text, t.number)) throw std::runtime_error("bad number '" + t.text + "'");
+                i = j;
+            } else {
+                static const char* const TWO[] = {"<=", ">=", "!=", "<>"};
+                t.type = Token::SYMBOL;
+                t.text = std::string(1, c);
+                for (const char* two : TWO)
+                    if (sql.compare(i, 2, two) == 0) t.text = two;
+                if (std::string("=<>!(),*;").find(c) == std::string::npos)
+                    throw std::runtime_error(std::string("unexpected character '") + c + "'");
+                i += t.text.size();
+            }
+            tokens_.push_back(std::move(t));
+        }
+        tokens_.push_back(Token{});
+    }
+
+    const Token& peek(std::size_t ahead = 0) const {
+        return tokens_[std::min(pos_ + ahead, tokens_.size() - 1)];
+    }
+    Token next() {
+        Token t = peek();
+        if (pos_ < tokens_.size() - 1) ++pos_;
+        return t;
+    }
+    bool peekKeyword(const char* kw, std::size_t ahead = 0) const {
+        return peek(ahead).type == Token::IDENT && iequals(peek(ahead).text, kw);
+    }
+    bool acceptKeyword(const char* kw) {
+        if (!peekKeyword(kw)) return false;
+        next();
+        return true;
+    }
+    void expectKeyword(const char* kw) {
+        if (!acceptKeyword(kw))
+            throw std::runtime_error(std::string("expected ") + kw + " near '" + peek().text + "'");
+    }
+    bool peekSymbol(const char* s) const { return peek().type == Token::SYMBOL && peek().text == s; }
+    bool acceptSymbol(const char* s) {
+        if (!peekSymbol(s)) return false;
+        next();
+        return true;
+    }
+    void expectSymbol(const char* s) {
+        if (!acceptSymbol(s))
+            throw std::runtime_error(std::string("expected '") + s + "' near '" + peek().text + "'");
+    }
+
+    // ---- Grammar ----
+
+    static ColumnRef storeColumn(const StoreColumn& sc) {
+        ColumnRef c;
+        c.source = sc.source;
+        c.index  = sc.index;
+        c.scale  = sc.scale;
+        c.name   = sc.name;
+        return c;
+    }
+
+    ColumnRef column() {
+        Token t = next();
+        if (t.type != Token::IDENT && t.type != Token::QUOTED)
+            throw std::runtime_error("expected a column name near '" + t.text + "'");
+        for (const auto& sc : STORE_COLUMNS)
+            if (iequals(t.text, sc.name)) return storeColumn(sc);
+        for (int d = 0; d < SchoolDirectory::COLUMN_COUNT; ++d) {
+            const char* name = SchoolDirectory::columnName(static_cast<SchoolDirectory::Column>(d));
+            if (!iequals(t.text, name)) continue;
+            if (!directory_) throw std::runtime_error("column '" + t.text + "' needs the school directory");
+            ColumnRef c;
+            c.source = Source::DIRECTORY;
+            c.index  = d;
+            c.name   = name;
+            return c;
+        }
+        throw std::runtime_error("unknown column '" + t.text + "'");
+    }
+
+    SelectItem selectItem(bool allowAlias) {
+        static const std::pair<const char*, Aggregate> AGGREGATES[] = {
+            {"COUNT", Aggregate::COUNT}, {"SUM", Aggregate::SUM}, {"AVG", Aggregate::AVG},
+            {"MIN", Aggregate::MIN},     {"MAX", Aggregate::MAX},
+        };
+        SelectItem item;
+        for (const auto& [kw, agg] : AGGREGATES) {
+            if (!peekKeyword(kw) || peek(1).type != Token::SYMBOL || peek(1).text != "(") continue;
+            next();
+            next();
+            if (agg == Aggregate::COUNT && acceptSymbol("*")) {
+                item.aggregate = Aggregate::COUNT_ROWS;
+                item.label     = "COUNT(*)";
+            } else {
+                item.aggregate = agg;
+                item.column    = column();
+                if (agg != Aggregate::COUNT && item.column.source != Source::DIRECTORY && item.column.text())
+                    throw std::runtime_error(std::string(kw) + " needs a numeric column");
+                item.label = std::string(kw) + "(" + item.column.name + ")";
+            }
+            expectSymbol(")");
+            break;
+        }
+        if (item.label.empty()) {
+            item.column = column();
+            item.label  = item.column.name;
+        }
+        if (allowAlias && acceptKeyword("AS")) {
+            Token t = next();
+            if (t.type != Token::IDENT && t.type != Token::QUOTED)
+                throw std::runtime_error("expected a name after AS");
+            item.label = t.text;
+        }
+        return item;
+    }
+
+    OrderKey orderKey(const ParsedQuery& q) {
+        OrderKey key{0, false};
+        if (peek().type == Token::NUMBER) {
+            double n = next().number;
+            if (n < 1 || n > q.items.size() || n != std::floor(n))
+                throw std::runtime_error("ORDER BY position out of range");
+            key.item = static_cast<std::size_t>(n) - 1;
+        } else {
+            // An alias, or the same expression as a select item.
+            bool found = false;
+            if (peek().type == Token::IDENT || peek().type == Token::QUOTED) {
+                for (std::size_t i = 0; i < q.items.size() && !found; ++i)
+                    if (iequals(peek().text, q.items[i].label) && !(peek(1).type == Token::SYMBOL && peek(1).text == "(")) {
+                        key.item = i;
+                        found    = true;
+                        next();
+                    }
+            }
+            if (!found) {
+                SelectItem e = selectItem(false);
+                for (std::size_t i = 0; i < q.items.size() && !found; ++i)
+                    if (q.items[i].aggregate == e.aggregate && q.items[i].column == e.column) {
+                        key.item = i;
+                        found    = true;
+                    }
+                if (!found) throw std::runtime_error("ORDER BY '" + e.label + "' is not in the select list");
+            }
+        }
+        if (acceptKeyword("DESC"))     key.descending = true;
+        else                           acceptKeyword("ASC");
+        return key;
+    }
+
+    QueryValue literal(const ColumnRef& col) {
+        Token t = next();
+        QueryValue v;
+        if (t.type == Token::NUMBER)      v = QueryValue::ofNumber(t.number);
+        else if (t.type == Token::STRING) v = QueryValue::ofText(t.text);
+        else throw std::runtime_error("expected a literal near '" + t.text + "'");
+        if (!col.text() && v.kind == QueryValue::TEXT)
+            throw std::runtime_error("'" + col.name + "' is numeric; '" + t.text + "' is text");
+        return v;
+    }
+
+    Condition orCondition() {
+        Condition first = andCondition();
+        if (!peekKeyword("OR")) return first;
+        Condition c;
+        c.kind = Condition::OR;
+        c.children.push_back(std::move(first));
+        while (acceptKeyword("OR")) c.children.push_back(andCondition());
+        return c;
+    }
+
+    Condition andCondition() {
+        Condition first = notCondition();
+        if (!peekKeyword("AND")) return first;
+        Condition c;
+        c.kind = Condition::AND;
+        c.children.push_back(std::move(first));
+        while (acceptKeyword("AND")) c.children.push_back(notCondition());
+        return c;
+    }
+
+    Condition notCondition() {
+        if (acceptKeyword("NOT")) return negate(notCondition());
+        if (acceptSymbol("(")) {
+            Condition c = orCondition();
+            expectSymbol(")");
+            return c;
+        }
+        return predicate();
+    }
+
+    static Condition negate(Condition inner) {
+        Condition c;
+        c.kind = Condition::NOT;
+        c.children.push_back(std::move(inner));
+        return c;
+    }
+
+    Condition predicate() {
+        Condition c;
+        c.column = column();
+
+        const bool negated = acceptKeyword("NOT");
+        if (acceptKeyword("IN")) {
+            c.kind = Condition::IN;
+            expectSymbol("(");
+            do c.values.push_back(literal(c.column)); while (acceptSymbol(","));
+            expectSymbol(")");
+            return negated ? negate(std::move(c)) : c;
+        }
+        if (acceptKeyword("BETWEEN")) {
+            Condition lo = c, hi = c;
+            lo.op = Op::GE;
+            lo.values.push_back(literal(c.column));
+            expectKeyword("AND");
+            hi.op = Op::LE;
+            hi.values.push_back(literal(c.column));
+            Condition both;
+            both.kind = Condition::AND;
+            both.children.push_back(std::move(lo));
+            both.children.push_back(std::move(hi));
+            return negated ? negate(std::move(both)) : both;
+        }
+        if (negated) throw std::runtime_error("expected IN or BETWEEN after NOT");
+
+        static const std::pair<const char*, Op> OPS[] = {
+            {"=", Op::EQ}, {"!=", Op::NE}, {"<>", Op::NE}, {"<", Op::LT},
+            {"<=", Op::LE}, {">", Op::GT}, {">=", Op::GE},
+        };
+        Token t = next();
+        bool found = false;
+        for (const auto& [sym, op] : OPS)
+            if (t.type == Token::SYMBOL && t.text == sym) { c.op = op; found = true; }
+        if (!found) throw std::runtime_error("expected a comparison after '" + c.column.name + "'");
+        c.values.push_back(literal(c.column));
+        return c;
+    }
+
+    const SchoolDirectory* directory_;
+    std::vector<Token>     tokens_;
+    std::size_t            pos_ = 0;
+};
+
+// =============================================================================
+// Filters
+//
+// A filter narrows a selection vector of row numbers. `in` and `out` may be
+// the same buffer: rows are only ever dropped, so the write position never
+// passes the read position.
+// =============================================================================
+
+template <typename T>
+bool compare(T a, Op op, T b) {
+    switch (op) {
+    case Op::EQ: return a == b;
+    case Op::NE: return !(a == b);
+    case Op::LT: return a < b;
+    case Op::LE: return a <= b;
+    case Op::GT: return a > b;
+    case Op::GE: return a >= b;
+    }
+    return false;
+}
+
+// Whether a text value satisfies a COMPARE/IN condition. Against a number
+// the text must parse as one; anything else never matches.
+bool textMatches(std::string_view v, const Condition& c) {
+    auto one = [&v](Op op, const QueryValue& lit) {
+        if (lit.kind == QueryValue::TEXT) return compare(v, op, std::string_view(lit.text));
+        double d;
+        return CsvScanner::parseNumber(v, d) && compare(d, op, lit.number);
+    };
+    if (c.kind == Condition::COMPARE) return one(c.op, c.values[0]);
+    for (const auto& lit : c.values)
+        if (one(Op::EQ, lit)) return true;
+    return false;
+}
+
+class Filter {
+public:
+    virtual ~Filter() = default;
+    virtual std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const = 0;
+};
+
+// Numeric column against constants, in the column's own units (status and
+// change stay fixed-point).
+template <typename T>
+class NumericFilter : public Filter {
+public:
+    NumericFilter(const T* column, const Condition& c, double scale) : column_(column), op_(c.op) {
+        in_ = (c.kind == Condition::IN);
+        for (const auto& v : c.values) {
+            double k = v.number * scale;
+            if (std::fabs(k - std::round(k)) < 1e-6) k = std::round(k);   // 12.3 -> exactly 12300
+            constants_.push_back(k);
+        }
+    }
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        if (in_) {
+            std::size_t k = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const uint32_t r = in[i];
+                const double   v = static_cast<double>(column_[r]);
+                bool hit = false;
+                for (double c : constants_) hit |= (v == c);
+                out[k] = r;
+                k += hit;
+            }
+            return k;
+        }
+        switch (op_) {
+        case Op::EQ: return select(in, n, out, [](double v, double c) { return v == c; });
+        case Op::NE: return select(in, n, out, [](double v, double c) { return v != c; });
+        case Op::LT: return select(in, n, out, [](double v, double c) { return v < c; });
+        case Op::LE: return select(in, n, out, [](double v, double c) { return v <= c; });
+        case Op::GT: return select(in, n, out, [](double v, double c) { return v > c; });
+        case Op::GE: return select(in, n, out, [](double v, double c) { return v >= c; });
+        }
+        return 0;
+    }
+
+private:
+    template <typename Cmp>
+    std::size_t select(const uint32_t* in, std::size_t n, uint32_t* out, Cmp cmp) const {
+        const double c = constants_[0];
+        std::size_t  k = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint32_t r = in[i];
+            out[k] = r;
+            k += cmp(static_cast<double>(column_[r]), c);
+        }
+        return k;
+    }
+
+    const T*            column_;
+    Op                  op_;
+    bool                in_ = false;
+    std::vector<double> constants_;
+};
+
+// Dictionary-coded store column: the condition was evaluated once per code.
+class CodeFilter : public Filter {
+public:
+    CodeFilter(const uint32_t* codes, std::vector<uint8_t> match)
+        : codes_(codes), match_(std::move(match)) {}
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint32_t r = in[i];
+            out[k] = r;
+            k += match_[codes_[r]];
+        }
+        return k;
+    }
+
+private:
+    const uint32_t*      codes_;
+    std::vector<uint8_t> match_;
+};
+
+// Dictionary directory column, reached through the store row's directory
+// row. The last entry of `match` stands for schools not in the directory.
+class DirectoryCodeFilter : public Filter {
+public:
+    DirectoryCodeFilter(const Context& ctx, SchoolDirectory::Column column, std::vector<uint8_t> match)
+        : ctx_(ctx), column_(column), match_(std::move(match)) {}
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        const uint8_t missing = match_.back();
+        std::size_t   k       = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint32_t r = in[i];
+            const uint32_t d = ctx_.directoryRow[r];
+            out[k] = r;
+            k += (d == NO_DIRECTORY_ROW) ? missing : match_[ctx_.directory->code(d, column_)];
+        }
+        return k;
+    }
+
+private:
+    Context                 ctx_;
+    SchoolDirectory::Column column_;
+    std::vector<uint8_t>    match_;
+};
+
+// Anything else (county code, free-text directory columns): row at a time.
+class RowFilter : public Filter {
+public:
+    RowFilter(const Context& ctx, const Condition& c) : ctx_(ctx), c_(c) {}
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint32_t r = in[i];
+            bool hit;
+            if (c_.column.text()) {
+                hit = textMatches(ctx_.text(c_.column, r), c_);
+            } else {
+                const double v = ctx_.number(c_.column, r);
+                hit = false;
+                if (c_.kind == Condition::COMPARE) hit = compare(v, c_.op, c_.values[0].number);
+                else for (const auto& lit : c_.values) hit |= (v == lit.number);
+            }
+            out[k] = r;
+            k += hit;
+        }
+        return k;
+    }
+
+private:
+    Context   ctx_;
+    Condition c_;
+};
+
+class AndFilter : public Filter {
+public:
+    explicit AndFilter(std::vector<std::unique_ptr<Filter>> children) : children_(std::move(children)) {}
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        for (const auto& child : children_) {
+            n  = child->apply(in, n, out);
+            in = out;
+            if (n == 0) break;
+        }
+        return n;
+    }
+
+private:
+    std::vector<std::unique_ptr<Filter>> children_;
+};
+
+class OrFilter : public Filter {
+public:
+    explicit OrFilter(std::vector<std::unique_ptr<Filter>> children)
+        : children_(std::move(children)), rest_(BATCH_ROWS), hits_(BATCH_ROWS), merged_(BATCH_ROWS) {}
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        // Each child only sees the rows no earlier child matched.
+        std::copy(in, in + n, rest_.begin());
+        std::size_t restN = n, matched = 0;
+        for (const auto& child : children_) {
+            if (restN == 0) break;
+            const std::size_t h = child->apply(rest_.data(), restN, hits_.data());
+            auto end = std::set_union(merged_.begin(), merged_.begin() + matched,
+                                      hits_.begin(), hits_.begin() + h, out);
+            matched = static_cast<std::size_t>(end - out);
+            std::copy(out, out + matched, merged_.begin());
+            restN = static_cast<std::size_t>(
+                std::set_difference(rest_.begin(), rest_.begin() + restN,
+                                    hits_.begin(), hits_.begin() + h, rest_.begin()) - rest_.begin());
+        }
+        std::copy(merged_.begin(), merged_.begin() + matched, out);
+        return matched;
+    }
+
+private:
+    std::vector<std::unique_ptr<Filter>> children_;
+    mutable std::vector<uint32_t>        rest_, hits_, merged_;
+};
+
+class NotFilter : public Filter {
+public:
+    explicit NotFilter(std::unique_ptr<Filter> child)
+        : child_(std::move(child)), hits_(BATCH_ROWS), rest_(BATCH_ROWS) {}
+
+    std::size_t apply(const uint32_t* in, std::size_t n, uint32_t* out) const override {
+        const std::size_t h    = child_->apply(in, n, hits_.data());
+        const std::size_t kept = static_cast<std::size_t>(
+            std::set_difference(in, in + n, hits_.begin(), hits_.begin() + h, rest_.begin()) - rest_.begin());
+        std::copy(rest_.begin(), rest_.begin() + kept, out);
+        return kept;
+    }
+
+private:
+    std::unique_ptr<Filter>       child_;
+    mutable std::vector<uint32_t> hits_, rest_;
+};
+
+std::unique_ptr<Filter> compile(const Condition& c, const Context& ctx) {
+    switch (c.kind) {
+    case Condition::AND:
+    case Condition::OR: {
+        std::vector<std::unique_ptr<Filter>> children;
+        for (const auto& child : c.children) children.push_back(compile(child, ctx));
+        if (c.kind == Condition::AND) return std::make_unique<AndFilter>(std::move(children));
+        return std::make_unique<OrFilter>(std::move(children));
+    }
+    case Condition::NOT:
+        return std::make_unique<NotFilter>(compile(c.children[0], ctx));
+    default:
+        break;
+    }
+
+    const ColumnRef& col = c.column;
+    switch (col.source) {
+    case Source::INT:
+        return std::make_unique<NumericFilter<int32_t>>(
+            ctx.store.column(static_cast<IndicatorStore::IntColumn>(col.index)).data(), c, col.scale);
+    case Source::CDS:     return std::make_unique<NumericFilter<uint64_t>>(ctx.store.cds().data(), c, 1);
+    case Source::COUNT:   return std::make_unique<NumericFilter<int64_t>>(ctx.store.count().data(), c, 1);
+    case Source::PRIVATE: return std::make_unique<NumericFilter<uint8_t>>(ctx.store.isPrivateData().data(), c, 1);
+    case Source::CATEGORY:
+    case Source::GROUP: {
+        const bool cat = col.source == Source::CATEGORY;
+        const auto& dict = cat ? ctx.store.categoryDictionary() : ctx.store.studentGroupDictionary();
+        std::vector<uint8_t> match(dict.size());
+        for (std::size_t i = 0; i < dict.size(); ++i) match[i] = textMatches(dict[i], c);
+        return std::make_unique<CodeFilter>(
+            cat ? ctx.store.categoryCodes().data() : ctx.store.studentGroupCodes().data(), std::move(match));
+    }
+    case Source::DIRECTORY: {
+        const auto dc = static_cast<SchoolDirectory::Column>(col.index);
+        if (ctx.directory->isDictionary(dc)) {
+            std::vector<uint8_t> match(ctx.directory->dictionarySize(dc) + 1);
+            for (std::size_t i = 0; i + 1 < match.size(); ++i)
+                match[i] = textMatches(ctx.directory->dictionaryValue(dc, i), c);
+            match.back() = textMatches(std::string_view(), c);
+            return std::make_unique<DirectoryCodeFilter>(ctx, dc, std::move(match));
+        }
+        return std::make_unique<RowFilter>(ctx, c);
+    }
+    default:
+        return std::make_unique<RowFilter>(ctx, c);
+    }
+}
+
+// Conditions every result row must satisfy: the top-level AND chain.
+void conjuncts(const Condition& c, std::vector<const Condition*>& out) {
+    if (c.kind == Condition::AND)
+        for (const auto& child : c.children) conjuncts(child, out);
+    else
+        out.push_back(&c);
+}
+
+// =============================================================================
+// Aggregation
+// =============================================================================
+
+struct Accumulator {
+    std::size_t rows  = 0;   // rows seen
+    std::size_t count = 0;   // numeric values seen; for COUNT(column), values present
+    double      sum   = 0;
+    double      min   = HUGE_VAL;
+    double      max   = -HUGE_VAL;
+
+    void add(double v) {
+        ++rows;
+        if (std::isnan(v)) return;
+        ++count;
+        sum += v;
+        min = std::min(min, v);
+        max = std::max(max, v);
+    }
+
+    QueryValue result(Aggregate a) const {
+        switch (a) {
+        case Aggregate::COUNT_ROWS: return QueryValue::ofNumber(static_cast<double>(rows));
+        case Aggregate::COUNT:      return QueryValue::ofNumber(static_cast<double>(count));
+        case Aggregate::SUM:   return count ? QueryValue::ofNumber(sum) : QueryValue();
+        case Aggregate::AVG:   return count ? QueryValue::ofNumber(sum / count) : QueryValue();
+        case Aggregate::MIN:   return count ? QueryValue::ofNumber(min) : QueryValue();
+        case Aggregate::MAX:   return count ? QueryValue::ofNumber(max) : QueryValue();
+        default:               return QueryValue();
+        }
+    }
+};
+
+// Orders NULL before numbers before text.
+bool lessValue(const QueryValue& a, const QueryValue& b) {
+    if (a.kind != b.kind) return a.kind < b.kind;
+    if (a.kind == QueryValue::NUMBER) return a.number < b.number;
+    if (a.kind == QueryValue::TEXT)   return a.text < b.text;
+    return false;
+}
+
+// Group key part for one column: integer columns by value, dictionary
+// columns by code, free text through a per-query intern table.
+class GroupKeyer {
+public:
+    GroupKeyer(const Context& ctx, const ColumnRef& col) : ctx_(ctx), col_(col) {}
+
+    int64_t key(std::size_t row) {
+        switch (col_.source) {
+        case Source::INT:      return ctx_.store.column(static_cast<IndicatorStore::IntColumn>(col_.index))[row];
+        case Source::CDS:      return static_cast<int64_t>(ctx_.store.cds()[row]);
+        case Source::COUNT:    return ctx_.store.count()[row];
+        case Source::PRIVATE:  return ctx_.store.isPrivateData()[row];
+        case Source::COUNTY:   return countyOfCds(ctx_.store.cds()[row]);
+        case Source::CATEGORY: return ctx_.store.categoryCodes()[row];
+        case Source::GROUP:    return ctx_.store.studentGroupCodes()[row];
+        case Source::DIRECTORY: {
+            const auto     dc = static_cast<SchoolDirectory::Column>(col_.index);
+            const uint32_t d  = ctx_.directoryRow[row];
+            if (d == NO_DIRECTORY_ROW) return -1;
+            if (ctx_.directory->isDictionary(dc)) return ctx_.directory->code(d, dc);
+            auto [it, inserted] = intern_.try_emplace(ctx_.directory->get(d, dc),
+                                                      static_cast<int64_t>(intern_.size()));
+            return it->second;
+        }
+        }
+        return 0;
+    }
+
+private:
+    Context                                        ctx_;
+    ColumnRef                                      col_;
+    std::unordered_map<std::string_view, int64_t>  intern_;
+};
+
+} // namespace
+
+// =============================================================================
+// QueryEngine
+// =============================================================================
+
+QueryEngine::QueryEngine(const SchoolDirectory* directory) : directory_(directory) {}
+
+void QueryEngine::attach(const IndicatorStore& store) {
+    PerfRegion region("query_attach");
+    store_ = &store;
+    const std::size_t rows = store.size();
+
+    directoryRow_.assign(directory_ ? rows : 0, NO_DIRECTORY_ROW);
+    if (directory_) {
+        uint64_t lastCds = 0;
+        uint32_t lastRow = NO_DIRECTORY_ROW;
+        for (std::size_t r = 0; r < rows; ++r) {
+            const uint64_t cds = store.cds()[r];
+            if (r == 0 || cds != lastCds) {
+                const std::size_t d = directory_->find(cds);
+                lastCds = cds;
+                lastRow = (d == SchoolDirectory::npos) ? NO_DIRECTORY_ROW : static_cast<uint32_t>(d);
+            }
+            directoryRow_[r] = lastRow;
+        }
+    }
+
+    // Bitmap indexes (see indexKey).
+    indexes_.clear();
+    auto build = [this, rows](int key, auto valueOf) {
+        auto& index = indexes_[key];
+        for (std::size_t r = 0; r < rows; ++r) {
+            auto [it, inserted] = index.try_emplace(valueOf(r));
+            if (inserted) it->second.resize(rows);
+            it->second.set(r);
+        }
+    };
+    const auto& years      = store.column(IndicatorStore::SCHOOL_YEAR_ID);
+    const auto& indicators = store.column(IndicatorStore::INDICATOR_ID);
+    build(0, [&](std::size_t r) { return static_cast<int64_t>(years[r]); });
+    build(1, [&](std::size_t r) { return static_cast<int64_t>(indicators[r]); });
+    build(2, [&](std::size_t r) { return static_cast<int64_t>(store.categoryCodes()[r]); });
+    build(3, [&](std::size_t r) { return static_cast<int64_t>(store.studentGroupCodes()[r]); });
+    build(4, [&](std::size_t r) { return static_cast<int64_t>(countyOfCds(store.cds()[r])); });
+}
+
+bool QueryEngine::run(const std::string& sql, QueryResult& out) const {
+    PerfRegion region("query_run");
+    out = QueryResult();
+    if (!store_) {
+        std::cerr << "Error: query run with no store attached" << std::endl;
+        return false;
+    }
+    const IndicatorStore& store = *store_;
+    const Context         ctx{store, directory_, directoryRow_};
+
+    ParsedQuery q;
+    std::unique_ptr<Filter> filter;
+    try {
+        q = Parser(sql, directory_).parse();
+        if (q.where) filter = compile(*q.where, ctx);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: query: " << e.what() << std::endl;
+        return false;
+    }
+    for (const auto& item : q.items) out.columns.push_back(item.label);
+
+    // Candidate rows from the bitmap indexes: every equality/IN conjunct on
+    // an indexed column narrows them.
+    const std::size_t     rows  = store.size();
+    const std::size_t     words = (rows + 63) / 64;
+    std::vector<uint64_t> candidates;
+    if (q.where) {
+        std::vector<const Condition*> terms;
+        conjuncts(*q.where, terms);
+        for (const Condition* t : terms) {
+            const int key = indexKey(t->column);
+            if (key < 0 || (t->kind != Condition::IN && !(t->kind == Condition::COMPARE && t->op == Op::EQ)))
+                continue;
+            const auto& index = indexes_.at(key);
+            std::vector<uint64_t> hit(words, 0);
+            for (const auto& lit : t->values) {
+                int64_t value;
+                if (t->column.text()) {
+                    const auto& dict = (t->column.source == Source::CATEGORY) ? store.categoryDictionary()
+                                                                               : store.studentGroupDictionary();
+                    auto it = std::find(dict.begin(), dict.end(), lit.text);
+                    if (lit.kind != QueryValue::TEXT || it == dict.end()) continue;
+                    value = it - dict.begin();
+                } else {
+                    if (lit.number != std::floor(lit.number)) continue;
+                    value = static_cast<int64_t>(lit.number);
+                }
+                auto it = index.find(value);
+                if (it == index.end()) continue;
+                for (std::size_t w = 0; w < words; ++w) hit[w] |= it->second.words()[w];
+            }
+            if (candidates.empty()) candidates = std::move(hit);
+            else for (std::size_t w = 0; w < words; ++w) candidates[w] &= hit[w];
+        }
+    }
+    const bool useCandidates = !candidates.empty();
+
+    // Batches: candidates -> selection vector -> filter -> consumer.
+    const bool aggregate     = q.aggregates();
+    const bool stopAtLimit   = !aggregate && q.orderBy.empty() && q.limit;
+    std::vector<uint32_t> selection(BATCH_ROWS);
+    std::vector<uint32_t> matched;                 // projection: matching rows
+
+    std::vector<GroupKeyer>                      keyers;
+    for (const auto& col : q.groupBy) keyers.emplace_back(ctx, col);
+    std::unordered_map<std::string, uint32_t>    groupIndex;
+    std::vector<uint32_t>                        groupRow;      // representative row
+    std::vector<std::vector<Accumulator>>        accumulators;  // [group][item]
+    std::string                                  key;
+    std::vector<uint32_t>                        groupOf(BATCH_ROWS);
+    if (aggregate && q.groupBy.empty()) {
+        // One group, reported even when nothing matches.
+        groupIndex.emplace(std::string(), 0);
+        groupRow.push_back(NO_DIRECTORY_ROW);
+        accumulators.emplace_back(q.items.size());
+    }
+
+    for (std::size_t base = 0; base < rows; base += BATCH_ROWS) {
+        const std::size_t end = std::min(rows, base + BATCH_ROWS);
+        std::size_t n = 0;
+        if (useCandidates) {
+            for (std::size_t w = base / 64; w < (end + 63) / 64; ++w)
+                for (uint64_t m = candidates[w]; m; m &= m - 1)
+                    selection[n++] = static_cast<uint32_t>(w * 64 + __builtin_ctzll(m));
+        } else {
+            for (std::size_t r = base; r < end; ++r) selection[n++] = static_cast<uint32_t>(r);
+        }
+        if (n == 0) continue;
+        out.rowsScanned += n;
+        if (filter) n = filter->apply(selection.data(), n, selection.data());
+        if (n == 0) continue;
+
+        if (!aggregate) {
+            matched.insert(matched.end(), selection.begin(), selection.begin() + n);
+            if (stopAtLimit && matched.size() >= *q.limit) break;
+            continue;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            key.clear();
+            for (auto& keyer : keyers) {
+                const int64_t part = keyer.key(selection[i]);
+                key.append(reinterpret_cast<const char*>(&part), sizeof(part));
+            }
+            auto [it, inserted] = groupIndex.try_emplace(key, static_cast<uint32_t>(groupRow.size()));
+            if (inserted) {
+                groupRow.push_back(selection[i]);
+                accumulators.emplace_back(q.items.size());
+            }
+            groupOf[i] = it->second;
+        }
+        for (std::size_t item = 0; item < q.items.size(); ++item) {
+            const SelectItem& si = q.items[item];
+            if (si.aggregate == Aggregate::NONE) continue;
+            if (si.aggregate == Aggregate::COUNT_ROWS) {
+                for (std::size_t i = 0; i < n; ++i) ++accumulators[groupOf[i]][item].rows;
+                continue;
+            }
+            if (si.aggregate == Aggregate::COUNT) {
+                for (std::size_t i = 0; i < n; ++i)
+                    if (ctx.present(si.column, selection[i])) ++accumulators[groupOf[i]][item].count;
+                continue;
+            }
+            for (std::size_t i = 0; i < n; ++i)
+                accumulators[groupOf[i]][item].add(ctx.number(si.column, selection[i]));
+        }
+    }
+
+    // Materialise.
+    if (aggregate) {
+        for (std::size_t g = 0; g < groupRow.size(); ++g) {
+            std::vector<QueryValue> row;
+            for (std::size_t item = 0; item < q.items.size(); ++item) {
+                const SelectItem& si = q.items[item];
+                if (si.aggregate != Aggregate::NONE) row.push_back(accumulators[g][item].result(si.aggregate));
+                else if (groupRow[g] == NO_DIRECTORY_ROW) row.emplace_back();
+                else row.push_back(ctx.value(si.column, groupRow[g]));
+            }
+            out.rows.push_back(std::move(row));
+        }
+    } else {
+        if (stopAtLimit && matched.size() > *q.limit) matched.resize(*q.limit);
+        out.rows.reserve(matched.size());
+        for (uint32_t r : matched) {
+            std::vector<QueryValue> row;
+            row.reserve(q.items.size());
+            for (const auto& si : q.items) row.push_back(ctx.value(si.column, r));
+            out.rows.push_back(std::move(row));
+        }
+    }
+
+    if (!q.orderBy.empty()) {
+        auto less = [&q](const std::vector<QueryValue>& a, const std::vector<QueryValue>& b) {
+            for (const auto& k : q.orderBy) {
+                if (lessValue(a[k.item], b[k.item])) return !k.descending;
+                if (lessValue(b[k.item], a[k.item])) return k.descending;
+            }
+            return false;
+        };
+        if (q.limit && *q.limit < out.rows.size()) {
+            std::partial_sort(out.rows.begin(), out.rows.begin() + *q.limit, out.rows.end(), less);
+        } else {
+            std::stable_sort(out.rows.begin(), out.rows.end(), less);
+        }
+    }
+    if (q.limit && out.rows.size() > *q.limit) out.rows.resize(*q.limit);
+    return true;
+}
+
+bool QueryEngine::run(const std::string& sql, PartitionedStoreReader& reader, QueryResult& out) const {
+    ParsedQuery q;
+    try {
+        q = Parser(sql, directory_).parse();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: query: " << e.what() << std::endl;
+        return false;
+    }
+
+    // Translate the conjuncts the partition directory understands into a
+    // filter. Bounds are inclusive, so strict comparisons over-select and
+    // the row-level WHERE makes the final cut.
+    IndicatorFilter f;
+    if (q.where) {
+        std::vector<const Condition*> terms;
+        conjuncts(*q.where, terms);
+        for (const Condition* t : terms) {
+            if (t->kind != Condition::COMPARE && t->kind != Condition::IN) continue;
+            if (t->kind == Condition::COMPARE && t->op == Op::NE) continue;
+            double lo = HUGE_VAL, hi = -HUGE_VAL;
+            for (const auto& v : t->values) {
+                lo = std::min(lo, v.number);
+                hi = std::max(hi, v.number);
+            }
+            const bool lower = t->kind == Condition::IN || t->op == Op::EQ || t->op == Op::GT || t->op == Op::GE;
+            const bool upper = t->kind == Condition::IN || t->op == Op::EQ || t->op == Op::LT || t->op == Op::LE;
+            const ColumnRef& col = t->column;
+
+            if (col.source == Source::INT && col.index == IndicatorStore::SCHOOL_YEAR_ID) {
+                if (lower) f.minYearId = std::max(f.minYearId, static_cast<int32_t>(std::floor(lo)));
+                if (upper) f.maxYearId = std::min(f.maxYearId, static_cast<int32_t>(std::ceil(hi)));
+            } else if (col.source == Source::INT && col.index == IndicatorStore::INDICATOR_ID) {
+                if (t->kind == Condition::COMPARE && t->op == Op::EQ) f.indicatorId = static_cast<int32_t>(lo);
+            } else if (col.source == Source::INT && col.index == IndicatorStore::STATUS) {
+                if (lower) f.minStatus = std::max(f.minStatus.value_or(-HUGE_VALF), static_cast<float>(lo));
+                if (upper) f.maxStatus = std::min(f.maxStatus.value_or(HUGE_VALF), static_cast<float>(hi));
+            } else if (col.source == Source::INT && col.index == IndicatorStore::PERFORMANCE) {
+                if (lower) f.minPerformance = std::max(f.minPerformance.value_or(INT32_MIN), static_cast<int32_t>(std::floor(lo)));
+                if (upper) f.maxPerformance = std::min(f.maxPerformance.value_or(INT32_MAX), static_cast<int32_t>(std::ceil(hi)));
+            } else if ((col.source == Source::COUNTY || col.source == Source::CDS) && f.counties.empty() &&
+                       (t->kind == Condition::IN || t->op == Op::EQ)) {
+                for (const auto& v : t->values)
+                    f.counties.push_back(col.source == Source::COUNTY ? static_cast<int32_t>(v.number)
+                                                                      : countyOfCds(static_cast<uint64_t>(v.number)));
+            }
+        }
+    }
+
+    IndicatorStore     scanned;
+    PartitionScanStats stats;
+    if (!reader.scan(f, scanned, &stats)) return false;
+
+    QueryEngine local(directory_);
+    local.attach(scanned);
+    if (!local.run(sql, out)) return false;
+    out.partitions = stats;
+    return true;
+}
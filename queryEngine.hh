@@ -0,0 +1,95 @@
+#ifndef QUERYENGINE_H
+#define QUERYENGINE_H
+
+#include "indicatorAnalytics.hh"
+#include "indicatorStore.hh"
+#include "partitionedStore.hh"
+#include "schoolDirectory.hh"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// QueryEngine — a small SQL dialect over the columnar indicator store.
+//
+//   SELECT item, ...  [FROM indicators]
+//   [WHERE condition]  [GROUP BY column, ...]
+//   [ORDER BY item [ASC|DESC], ...]  [LIMIT n]
+//
+//   item       column | * | COUNT(*) | COUNT|SUM|AVG|MIN|MAX(column)  [AS alias]
+//   condition  column op literal | column [NOT] IN (literal, ...)
+//              | column BETWEEN literal AND literal
+//              | condition AND|OR condition | NOT condition | (condition)
+//   op         = != <> < <= > >=
+//
+// Columns are the store's (cds, school_year_id, indicator_id, category,
+// student_group, status, change, change_id, status_id, performance,
+// total_groups, red .. blue, count, is_private_data, county_code) plus, when
+// a SchoolDirectory is supplied, every pubschls.csv column by its header name
+// (County, School, Charter, Latitude...), joined on CDS. Names are
+// case-insensitive; "double quotes" quote a name, 'single quotes' a string.
+//
+// Execution is batch-at-a-time: each batch of 1024 rows becomes a selection
+// vector that every predicate narrows in one tight loop over its column.
+// Predicates on dictionary columns (category, student group, low-cardinality
+// directory columns) are resolved once per dictionary entry, so rows are
+// tested by code. attach() also builds bitmap indexes over year, indicator,
+// category, student group and county; equality and IN conditions that must
+// hold for every row select candidate rows from them, and batches without a
+// candidate are never touched. Against a partitioned file the same
+// conditions (plus status and performance ranges) prune partitions first.
+// =============================================================================
+
+struct QueryValue {
+    enum Kind { NUL, NUMBER, TEXT };
+
+    Kind        kind   = NUL;
+    double      number = 0;
+    std::string text;
+
+    static QueryValue ofNumber(double v)       { QueryValue q; q.kind = NUMBER; q.number = v; return q; }
+    static QueryValue ofText(std::string v)    { QueryValue q; q.kind = TEXT; q.text = std::move(v); return q; }
+
+    std::string toString() const;
+};
+
+struct QueryResult {
+    std::vector<std::string>             columns;
+    std::vector<std::vector<QueryValue>> rows;
+    std::size_t        rowsScanned = 0;   // rows that reached the batch engine
+    PartitionScanStats partitions;        // partitioned-file queries only
+
+    // Aligned text table, one line per row.
+    void print(std::ostream& out) const;
+};
+
+class QueryEngine {
+public:
+    // `directory` may be null; queries naming directory columns then fail.
+    explicit QueryEngine(const SchoolDirectory* directory = nullptr);
+
+    // Indexes `store` for repeated queries. The store (and directory) must
+    // stay unchanged and alive while attached.
+    void attach(const IndicatorStore& store);
+
+    // Runs a query against the attached store. Parse and name errors are
+    // reported on stderr.
+    bool run(const std::string& sql, QueryResult& out) const;
+
+    // One-off query against a partitioned file; only partitions that can
+    // hold matching rows are decoded.
+    bool run(const std::string& sql, PartitionedStoreReader& reader, QueryResult& out) const;
+
+private:
+    const SchoolDirectory* directory_ = nullptr;
+    const IndicatorStore*  store_     = nullptr;
+    std::vector<uint32_t>  directoryRow_;   // per store row; UINT32_MAX = not in directory
+    // Bitmap index per indexed column: value (dictionary code for text
+    // columns) -> rows holding it.
+    std::map<int, std::map<int64_t, ValidityBitmap>> indexes_;
+};
+
+#endif // QUERYENGINE_H
@@ -0,0 +1,39 @@
+#include "rateLimiter.hh"
+#include <algorithm>
+
+RateLimiter::RateLimiter(double max_requests_per_sec)
+    : max_requests_per_sec_(max_requests_per_sec),
+      capacity_(std::max(1.0, max_requests_per_sec)),
+      tokens_(capacity_)
+{
+    clock_gettime(CLOCK_MONOTONIC, &last_refill_);
+}
+
+void RateLimiter::acquire()
+{
+    // If unlimited, return immediately — zero overhead on the hot path.
+    if (max_requests_per_sec_ >= UNLIMITED) return;
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (true) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        double elapsed = (now.tv_sec  - last_refill_.tv_sec) +
+                         (now.tv_nsec - last_refill_.tv_nsec) / 1e9;
+
+        tokens_ += elapsed * max_requests_per_sec_;
+        if (tokens_ > capacity_)
+            tokens_ = capacity_;
+        last_refill_ = now;
+
+        if (tokens_ >= 1.0) { tokens_ -= 1.0; return; }
+
+        double wait_sec = (1.0 - tokens_) / max_requests_per_sec_;
+        long   wait_ns  = static_cast<long>(wait_sec * 1e9);
+        struct timespec ts = { wait_ns / 1'000'000'000L, wait_ns % 1'000'000'000L };
+        lk.unlock();
+        nanosleep(&ts, nullptr);
+        lk.lock();
+    }
+}
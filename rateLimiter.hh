@@ -0,0 +1,35 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <mutex>
+#include <time.h>
+
+// =============================================================================
+// RateLimiter — global token bucket.
+//
+// Holds up to one second's worth of tokens (at least one, so rates below
+// one request a second still pass) and refills continuously.
+// acquire() blocks until a token is available. One limiter can be shared by
+// every component that talks to the upstream API (fetch pool, proxy) so the
+// host as a whole stays under the configured rate.
+// =============================================================================
+
+class RateLimiter {
+public:
+    // Rates at or above this are treated as unlimited.
+    static constexpr double UNLIMITED = 1000.0;
+
+    explicit RateLimiter(double max_requests_per_sec = UNLIMITED);
+
+    void   acquire();
+    double rate() const { return max_requests_per_sec_; }
+
+private:
+    double          max_requests_per_sec_;
+    double          capacity_;
+    double          tokens_;
+    struct timespec last_refill_;
+    std::mutex      mtx_;
+};
+
+#endif // RATELIMITER_H
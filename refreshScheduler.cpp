@@ -0,0 +1,195 @@
+#include "refreshScheduler.hh"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static constexpr int64_t HOUR_SECONDS = 3600;
+
+RefreshScheduler::RefreshScheduler(std::size_t hourlyBudget)
+    : hourly_budget_(hourlyBudget) {}
+
+RefreshScheduler::RefreshScheduler(std::size_t hourlyBudget, const Policy& policy)
+    : hourly_budget_(hourlyBudget), policy_(policy) {}
+
+uint64_t RefreshScheduler::contentHash(const std::string& bytes) {
+    if (bytes.empty()) return 0;
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h ? h : 1;
+}
+
+// =============================================================================
+// Cards
+// =============================================================================
+
+void RefreshScheduler::track(uint64_t cds, uint32_t schoolYearId) {
+    Card& card = cards_[key(cds, schoolYearId)];
+    card.cds          = cds;
+    card.schoolYearId = schoolYearId;
+}
+
+const RefreshScheduler::Card* RefreshScheduler::find(uint64_t cds, uint32_t schoolYearId) const {
+    auto it = cards_.find(key(cds, schoolYearId));
+    return it == cards_.end() ? nullptr : &it->second;
+}
+
+void RefreshScheduler::record(uint64_t cds, uint32_t schoolYearId, int64_t now, bool ok,
+                              uint64_t contentHash)
+{
+    track(cds, schoolYearId);
+    Card& card = cards_[key(cds, schoolYearId)];
+    if (!ok) {
+        const int64_t backoff = policy_.releaseTtlSeconds << std::min<uint32_t>(card.failures, 16);
+        card.retryAfter = pullIntoRelease(schoolYearId, now, now + std::min(backoff, policy_.baseTtlSeconds));
+        ++card.failures;
+        return;
+    }
+    if (card.fetched && contentHash != card.contentHash) card.changed = now;
+    card.fetched     = now;
+    card.contentHash = contentHash;
+    card.retryAfter  = 0;
+    card.failures    = 0;
+}
+
+int64_t RefreshScheduler::dueAt(const Card& card) const {
+    const bool closed = current_year_ && card.schoolYearId < current_year_;
+    if (!card.fetched) return closed && card.failures >= policy_.closedYearMaxFailures ? NEVER : card.retryAfter;
+    if (closed) return NEVER;
+
+    int64_t ttl = policy_.baseTtlSeconds;
+    if (card.changed) {
+        // Recently changed cards tend to change again: back off from the
+        // release TTL as the last change recedes.
+        ttl = std::clamp<int64_t>((card.fetched - card.changed) / 2,
+                                  policy_.releaseTtlSeconds, policy_.baseTtlSeconds);
+    }
+    return std::max(pullIntoRelease(card.schoolYearId, card.fetched, card.fetched + ttl), card.retryAfter);
+}
+
+// Inside a release window, or due after one opens: check at the release
+// cadence, starting no earlier than the window.
+int64_t RefreshScheduler::pullIntoRelease(uint32_t schoolYearId, int64_t from, int64_t due) const {
+    const int64_t soonest = from + policy_.releaseTtlSeconds;
+    for (const Release& r : releases_) {
+        if (r.schoolYearId != schoolYearId) continue;
+        const int64_t start = r.when - policy_.releaseWindowSeconds;
+        const int64_t end   = r.when + policy_.releaseWindowSeconds;
+        if (soonest < end && due > start) due = std::min(due, std::max(start, soonest));
+    }
+    return due;
+}
+
+// =============================================================================
+// Scheduling
+// =============================================================================
+
+void RefreshScheduler::expireIssued(int64_t now) const {
+    while (!issued_.empty() && issued_.front() <= now - HOUR_SECONDS) issued_.pop_front();
+}
+
+std::size_t RefreshScheduler::remainingBudget(int64_t now) const {
+    expireIssued(now);
+    return issued_.size() >= hourly_budget_ ? 0 : hourly_budget_ - issued_.size();
+}
+
+std::vector<RefreshScheduler::Card> RefreshScheduler::schedule(int64_t now) {
+    const std::size_t budget = remainingBudget(now);
+    if (budget == 0) return {};
+
+    std::vector<std::pair<int64_t, const Card*>> due;
+    for (const auto& [k, card] : cards_) {
+        const int64_t at = dueAt(card);
+        if (at <= now) due.emplace_back(at, &card);
+    }
+
+    // Oldest due first; among equals (e.g. never fetched) the newest year.
+    auto before = [](const std::pair<int64_t, const Card*>& a, const std::pair<int64_t, const Card*>& b) {
+        if (a.first != b.first) return a.first < b.first;
+        if (a.second->schoolYearId != b.second->schoolYearId)
+            return a.second->schoolYearId > b.second->schoolYearId;
+        return a.second->cds < b.second->cds;
+    };
+    const std::size_t n = std::min(budget, due.size());
+    std::partial_sort(due.begin(), due.begin() + static_cast<std::ptrdiff_t>(n), due.end(), before);
+
+    std::vector<Card> out;
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        out.push_back(*due[i].second);
+        issued_.push_back(now);
+    }
+    return out;
+}
+
+int64_t RefreshScheduler::nextWake(int64_t now) const {
+    int64_t earliest = NEVER;
+    for (const auto& [k, card] : cards_) earliest = std::min(earliest, dueAt(card));
+    if (earliest > now) return earliest;
+    if (remainingBudget(now) > 0) return now;
+    return issued_.front() + HOUR_SECONDS;
+}
+
+// =============================================================================
+// State file
+// =============================================================================
+
+bool RefreshScheduler::loadState(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return true;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string cds, year, fetched, changed, retry, failures, hash;
+        if (!std::getline(fields, cds, '\t') || !std::getline(fields, year, '\t') ||
+            !std::getline(fields, fetched, '\t') || !std::getline(fields, changed, '\t') ||
+            !std::getline(fields, retry, '\t') || !std::getline(fields, failures, '\t') ||
+            !std::getline(fields, hash)) {
+            std::cerr << "Error: Malformed refresh state line in " << path << std::endl;
+            return false;
+        }
+        Card c;
+        c.cds          = std::strtoull(cds.c_str(), nullptr, 10);
+        c.schoolYearId = static_cast<uint32_t>(std::strtoul(year.c_str(), nullptr, 10));
+        c.fetched      = std::strtoll(fetched.c_str(), nullptr, 10);
+        c.changed      = std::strtoll(changed.c_str(), nullptr, 10);
+        c.retryAfter   = std::strtoll(retry.c_str(), nullptr, 10);
+        c.failures     = static_cast<uint32_t>(std::strtoul(failures.c_str(), nullptr, 10));
+        c.contentHash  = std::strtoull(hash.c_str(), nullptr, 16);
+        cards_[key(c.cds, c.schoolYearId)] = c;
+    }
+    return true;
+}
+
+bool RefreshScheduler::saveState(const std::string& path) const {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open file for writing: " << tmp << std::endl;
+            return false;
+        }
+        char buf[128];
+        for (const auto& [k, c] : cards_) {
+            snprintf(buf, sizeof(buf), "%014llu\t%u\t%lld\t%lld\t%lld\t%u\t%016llx\n",
+                     static_cast<unsigned long long>(c.cds), c.schoolYearId,
+                     static_cast<long long>(c.fetched), static_cast<long long>(c.changed),
+                     static_cast<long long>(c.retryAfter), c.failures,
+                     static_cast<unsigned long long>(c.contentHash));
+            out << buf;
+        }
+        if (!out.good()) return false;
+    }
+    // Rename so a crash mid-write never leaves a truncated state file.
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Could not replace state file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
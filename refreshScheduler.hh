@@ -0,0 +1,121 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// =============================================================================
+// RefreshScheduler — decides which cards are worth refetching, and when.
+//
+// Refreshing every card on a fixed cadence spends most requests on cards
+// that cannot have changed: past school years are final, and the current
+// year only moves around release dates. The scheduler tracks each card's
+// year, last fetch and last observed content change, and gives it a TTL:
+//
+//   closed year (before the current one)   fetched once, then never again;
+//                                          given up on after
+//                                          Policy::closedYearMaxFailures
+//                                          failed fetches (a card that was
+//                                          never published)
+//   within a release window of its year    Policy::releaseTtlSeconds
+//   changed recently                       half the time since that change,
+//                                          no shorter than releaseTtlSeconds
+//   otherwise                              Policy::baseTtlSeconds
+//
+// A card whose TTL would carry it past the start of an upcoming release
+// window becomes due when the window opens. schedule() hands out due cards,
+// oldest due first (never-fetched cards first, newer years first), at most
+// `hourlyBudget` per sliding hour. Times are Unix seconds passed in by the
+// caller; state persists to a tab-separated file like the watcher's.
+// =============================================================================
+
+class RefreshScheduler {
+public:
+    static constexpr std::size_t DEFAULT_HOURLY_BUDGET = 3600;
+    static constexpr int64_t     NEVER                 = INT64_MAX;
+
+    struct Policy {
+        int64_t baseTtlSeconds       = 7 * 24 * 3600;   // open year, quiet
+        int64_t releaseTtlSeconds    = 3600;            // near a release, or after a change
+        int64_t releaseWindowSeconds = 3 * 24 * 3600;   // either side of a release date
+        // A closed year's card still missing after this many consecutive
+        // failures (about ten days of backoff) is taken as absent for good.
+        uint32_t closedYearMaxFailures = 8;
+    };
+
+    struct Card {
+        uint64_t cds          = 0;
+        uint32_t schoolYearId = 0;
+        int64_t  fetched      = 0;   // last successful fetch, 0 = never
+        int64_t  changed      = 0;   // last content change seen after the first fetch, 0 = none
+        int64_t  retryAfter   = 0;   // backoff after a failed fetch
+        uint32_t failures     = 0;   // consecutive failed fetches
+        uint64_t contentHash  = 0;   // 0 = empty or not yet published
+    };
+
+    explicit RefreshScheduler(std::size_t hourlyBudget = DEFAULT_HOURLY_BUDGET);
+    RefreshScheduler(std::size_t hourlyBudget, const Policy& policy);
+
+    // Years before this one are closed.
+    void setCurrentYear(uint32_t schoolYearId) { current_year_ = schoolYearId; }
+    // A known (or expected) publication date for a year's cards.
+    void addReleaseDate(uint32_t schoolYearId, int64_t when) { releases_.push_back({schoolYearId, when}); }
+
+    // Adds a card to the schedule; a card already tracked is left as is.
+    void track(uint64_t cds, uint32_t schoolYearId);
+
+    // Up to the remaining hourly budget of due cards, counted as issued.
+    std::vector<Card> schedule(int64_t now);
+
+    // Outcome of a scheduled fetch. `contentHash` fingerprints the card's
+    // content (0 for an empty card); a different hash than last time marks
+    // a change. A failed fetch (e.g. a 404 before a year is published) is
+    // retried after releaseTtlSeconds, doubling with each further failure
+    // up to baseTtlSeconds, but never later than a release window opening.
+    // A closed year's card stops being retried after closedYearMaxFailures.
+    void record(uint64_t cds, uint32_t schoolYearId, int64_t now, bool ok, uint64_t contentHash);
+
+    // When a card is next due (NEVER for a closed year's fetched card, or
+    // one given up on).
+    int64_t dueAt(const Card& card) const;
+    // Earliest time schedule() could return something: the next due card,
+    // or when the budget frees up if cards are already due.
+    int64_t nextWake(int64_t now) const;
+
+    std::size_t size() const { return cards_.size(); }
+    const Card* find(uint64_t cds, uint32_t schoolYearId) const;
+
+    // One line per card: "cds\tyearId\tfetched\tchanged\tretryAfter\tfailures\thash".
+    // A missing file is not an error (first run).
+    bool loadState(const std::string& path);
+    bool saveState(const std::string& path) const;
+
+    // FNV-1a of a card's bytes, never 0 for non-empty input.
+    static uint64_t contentHash(const std::string& bytes);
+
+private:
+    struct Release {
+        uint32_t schoolYearId;
+        int64_t  when;
+    };
+
+    static uint64_t key(uint64_t cds, uint32_t schoolYearId) {
+        return (cds << 16) | (schoolYearId & 0xffff);
+    }
+    int64_t     pullIntoRelease(uint32_t schoolYearId, int64_t from, int64_t due) const;
+    void        expireIssued(int64_t now) const;
+    std::size_t remainingBudget(int64_t now) const;
+
+    std::size_t                         hourly_budget_;
+    Policy                              policy_;
+    uint32_t                            current_year_ = 0;   // 0 = every year open
+    std::vector<Release>                releases_;
+    std::unordered_map<uint64_t, Card>  cards_;
+    mutable std::deque<int64_t>         issued_;             // schedule() times in the last hour
+};
+
+#endif // REFRESHSCHEDULER_H
@@ -0,0 +1,160 @@
+#include "responseCache.hh"
+#include "tracepoints.hh"
+#include <time.h>
+
+static bool expired(const struct timespec& expires) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > expires.tv_sec ||
+           (now.tv_sec == expires.tv_sec && now.tv_nsec >= expires.tv_nsec);
+}
+
+ResponseCache::ResponseCache(std::size_t capacityBytes, long ttlSeconds)
+    : capacity_(capacityBytes), ttl_seconds_(ttlSeconds) {}
+
+// =============================================================================
+// Internals (caller holds mtx_)
+// =============================================================================
+
+void ResponseCache::eraseLocked(LruList::iterator it) {
+    bytes_ -= it->stored.size() + it->key.size();
+    index_.erase(it->key);
+    lru_.erase(it);
+}
+
+bool ResponseCache::findLocked(const std::string& key, std::string& body) {
+    auto found = index_.find(key);
+    if (found == index_.end()) return false;
+
+    LruList::iterator it = found->second;
+    if (expired(it->expires)) {
+        eraseLocked(it);
+        ++stats_.expirations;
+        return false;
+    }
+    if (it->compressed) {
+        if (!compressor_ || !compressor_->decompress(it->stored, body)) {
+            eraseLocked(it);
+            return false;
+        }
+    } else {
+        body = it->stored;
+    }
+    lru_.splice(lru_.begin(), lru_, it);
+    return true;
+}
+
+void ResponseCache::insertLocked(const std::string& key, const std::string& body) {
+    auto found = index_.find(key);
+    if (found != index_.end()) eraseLocked(found->second);
+
+    Entry e;
+    e.key = key;
+    if (compressor_ && compressor_->compress(body, e.stored)) {
+        e.compressed = true;
+    } else {
+        e.stored = body;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &e.expires);
+    e.expires.tv_sec += ttl_seconds_;
+
+    const std::size_t size = e.stored.size() + e.key.size();
+    if (size > capacity_) return;   // would evict everything else
+
+    lru_.push_front(std::move(e));
+    index_[key] = lru_.begin();
+    bytes_ += size;
+
+    while (bytes_ > capacity_ && !lru_.empty()) {
+        eraseLocked(std::prev(lru_.end()));
+        ++stats_.evictions;
+    }
+}
+
+// =============================================================================
+// Public interface
+// =============================================================================
+
+bool ResponseCache::lookup(const std::string& key, std::string& body) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (findLocked(key, body)) { ++stats_.hits; return true; }
+    ++stats_.misses;
+    return false;
+}
+
+void ResponseCache::insert(const std::string& key, const std::string& body) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    insertLocked(key, body);
+}
+
+long ResponseCache::getOrLoad(const std::string& key,
+                              const std::function<long(std::string& body)>& load,
+                              std::string& body,
+                              Source* source)
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    if (findLocked(key, body)) {
+        ++stats_.hits;
+        if (source) *source = Source::HIT;
+        CADASH_PROBE2(cache_lookup, key.c_str(), 0);
+        return 200;
+    }
+
+    auto running = flights_.find(key);
+    if (running != flights_.end()) {
+        std::shared_ptr<Flight> flight = running->second;
+        ++stats_.coalesced;
+        CADASH_PROBE2(cache_lookup, key.c_str(), 2);
+        flight_cv_.wait(lk, [&flight] { return flight->done; });
+        body = flight->body;
+        if (source) *source = Source::COALESCED;
+        return flight->status;
+    }
+
+    auto flight = std::make_shared<Flight>();
+    flights_[key] = flight;
+    ++stats_.misses;
+    CADASH_PROBE2(cache_lookup, key.c_str(), 1);
+    lk.unlock();
+
+    std::string loaded;
+    long status = 0;
+    try {
+        status = load(loaded);
+    } catch (...) {
+        status = 0;
+    }
+
+    lk.lock();
+    if (status == 200) insertLocked(key, loaded);
+    flight->status = status;
+    flight->body   = loaded;
+    flight->done   = true;
+    flights_.erase(key);
+    lk.unlock();
+    flight_cv_.notify_all();
+
+    body = std::move(loaded);
+    if (source) *source = Source::MISS;
+    return status;
+}
+
+bool ResponseCache::looksLikeJson(const std::string& body) {
+    std::size_t first = body.find_first_not_of(" \t\r\n");
+    return first != std::string::npos && (body[first] == '{' || body[first] == '[');
+}
+
+ResponseCache::Stats ResponseCache::stats() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    Stats s   = stats_;
+    s.entries = index_.size();
+    s.bytes   = bytes_;
+    return s;
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
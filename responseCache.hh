@@ -0,0 +1,108 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include "payloadCompressor.hh"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+
+// =============================================================================
+// ResponseCache — shared cache of upstream response bodies, keyed by URL.
+//
+// Entries expire after a TTL and the least recently used are evicted once
+// the byte budget is exceeded. With a PayloadCompressor set, bodies are held
+// as zstd frames, which lets a much larger working set fit in the budget.
+//
+// getOrLoad() coalesces concurrent misses for the same key (single-flight):
+// the first caller runs the loader while later callers wait for its result,
+// so a burst of identical requests costs one upstream fetch.
+// =============================================================================
+
+class ResponseCache {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY_BYTES = 256ull * 1024 * 1024;
+    static constexpr long        DEFAULT_TTL_SECONDS    = 6 * 60 * 60;
+
+    enum class Source { HIT, MISS, COALESCED };
+
+    struct Stats {
+        uint64_t    hits        = 0;
+        uint64_t    misses      = 0;
+        uint64_t    coalesced   = 0;   // misses served by another caller's load
+        uint64_t    evictions   = 0;
+        uint64_t    expirations = 0;
+        std::size_t entries     = 0;
+        std::size_t bytes       = 0;   // stored (possibly compressed) bytes
+    };
+
+    explicit ResponseCache(std::size_t capacityBytes = DEFAULT_CAPACITY_BYTES,
+                           long ttlSeconds = DEFAULT_TTL_SECONDS);
+
+    ResponseCache(const ResponseCache&)            = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // Compresses stored bodies. Set before first use; must outlive the cache.
+    void setCompressor(const PayloadCompressor* compressor) { compressor_ = compressor; }
+
+    // Copies a fresh cached body into `body`. Counts a hit or a miss.
+    bool lookup(const std::string& key, std::string& body);
+    void insert(const std::string& key, const std::string& body);
+
+    // Returns the HTTP status for `key`: 200 from cache, or whatever the
+    // loader returned. The loader fills `body` and returns a status; only
+    // 200 responses are cached. Callers that arrive while a load for the
+    // same key is running get that load's status and body.
+    long getOrLoad(const std::string& key,
+                   const std::function<long(std::string& body)>& load,
+                   std::string& body,
+                   Source* source = nullptr);
+
+    // Whether a 200 body is a JSON document. Loaders sharing one cache
+    // report anything else (e.g. a WAF challenge page) as 502, so it is
+    // never stored.
+    static bool looksLikeJson(const std::string& body);
+
+    Stats stats() const;
+    void  clear();
+
+private:
+    struct Entry {
+        std::string     key;
+        std::string     stored;
+        bool            compressed = false;
+        struct timespec expires;
+    };
+
+    struct Flight {
+        bool        done   = false;
+        long        status = 0;
+        std::string body;
+    };
+
+    using LruList = std::list<Entry>;
+
+    bool findLocked(const std::string& key, std::string& body);
+    void insertLocked(const std::string& key, const std::string& body);
+    void eraseLocked(LruList::iterator it);
+
+    std::size_t              capacity_;
+    long                     ttl_seconds_;
+    const PayloadCompressor* compressor_ = nullptr;
+
+    mutable std::mutex                                        mtx_;
+    std::condition_variable                                   flight_cv_;
+    LruList                                                   lru_;   // front = most recent
+    std::unordered_map<std::string, LruList::iterator>        index_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>>  flights_;
+    std::size_t                                               bytes_ = 0;
+    Stats                                                     stats_;
+};
+
+#endif // RESPONSECACHE_H
@@ -0,0 +1,291 @@
+#include "samplingPlanner.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+
+// =============================================================================
+// SamplingPlan
+// =============================================================================
+
+std::size_t SamplingPlan::population() const {
+    std::size_t n = 0;
+    for (const auto& s : strata) n += s.population;
+    return n;
+}
+
+std::size_t SamplingPlan::sampleSize() const {
+    std::size_t n = 0;
+    for (const auto& s : strata) n += s.sample.size();
+    return n;
+}
+
+std::vector<uint64_t> SamplingPlan::cds() const {
+    std::vector<uint64_t> all;
+    all.reserve(sampleSize());
+    for (const auto& s : strata) all.insert(all.end(), s.sample.begin(), s.sample.end());
+    std::sort(all.begin(), all.end());
+    return all;
+}
+
+// =============================================================================
+// SamplingPlanner
+// =============================================================================
+
+SamplingPlanner::SamplingPlanner(const SchoolDirectory& directory,
+                                 std::vector<SchoolDirectory::Column> strataColumns)
+    : directory_(directory), columns_(std::move(strataColumns)) {}
+
+bool SamplingPlanner::plan(double fraction, uint64_t seed, SamplingPlan& out) const {
+    out.strata.clear();
+    if (!(fraction > 0 && fraction <= 1)) {
+        fprintf(stderr, "Error: sampling fraction must be in (0, 1], got %g\n", fraction);
+        return false;
+    }
+
+    // Group eligible schools by their full key; "*" marks a merged column.
+    using Key = std::vector<std::string>;
+    std::map<Key, std::vector<uint64_t>> groups;
+    for (std::size_t row = 0; row < directory_.size(); ++row) {
+        if (!directory_.hasDashboardCard(row)) continue;
+        Key key;
+        key.reserve(columns_.size());
+        for (SchoolDirectory::Column c : columns_) key.emplace_back(directory_.get(row, c));
+        groups[std::move(key)].push_back(directory_.cds(row));
+    }
+    if (groups.empty()) {
+        fprintf(stderr, "Error: no eligible schools to sample from\n");
+        return false;
+    }
+
+    // Collapse small strata one column at a time, most specific first.
+    const double minPopulation = MIN_PER_STRATUM / fraction;
+    for (std::size_t depth = columns_.size(); depth > 0; --depth) {
+        for (auto it = groups.begin(); it != groups.end();) {
+            const bool atDepth = it->first[depth - 1] != "*";
+            if (!atDepth || it->second.size() >= minPopulation) {
+                ++it;
+                continue;
+            }
+            Key parent = it->first;
+            parent[depth - 1] = "*";
+            std::vector<uint64_t>& into = groups[parent];
+            into.insert(into.end(), it->second.begin(), it->second.end());
+            it = groups.erase(it);
+        }
+    }
+
+    // Proportional allocation, largest remainder rounding, with a floor.
+    std::size_t population = 0;
+    for (const auto& g : groups) population += g.second.size();
+    const std::size_t target = std::max<std::size_t>(1, static_cast<std::size_t>(std::llround(fraction * population)));
+
+    struct Allocation { std::vector<uint64_t>* members; const Key* key; std::size_t n; double remainder; };
+    std::vector<Allocation> alloc;
+    std::size_t allocated = 0;
+    for (auto& [key, members] : groups) {
+        const double share = fraction * members.size();
+        std::size_t n = static_cast<std::size_t>(share);
+        n = std::min(members.size(), std::max(n, MIN_PER_STRATUM));
+        alloc.push_back({&members, &key, n, share - std::floor(share)});
+        allocated += n;
+    }
+    std::vector<std::size_t> order(alloc.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&alloc](std::size_t a, std::size_t b) { return alloc[a].remainder > alloc[b].remainder; });
+    for (std::size_t i = 0; allocated < target && i < order.size(); ++i) {
+        Allocation& a = alloc[order[i]];
+        if (a.n < fraction * a.members->size()) {   // rounded down, not floored up
+            ++a.n;
+            ++allocated;
+        }
+    }
+
+    // Draw without replacement: a partial Fisher-Yates shuffle per stratum.
+    std::mt19937_64 rng(seed);
+    for (Allocation& a : alloc) {
+        std::vector<uint64_t>& members = *a.members;
+        std::sort(members.begin(), members.end());
+        for (std::size_t i = 0; i < a.n; ++i) {
+            std::uniform_int_distribution<std::size_t> pick(i, members.size() - 1);
+            std::swap(members[i], members[pick(rng)]);
+        }
+
+        SamplingStratum s;
+        for (const std::string& value : *a.key) {
+            if (!s.label.empty()) s.label += " / ";
+            s.label += value;
+        }
+        if (s.label.empty()) s.label = "*";
+        s.population = members.size();
+        s.sample.assign(members.begin(), members.begin() + static_cast<std::ptrdiff_t>(a.n));
+        std::sort(s.sample.begin(), s.sample.end());
+        out.strata.push_back(std::move(s));
+    }
+    return true;
+}
+
+// =============================================================================
+// SampleEstimator
+// =============================================================================
+
+double SampleEstimator::zFor(double confidence) {
+    if (!(confidence > 0 && confidence < 1)) confidence = 0.95;
+    // erfc(z / sqrt 2) = 1 - confidence, by bisection.
+    double lo = 0, hi = 40;
+    for (int i = 0; i < 100; ++i) {
+        const double mid = (lo + hi) / 2;
+        (std::erfc(mid / std::sqrt(2.0)) > 1 - confidence ? lo : hi) = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+namespace {
+
+// Per-stratum sums of one domain's observations (z = measure x weight,
+// u = weight, both zero for schools outside the domain).
+struct StratumSums {
+    std::size_t reporting = 0;
+    double      z = 0, u = 0, zz = 0, uu = 0, zu = 0;
+};
+
+struct Observation {
+    std::size_t unit;
+    double      y;
+    double      x;
+};
+
+} // namespace
+
+std::vector<SampleEstimate> SampleEstimator::estimate(const SamplingPlan& plan,
+                                                      const IndicatorStore& store,
+                                                      const EstimateSpec& spec,
+                                                      const SchoolDirectory* directory)
+{
+    // Sampled schools as units, each with its stratum and domain.
+    std::unordered_map<uint64_t, std::size_t> unitOf;
+    std::vector<std::size_t> stratumOf;
+    std::vector<int>         domainOf;
+    std::vector<std::string> domainNames;
+    std::unordered_map<std::string_view, int> domainIndex;
+    const bool byDomain = spec.domainColumn >= 0 && spec.domainColumn < SchoolDirectory::COLUMN_COUNT && directory;
+    for (std::size_t h = 0; h < plan.strata.size(); ++h) {
+        for (uint64_t cds : plan.strata[h].sample) {
+            unitOf.emplace(cds, stratumOf.size());
+            stratumOf.push_back(h);
+            int domain = -1;
+            if (byDomain) {
+                const std::size_t row = directory->find(cds);
+                if (row != SchoolDirectory::npos) {
+                    const std::string_view value =
+                        directory->get(row, static_cast<SchoolDirectory::Column>(spec.domainColumn));
+                    auto [it, added] = domainIndex.emplace(value, static_cast<int>(domainNames.size()));
+                    if (added) domainNames.emplace_back(value);
+                    domain = it->second;
+                }
+            }
+            domainOf.push_back(domain);
+        }
+    }
+
+    // Usable "ALL" rows of sampled schools, per (indicator, year).
+    const auto& groups = store.studentGroupDictionary();
+    const auto  all    = std::find(groups.begin(), groups.end(), "ALL");
+    const bool  filterGroup = all != groups.end();
+    const uint32_t allCode  = static_cast<uint32_t>(all - groups.begin());
+    const bool  decimal = spec.equals == EstimateSpec::ANY &&
+                          (spec.column == IndicatorStore::STATUS || spec.column == IndicatorStore::CHANGE);
+
+    std::map<std::pair<int32_t, int32_t>, std::vector<Observation>> observations;
+    const auto& values = store.column(spec.column);
+    for (std::size_t row = 0; row < store.size(); ++row) {
+        if (filterGroup && store.studentGroupCodes()[row] != allCode) continue;
+        if (store.isPrivateData()[row] || store.column(IndicatorStore::STATUS_ID)[row] == 0) continue;
+        auto unit = unitOf.find(store.cds()[row]);
+        if (unit == unitOf.end()) continue;
+
+        double x = 1;
+        if (spec.studentWeighted) {
+            if (store.count()[row] <= 0) continue;
+            x = static_cast<double>(store.count()[row]);
+        }
+        const int32_t v = values[row];
+        const double  y = spec.equals != EstimateSpec::ANY ? (v == spec.equals ? 1.0 : 0.0)
+                        : decimal ? IndicatorStore::toFloat(v) : static_cast<double>(v);
+        observations[{store.column(IndicatorStore::INDICATOR_ID)[row],
+                      store.column(IndicatorStore::SCHOOL_YEAR_ID)[row]}].push_back({unit->second, y, x});
+    }
+
+    // Domains in name order, statewide (-1) first.
+    std::vector<int> domainOrder{-1};
+    for (int d = 0; d < static_cast<int>(domainNames.size()); ++d) domainOrder.push_back(d);
+    std::sort(domainOrder.begin() + 1, domainOrder.end(),
+              [&domainNames](int a, int b) { return domainNames[a] < domainNames[b]; });
+
+    const double z = zFor(spec.confidence);
+    std::vector<SampleEstimate> estimates;
+    for (const auto& [key, obs] : observations) {
+        std::vector<std::vector<StratumSums>> sums(domainNames.size() + 1);
+        auto add = [&](int domain, const Observation& o) {
+            std::vector<StratumSums>& d = sums[static_cast<std::size_t>(domain + 1)];
+            if (d.empty()) d.resize(plan.strata.size());
+            StratumSums& s = d[stratumOf[o.unit]];
+            const double zi = o.y * o.x;
+            ++s.reporting;
+            s.z += zi;        s.u += o.x;
+            s.zz += zi * zi;  s.uu += o.x * o.x;  s.zu += zi * o.x;
+        };
+        for (const Observation& o : obs) {
+            add(-1, o);
+            if (domainOf[o.unit] >= 0) add(domainOf[o.unit], o);
+        }
+
+        for (int domain : domainOrder) {
+            const std::vector<StratumSums>& d = sums[static_cast<std::size_t>(domain + 1)];
+            if (d.empty()) continue;
+
+            double Y = 0, X = 0, N = 0;
+            std::size_t reporting = 0;
+            for (std::size_t h = 0; h < d.size(); ++h) {
+                if (d[h].reporting == 0) continue;
+                const double w = static_cast<double>(plan.strata[h].population) / plan.strata[h].sample.size();
+                Y += w * d[h].z;
+                X += w * d[h].u;
+                N += w * d[h].reporting;
+                reporting += d[h].reporting;
+            }
+            if (X <= 0) continue;
+            const double R = Y / X;
+
+            // Linearised variance of the ratio: residuals e = z - R u, with
+            // every sampled school of the stratum in the denominator.
+            double variance = 0;
+            for (std::size_t h = 0; h < d.size(); ++h) {
+                const double n  = static_cast<double>(plan.strata[h].sample.size());
+                const double Nh = static_cast<double>(plan.strata[h].population);
+                if (d[h].reporting == 0 || n < 2) continue;
+                const double se  = d[h].z - R * d[h].u;
+                const double se2 = d[h].zz - 2 * R * d[h].zu + R * R * d[h].uu;
+                const double s2  = std::max(0.0, (se2 - se * se / n) / (n - 1));
+                variance += Nh * Nh * (1 - n / Nh) * s2 / n;
+            }
+
+            SampleEstimate e;
+            e.indicatorId   = key.first;
+            e.schoolYearId  = key.second;
+            e.domain        = domain < 0 ? "" : domainNames[static_cast<std::size_t>(domain)];
+            e.value         = R;
+            e.standardError = std::sqrt(variance) / X;
+            e.low           = R - z * e.standardError;
+            e.high          = R + z * e.standardError;
+            e.schools       = reporting;
+            e.population    = N;
+            estimates.push_back(std::move(e));
+        }
+    }
+    return estimates;
+}
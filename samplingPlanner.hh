@@ -0,0 +1,124 @@
+#ifndef SAMPLINGPLANNER_H
+#define SAMPLINGPLANNER_H
+
+#include "indicatorStore.hh"
+#include "schoolDirectory.hh"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// SamplingPlanner — stratified random sample of schools for approximate
+// statewide and county estimates from a fraction of the requests.
+//
+// The population is the directory's active schools, minus district offices
+// (school code 0000000) and the school types that have no dashboard card
+// (preschools, adult education, ROC/ROP). Schools are stratified by the
+// given directory columns, County x SOCType by default; SOCType separates
+// elementary, middle and high schools, which is the closest thing to a size
+// class the directory has. A stratum too small to receive MIN_PER_STRATUM
+// schools under proportional allocation is merged with its neighbours by
+// dropping the last stratification column ("Alpine / *"), and what is still
+// too small after that lands in one statewide remainder stratum ("*").
+// Each stratum then gets its proportional share of the sample (largest
+// remainder rounding, at least MIN_PER_STRATUM) drawn without replacement.
+// Plans are reproducible from the seed.
+// =============================================================================
+
+struct SamplingStratum {
+    std::string           label;           // column values joined by " / ", "*" where merged
+    std::size_t           population = 0;  // schools in the stratum (N_h)
+    std::vector<uint64_t> sample;          // sampled CDS codes, ascending
+};
+
+struct SamplingPlan {
+    std::vector<SamplingStratum> strata;
+
+    std::size_t population() const;
+    std::size_t sampleSize() const;
+    // Every sampled CDS code, ascending.
+    std::vector<uint64_t> cds() const;
+};
+
+class SamplingPlanner {
+public:
+    static constexpr double      DEFAULT_FRACTION = 0.05;
+    static constexpr std::size_t MIN_PER_STRATUM  = 2;   // for a within-stratum variance
+
+    explicit SamplingPlanner(const SchoolDirectory& directory,
+                             std::vector<SchoolDirectory::Column> strataColumns =
+                                 {SchoolDirectory::COUNTY, SchoolDirectory::SOC_TYPE});
+
+    // Draws about `fraction` of the population. False (with a message) when
+    // the fraction is out of range or the directory has no school with a
+    // dashboard card (SchoolDirectory::hasDashboardCard).
+    bool plan(double fraction, uint64_t seed, SamplingPlan& out) const;
+
+private:
+    const SchoolDirectory&               directory_;
+    std::vector<SchoolDirectory::Column> columns_;
+};
+
+// =============================================================================
+// SampleEstimator — weighted estimates with confidence intervals from the
+// cards of a planned sample.
+//
+// Every estimate is a ratio of Horvitz-Thompson totals, each sampled school
+// weighted by N_h / n_h of its stratum:
+//
+//   school-weighted    mean of the measure over schools that report it
+//   student-weighted   the same, weighted by each school's student count
+//                      (the indicator's "count"), which is how statewide
+//                      figures are computed
+//
+// A county (or any other domain) estimate uses the same weights restricted
+// to that domain's schools. Standard errors come from the linearised
+// stratified variance with the finite-population correction, and intervals
+// are normal-approximation intervals at the requested confidence. A school
+// that was sampled but has no usable row (no card, private data, no status
+// level) counts as not reporting, which narrows the population the estimate
+// describes rather than biasing it towards zero.
+// =============================================================================
+
+struct SampleEstimate {
+    int32_t     indicatorId   = 0;
+    int32_t     schoolYearId  = 0;
+    std::string domain;                 // "" = statewide
+    double      value         = 0;
+    double      standardError = 0;
+    double      low           = 0;      // confidence interval
+    double      high          = 0;
+    std::size_t schools       = 0;      // sampled schools reporting
+    double      population    = 0;      // estimated reporting schools in the domain
+};
+
+struct EstimateSpec {
+    static constexpr int32_t ANY = INT32_MIN;
+
+    // The measure: a column's value (STATUS and CHANGE as decimals), or,
+    // with `equals` set, the share of schools whose value equals it (e.g.
+    // PERFORMANCE == 1 for the share of schools at the red level).
+    IndicatorStore::IntColumn column = IndicatorStore::STATUS;
+    int32_t                   equals = ANY;
+    bool                      studentWeighted = false;
+    double                    confidence      = 0.95;
+    // Also estimate per value of this directory column (-1 = statewide only).
+    int                       domainColumn    = -1;
+};
+
+class SampleEstimator {
+public:
+    // One estimate per (indicator, year) in `store`, statewide first and
+    // then per domain, for the "ALL" student group rows of sampled schools.
+    // `directory` is only read when the spec asks for domains.
+    static std::vector<SampleEstimate> estimate(const SamplingPlan& plan,
+                                                const IndicatorStore& store,
+                                                const EstimateSpec& spec = EstimateSpec(),
+                                                const SchoolDirectory* directory = nullptr);
+
+    // Two-sided standard normal quantile for a confidence level (1.96 at 0.95).
+    static double zFor(double confidence);
+};
+
+#endif // SAMPLINGPLANNER_H
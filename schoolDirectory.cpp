@@ -0,0 +1,183 @@
+#include "schoolDirectory.hh"
+#include "csvScanner.hh"
+#include "indicatorFields.hh"
+#include "perfRegions.hh"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <unordered_map>
+
+// A column becomes a dictionary when it has at most this fraction of
+// distinct values (and fits a uint16_t code).
+static constexpr std::size_t DICTIONARY_RATIO = 4;
+
+// School types without a dashboard card; requesting them wastes requests.
+static const char* const NO_CARD_SOC_TYPES[] = {
+    "Preschool",
+    "Adult Education Centers",
+    "ROC/ROP",
+};
+
+static const char* const COLUMN_NAMES[] = {
+#define X(id, name) name,
+    SCHOOL_DIRECTORY_COLUMNS(X)
+#undef X
+};
+
+namespace {
+
+struct Span {
+    uint32_t off = 0;
+    uint32_t len = 0;
+};
+
+} // namespace
+
+// =============================================================================
+// Columns
+// =============================================================================
+
+const char* SchoolDirectory::columnName(Column c) {
+    return (c >= 0 && c < COLUMN_COUNT) ? COLUMN_NAMES[c] : "";
+}
+
+int SchoolDirectory::columnIndex(std::string_view name) {
+    for (int c = 0; c < COLUMN_COUNT; ++c)
+        if (name == COLUMN_NAMES[c]) return c;
+    return -1;
+}
+
+// =============================================================================
+// Load / Clear
+// =============================================================================
+
+bool SchoolDirectory::load(const std::string& csvPath) {
+    PerfRegion region("directory_load");
+    clear();
+
+    CsvScanner csv;
+    if (!csv.open(csvPath)) return false;
+
+    // Header: map file positions to columns.
+    std::vector<std::string_view> fields;
+    std::vector<int>              fileToColumn;
+    bool seen[COLUMN_COUNT] = {};
+    csv.next(fields);
+    for (std::string_view name : fields) {
+        int c = columnIndex(name);
+        if (c >= 0) seen[c] = true;
+        fileToColumn.push_back(c);
+    }
+    std::string missing;
+    for (int c = 0; c < COLUMN_COUNT; ++c)
+        if (!seen[c]) missing += std::string(missing.empty() ? "" : ", ") + COLUMN_NAMES[c];
+    if (!missing.empty()) {
+        fprintf(stderr, "Error: %s is missing column(s): %s\n", csvPath.c_str(), missing.c_str());
+        return false;
+    }
+
+    // Rows: one span per column, in column order.
+    std::vector<Span> spans;
+    spans.reserve(csv.size() / 400 * COLUMN_COUNT);
+    while (csv.next(fields)) {
+        Span row[COLUMN_COUNT];
+        const std::size_t n = std::min(fields.size(), fileToColumn.size());
+        for (std::size_t i = 0; i < n; ++i)
+            if (fileToColumn[i] >= 0)
+                row[fileToColumn[i]] = { static_cast<uint32_t>(fields[i].data() - csv.data()),
+                                         static_cast<uint32_t>(fields[i].size()) };
+        spans.insert(spans.end(), row, row + COLUMN_COUNT);
+    }
+    const std::size_t rows = spans.size() / COLUMN_COUNT;
+    auto value = [&](std::size_t r, int c) {
+        const Span& s = spans[r * COLUMN_COUNT + c];
+        return std::string_view(csv.data() + s.off, s.len);
+    };
+
+    // CDS order (the file is normally sorted already).
+    std::vector<uint64_t> cds(rows);
+    for (std::size_t r = 0; r < rows; ++r) cds[r] = indicatorfields::parseCds(value(r, CDS_CODE));
+    std::vector<uint32_t> order(rows);
+    std::iota(order.begin(), order.end(), 0u);
+    if (!std::is_sorted(cds.begin(), cds.end()))
+        std::stable_sort(order.begin(), order.end(),
+                         [&cds](uint32_t a, uint32_t b) { return cds[a] < cds[b]; });
+    cds_.resize(rows);
+    for (std::size_t i = 0; i < rows; ++i) cds_[i] = cds[order[i]];
+
+    // Columns, each either a run of values or a dictionary plus codes.
+    heap_.reserve(csv.size() / 2);
+    const std::size_t dictLimit = std::min<std::size_t>(UINT16_MAX, rows / DICTIONARY_RATIO);
+    for (int c = 0; c < COLUMN_COUNT; ++c) {
+        ColumnData& col = columns_[c];
+
+        std::unordered_map<std::string_view, uint16_t> index;
+        std::vector<std::string_view>                  distinct;
+        std::vector<uint16_t>                          codes(rows);
+        bool dictionary = rows > 0;
+        for (std::size_t i = 0; i < rows && dictionary; ++i) {
+            auto [it, inserted] = index.try_emplace(value(order[i], c),
+                                                    static_cast<uint16_t>(distinct.size()));
+            if (inserted) {
+                distinct.push_back(it->first);
+                dictionary = distinct.size() <= dictLimit;
+            }
+            codes[i] = it->second;
+        }
+
+        auto append = [this, &col](std::string_view v) {
+            heap_.append(v.data(), v.size());
+            col.offsets.push_back(static_cast<uint32_t>(heap_.size()));
+        };
+        col.offsets.push_back(static_cast<uint32_t>(heap_.size()));
+        if (dictionary) {
+            col.offsets.reserve(distinct.size() + 1);
+            for (std::string_view v : distinct) append(v);
+            col.codes = std::move(codes);
+        } else {
+            col.offsets.reserve(rows + 1);
+            for (std::size_t i = 0; i < rows; ++i) append(value(order[i], c));
+        }
+    }
+    heap_.shrink_to_fit();
+    return true;
+}
+
+void SchoolDirectory::clear() {
+    std::string().swap(heap_);
+    for (auto& col : columns_) {
+        std::vector<uint32_t>().swap(col.offsets);
+        std::vector<uint16_t>().swap(col.codes);
+    }
+    std::vector<uint64_t>().swap(cds_);
+}
+
+// =============================================================================
+// Lookup
+// =============================================================================
+
+std::size_t SchoolDirectory::find(uint64_t cds) const {
+    auto it = std::lower_bound(cds_.begin(), cds_.end(), cds);
+    return (it != cds_.end() && *it == cds) ? static_cast<std::size_t>(it - cds_.begin()) : npos;
+}
+
+std::size_t SchoolDirectory::find(const std::string& cds) const {
+    uint64_t v = indicatorfields::parseCds(cds);
+    return v ? find(v) : npos;
+}
+
+bool SchoolDirectory::hasDashboardCard(std::size_t row) const {
+    if (get(row, STATUS_TYPE) != "Active") return false;
+    if (cds(row) % 10000000 == 0) return false;   // district office
+    const std::string_view soc = get(row, SOC_TYPE);
+    for (const char* type : NO_CARD_SOC_TYPES)
+        if (soc == type) return false;
+    return true;
+}
+
+std::size_t SchoolDirectory::memoryBytes() const {
+    std::size_t bytes = heap_.capacity() + cds_.capacity() * sizeof(uint64_t);
+    for (const auto& col : columns_)
+        bytes += col.offsets.capacity() * sizeof(uint32_t) + col.codes.capacity() * sizeof(uint16_t);
+    return bytes;
+}
@@ -0,0 +1,120 @@
+#ifndef SCHOOLDIRECTORY_H
+#define SCHOOLDIRECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// SchoolDirectory — compact, read-only copy of pubschls.csv.
+//
+// All 46 columns of the CDE public schools file, for reports that need
+// addresses, phone numbers, grade spans, charter status or administrator
+// names next to indicators.
+//
+// Storage: every value lives in one contiguous string heap. Each column has
+// an offset array into it; value i spans [offsets[i], offsets[i + 1]). A
+// column with few distinct values (County, District, DOCType, SOCType,
+// EdOpsName, the many "No Data" fields...) is dictionary-encoded instead:
+// its offsets index the distinct values and a uint16_t code per row picks
+// one. The choice is made per column at load time from its cardinality.
+//
+// Rows are ordered by CDS code, so a row number is the school's CDS ordinal
+// and get(row, column) is O(1); find() maps a CDS code to its row.
+// Values are returned as views into the heap, exactly as in the file
+// (quotes removed, "" unescaped), and stay valid until the next load().
+// =============================================================================
+
+// X(enumerator, CSV header name), in file order.
+#define SCHOOL_DIRECTORY_COLUMNS(X)                                                  \
+    X(CDS_CODE, "CDSCode")           X(NCES_DIST, "NCESDist")                         \
+    X(NCES_SCHOOL, "NCESSchool")     X(STATUS_TYPE, "StatusType")                     \
+    X(COUNTY, "County")              X(DISTRICT, "District")                          \
+    X(SCHOOL, "School")              X(STREET, "Street")                              \
+    X(STREET_ABR, "StreetAbr")       X(CITY, "City")                                  \
+    X(ZIP, "Zip")                    X(STATE, "State")                                \
+    X(MAIL_STREET, "MailStreet")     X(MAIL_STR_ABR, "MailStrAbr")                    \
+    X(MAIL_CITY, "MailCity")         X(MAIL_ZIP, "MailZip")                           \
+    X(MAIL_STATE, "MailState")       X(PHONE, "Phone")                                \
+    X(EXT, "Ext")                    X(FAX_NUMBER, "FaxNumber")                       \
+    X(WEBSITE, "WebSite")            X(OPEN_DATE, "OpenDate")                         \
+    X(CLOSED_DATE, "ClosedDate")     X(CHARTER, "Charter")                            \
+    X(CHARTER_NUM, "CharterNum")     X(FUNDING_TYPE, "FundingType")                   \
+    X(DOC, "DOC")                    X(DOC_TYPE, "DOCType")                           \
+    X(SOC, "SOC")                    X(SOC_TYPE, "SOCType")                           \
+    X(ED_OPS_CODE, "EdOpsCode")      X(ED_OPS_NAME, "EdOpsName")                      \
+    X(EIL_CODE, "EILCode")           X(EIL_NAME, "EILName")                           \
+    X(GS_OFFERED, "GSoffered")       X(GS_SERVED, "GSserved")                         \
+    X(VIRTUAL, "Virtual")            X(MAGNET, "Magnet")                              \
+    X(YEAR_ROUND, "YearRoundYN")     X(FEDERAL_DFC_DISTRICT_ID, "FederalDFCDistrictID") \
+    X(LATITUDE, "Latitude")          X(LONGITUDE, "Longitude")                        \
+    X(ADM_FNAME, "AdmFName")         X(ADM_LNAME, "AdmLName")                         \
+    X(LAST_UPDATE, "LastUpDate")     X(MULTILINGUAL, "Multilingual")
+
+class SchoolDirectory {
+public:
+    enum Column {
+#define X(id, name) id,
+        SCHOOL_DIRECTORY_COLUMNS(X)
+#undef X
+        COLUMN_COUNT
+    };
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    static const char* columnName(Column c);
+    // Column for a CSV header name, or -1.
+    static int columnIndex(std::string_view name);
+
+    // Replaces the contents with the given pubschls.csv. Columns are matched
+    // by header name, so their order in the file does not matter.
+    bool load(const std::string& csvPath);
+    void clear();
+
+    std::size_t size() const { return cds_.size(); }
+
+    uint64_t         cds(std::size_t row) const { return cds_[row]; }
+    std::string_view get(std::size_t row, Column c) const {
+        const ColumnData& col = columns_[c];
+        const std::size_t i   = col.codes.empty() ? row : col.codes[row];
+        return std::string_view(heap_.data() + col.offsets[i], col.offsets[i + 1] - col.offsets[i]);
+    }
+
+    // Row of a CDS code, or npos.
+    std::size_t find(uint64_t cds) const;
+    std::size_t find(const std::string& cds) const;
+
+    // Whether the row is a school with a dashboard card: active, not a
+    // district office, and not a preschool, adult education centre or
+    // ROC/ROP. Sampling and the refresh daemon request only these.
+    bool hasDashboardCard(std::size_t row) const;
+
+    bool        isDictionary(Column c)   const { return !columns_[c].codes.empty(); }
+    // Distinct values of a dictionary column (0 for heap columns).
+    std::size_t dictionarySize(Column c) const {
+        return isDictionary(c) ? columns_[c].offsets.size() - 1 : 0;
+    }
+    // Dictionary columns only: a row's code and the value behind a code.
+    uint16_t         code(std::size_t row, Column c) const { return columns_[c].codes[row]; }
+    std::string_view dictionaryValue(Column c, std::size_t code) const {
+        const ColumnData& col = columns_[c];
+        return std::string_view(heap_.data() + col.offsets[code], col.offsets[code + 1] - col.offsets[code]);
+    }
+
+    // Bytes held by the heap, offsets and codes.
+    std::size_t memoryBytes() const;
+
+private:
+    struct ColumnData {
+        std::vector<uint32_t> offsets;   // into heap_, one past the last value at the end
+        std::vector<uint16_t> codes;     // per row, dictionary columns only
+    };
+
+    std::string           heap_;
+    ColumnData            columns_[COLUMN_COUNT];
+    std::vector<uint64_t> cds_;          // ascending
+};
+
+#endif // SCHOOLDIRECTORY_H
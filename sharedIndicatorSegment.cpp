@@ -0,0 +1,357 @@
+#include "sharedIndicatorSegment.hh"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// =============================================================================
+// Segment layout
+//
+//   [ SegmentHeader | pad to 4 KiB ][ slot 0 ][ slot 1 ]
+//   slot = [ SlotHeader ][ column 0 ][ column 1 ] ...   (columns 64-byte aligned)
+// =============================================================================
+
+static constexpr char        SEGMENT_MAGIC[8] = {'C', 'D', 'S', 'H', 'M', 'v', '1', '\0'};
+static constexpr uint32_t    SEGMENT_VERSION  = 1;
+static constexpr std::size_t HEADER_BYTES     = 4096;
+static constexpr std::size_t COLUMN_ALIGN     = 64;
+static constexpr int         ACQUIRE_ATTEMPTS = 1000;
+
+// Column slots within a data slot, in layout order.
+enum : int {
+    COL_CDS = 0,
+    COL_INT_FIRST,
+    COL_COUNT = COL_INT_FIRST + IndicatorStore::INT_COLUMN_COUNT,
+    COL_PRIVATE,
+    COL_CATEGORY_CODES,
+    COL_GROUP_CODES,
+    COL_CATEGORY_DICT,
+    COL_GROUP_DICT,
+    COL_TOTAL
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory seqlock needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory seqlock needs lock-free 32-bit atomics");
+
+struct SegmentHeader {
+    char                  magic[8];
+    uint32_t              version;
+    uint32_t              intColumns;
+    uint64_t              slotBytes;
+    std::atomic<uint64_t> publishCount;
+    std::atomic<uint32_t> activeSlot;
+};
+
+struct alignas(COLUMN_ALIGN) SlotHeader {
+    std::atomic<uint64_t> sequence;     // odd while the publisher is writing
+    uint64_t              rows;
+    uint64_t              version;
+    uint64_t              offset[COL_TOTAL];  // from slot start
+    uint64_t              length[COL_TOTAL];
+};
+
+static_assert(sizeof(SegmentHeader) <= HEADER_BYTES, "segment header overflows its page");
+
+static std::size_t alignUp(std::size_t v, std::size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+static std::size_t dictionaryBytes(const std::vector<std::string>& dict) {
+    std::size_t bytes = sizeof(uint32_t);
+    for (const auto& s : dict) bytes += sizeof(uint32_t) + s.size();
+    return bytes;
+}
+
+// Byte length of every column for a given store, in layout order.
+static void columnLengths(const IndicatorStore& store, uint64_t (&len)[COL_TOTAL]) {
+    const uint64_t rows = store.size();
+    len[COL_CDS] = rows * sizeof(uint64_t);
+    for (int c = 0; c < IndicatorStore::INT_COLUMN_COUNT; ++c)
+        len[COL_INT_FIRST + c] = rows * sizeof(int32_t);
+    len[COL_COUNT]          = rows * sizeof(int64_t);
+    len[COL_PRIVATE]        = rows * sizeof(uint8_t);
+    len[COL_CATEGORY_CODES] = rows * sizeof(uint32_t);
+    len[COL_GROUP_CODES]    = rows * sizeof(uint32_t);
+    len[COL_CATEGORY_DICT]  = dictionaryBytes(store.categoryDictionary());
+    len[COL_GROUP_DICT]     = dictionaryBytes(store.studentGroupDictionary());
+}
+
+static char* writeDictionary(char* dst, const std::vector<std::string>& dict) {
+    uint32_t n = static_cast<uint32_t>(dict.size());
+    std::memcpy(dst, &n, sizeof(n));
+    dst += sizeof(n);
+    for (const auto& s : dict) {
+        uint32_t len = static_cast<uint32_t>(s.size());
+        std::memcpy(dst, &len, sizeof(len));
+        dst += sizeof(len);
+        std::memcpy(dst, s.data(), len);
+        dst += len;
+    }
+    return dst;
+}
+
+// Parses a dictionary column; false if it runs past `length`.
+static bool readDictionary(const char* src, uint64_t length,
+                           std::vector<std::string_view>& out)
+{
+    out.clear();
+    const char* end = src + length;
+    uint32_t n = 0;
+    if (length < sizeof(n)) return false;
+    std::memcpy(&n, src, sizeof(n));
+    src += sizeof(n);
+    out.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t len = 0;
+        if (end - src < static_cast<std::ptrdiff_t>(sizeof(len))) return false;
+        std::memcpy(&len, src, sizeof(len));
+        src += sizeof(len);
+        if (end - src < static_cast<std::ptrdiff_t>(len)) return false;
+        out.emplace_back(src, len);
+        src += len;
+    }
+    return true;
+}
+
+// =============================================================================
+// SharedIndicatorPublisher
+// =============================================================================
+
+SharedIndicatorPublisher::~SharedIndicatorPublisher() {
+    close(false);
+}
+
+std::size_t SharedIndicatorPublisher::requiredSlotBytes(const IndicatorStore& store) {
+    uint64_t len[COL_TOTAL];
+    columnLengths(store, len);
+    std::size_t bytes = sizeof(SlotHeader);
+    for (int c = 0; c < COL_TOTAL; ++c)
+        bytes = alignUp(bytes, COLUMN_ALIGN) + len[c];
+    return bytes;
+}
+
+bool SharedIndicatorPublisher::create(const std::string& name, std::size_t slotBytes) {
+    close(false);
+
+    // Unlink first so readers still attached to a previous segment keep a
+    // consistent (if stale) mapping instead of seeing it truncated.
+    shm_unlink(name.c_str());
+    fd_ = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0) {
+        fprintf(stderr, "[SHM] shm_open(%s) failed: %s\n", name.c_str(), strerror(errno));
+        return false;
+    }
+    name_ = name;
+
+    slotBytes_ = alignUp(std::max(slotBytes, sizeof(SlotHeader)), HEADER_BYTES);
+    mapBytes_  = HEADER_BYTES + 2 * slotBytes_;
+    if (ftruncate(fd_, static_cast<off_t>(mapBytes_)) != 0) {
+        fprintf(stderr, "[SHM] ftruncate(%zu) failed: %s\n", mapBytes_, strerror(errno));
+        close(true);
+        return false;
+    }
+    base_ = mmap(nullptr, mapBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        fprintf(stderr, "[SHM] mmap failed: %s\n", strerror(errno));
+        close(true);
+        return false;
+    }
+
+    // ftruncate zero-fills, so the atomics start at 0; construct them
+    // in place to make their lifetime explicit.
+    auto* hdr = new (base_) SegmentHeader{};
+    std::memcpy(hdr->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    hdr->version    = SEGMENT_VERSION;
+    hdr->intColumns = IndicatorStore::INT_COLUMN_COUNT;
+    hdr->slotBytes  = slotBytes_;
+    for (int s = 0; s < 2; ++s)
+        new (static_cast<char*>(base_) + HEADER_BYTES + s * slotBytes_) SlotHeader{};
+    return true;
+}
+
+bool SharedIndicatorPublisher::publish(const IndicatorStore& store) {
+    if (!base_) {
+        fprintf(stderr, "[SHM] publish called before create\n");
+        return false;
+    }
+    const std::size_t need = requiredSlotBytes(store);
+    if (need > slotBytes_) {
+        fprintf(stderr, "[SHM] store needs %zu bytes but slots hold %zu — recreate larger\n",
+                need, slotBytes_);
+        return false;
+    }
+
+    auto* hdr = static_cast<SegmentHeader*>(base_);
+    const uint32_t target = 1u - hdr->activeSlot.load(std::memory_order_relaxed);
+    char* slotBase = static_cast<char*>(base_) + HEADER_BYTES + target * slotBytes_;
+    auto* slot = reinterpret_cast<SlotHeader*>(slotBase);
+
+    // Open the write window: odd sequence tells readers this slot is dirty.
+    const uint64_t seq = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t len[COL_TOTAL];
+    columnLengths(store, len);
+    std::size_t pos = sizeof(SlotHeader);
+    for (int c = 0; c < COL_TOTAL; ++c) {
+        pos = alignUp(pos, COLUMN_ALIGN);
+        slot->offset[c] = pos;
+        slot->length[c] = len[c];
+        pos += len[c];
+    }
+
+    auto put = [&](int c, const void* src) {
+        if (len[c]) std::memcpy(slotBase + slot->offset[c], src, len[c]);
+    };
+    put(COL_CDS, store.cds().data());
+    for (int c = 0; c < IndicatorStore::INT_COLUMN_COUNT; ++c)
+        put(COL_INT_FIRST + c, store.column(static_cast<IndicatorStore::IntColumn>(c)).data());
+    put(COL_COUNT,          store.count().data());
+    put(COL_PRIVATE,        store.isPrivateData().data());
+    put(COL_CATEGORY_CODES, store.categoryCodes().data());
+    put(COL_GROUP_CODES,    store.studentGroupCodes().data());
+    writeDictionary(slotBase + slot->offset[COL_CATEGORY_DICT], store.categoryDictionary());
+    writeDictionary(slotBase + slot->offset[COL_GROUP_DICT],    store.studentGroupDictionary());
+
+    slot->rows    = store.size();
+    slot->version = hdr->publishCount.load(std::memory_order_relaxed) + 1;
+
+    // Close the write window, then point readers at the new slot.
+    slot->sequence.store(seq + 2, std::memory_order_release);
+    hdr->activeSlot.store(target, std::memory_order_release);
+    hdr->publishCount.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void SharedIndicatorPublisher::close(bool unlink) {
+    if (base_) munmap(base_, mapBytes_);
+    if (fd_ >= 0) ::close(fd_);
+    if (unlink && !name_.empty()) shm_unlink(name_.c_str());
+    base_ = nullptr;
+    fd_   = -1;
+    mapBytes_ = slotBytes_ = 0;
+    name_.clear();
+}
+
+// =============================================================================
+// SharedIndicatorReader
+// =============================================================================
+
+SharedIndicatorReader::~SharedIndicatorReader() {
+    close();
+}
+
+bool SharedIndicatorReader::open(const std::string& name) {
+    close();
+    fd_ = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd_ < 0) {
+        fprintf(stderr, "[SHM] shm_open(%s) failed: %s\n", name.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd_, &st) != 0 || static_cast<std::size_t>(st.st_size) < HEADER_BYTES) {
+        fprintf(stderr, "[SHM] %s is not an indicator segment\n", name.c_str());
+        close();
+        return false;
+    }
+    mapBytes_ = static_cast<std::size_t>(st.st_size);
+    void* p = mmap(nullptr, mapBytes_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "[SHM] mmap failed: %s\n", strerror(errno));
+        close();
+        return false;
+    }
+    base_ = p;
+
+    const auto* hdr = static_cast<const SegmentHeader*>(base_);
+    if (std::memcmp(hdr->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 ||
+        hdr->version != SEGMENT_VERSION ||
+        hdr->intColumns != static_cast<uint32_t>(IndicatorStore::INT_COLUMN_COUNT) ||
+        HEADER_BYTES + 2 * hdr->slotBytes > mapBytes_) {
+        fprintf(stderr, "[SHM] %s has an incompatible layout\n", name.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SharedIndicatorReader::close() {
+    if (base_) munmap(const_cast<void*>(base_), mapBytes_);
+    if (fd_ >= 0) ::close(fd_);
+    base_     = nullptr;
+    fd_       = -1;
+    mapBytes_ = 0;
+}
+
+uint64_t SharedIndicatorReader::version() const {
+    if (!base_) return 0;
+    return static_cast<const SegmentHeader*>(base_)->publishCount.load(std::memory_order_acquire);
+}
+
+bool SharedIndicatorReader::acquire(SharedIndicatorView& view) const {
+    if (!base_) return false;
+    const auto* hdr = static_cast<const SegmentHeader*>(base_);
+    const uint64_t slotBytes = hdr->slotBytes;
+
+    for (int attempt = 0; attempt < ACQUIRE_ATTEMPTS; ++attempt) {
+        if (hdr->publishCount.load(std::memory_order_acquire) == 0) return false;
+
+        const uint32_t s = hdr->activeSlot.load(std::memory_order_acquire) & 1u;
+        const char* slotBase = static_cast<const char*>(base_) + HEADER_BYTES + s * slotBytes;
+        const auto* slot = reinterpret_cast<const SlotHeader*>(slotBase);
+
+        const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        if (seq & 1) { sched_yield(); continue; }
+
+        bool inBounds = true;
+        for (int c = 0; c < COL_TOTAL; ++c)
+            if (slot->offset[c] > slotBytes || slot->length[c] > slotBytes - slot->offset[c])
+                inBounds = false;
+
+        if (inBounds) {
+            auto at = [&](int c) { return slotBase + slot->offset[c]; };
+            view.slot     = s;
+            view.sequence = seq;
+            view.version  = slot->version;
+            view.rows     = slot->rows;
+            view.cds      = reinterpret_cast<const uint64_t*>(at(COL_CDS));
+            for (int c = 0; c < IndicatorStore::INT_COLUMN_COUNT; ++c)
+                view.ints[c] = reinterpret_cast<const int32_t*>(at(COL_INT_FIRST + c));
+            view.count             = reinterpret_cast<const int64_t*>(at(COL_COUNT));
+            view.isPrivateData     = reinterpret_cast<const uint8_t*>(at(COL_PRIVATE));
+            view.categoryCodes     = reinterpret_cast<const uint32_t*>(at(COL_CATEGORY_CODES));
+            view.studentGroupCodes = reinterpret_cast<const uint32_t*>(at(COL_GROUP_CODES));
+            inBounds = readDictionary(at(COL_CATEGORY_DICT), slot->length[COL_CATEGORY_DICT],
+                                      view.categoryDictionary) &&
+                       readDictionary(at(COL_GROUP_DICT), slot->length[COL_GROUP_DICT],
+                                      view.studentGroupDictionary);
+        }
+
+        // Anything read above is only trustworthy if the slot didn't change.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) == seq && inBounds)
+            return true;
+        sched_yield();
+    }
+    return false;
+}
+
+bool SharedIndicatorReader::validate(const SharedIndicatorView& view) const {
+    if (!base_) return false;
+    const auto* hdr = static_cast<const SegmentHeader*>(base_);
+    const auto* slot = reinterpret_cast<const SlotHeader*>(
+        static_cast<const char*>(base_) + HEADER_BYTES + view.slot * hdr->slotBytes);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
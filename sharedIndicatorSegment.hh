@@ -0,0 +1,93 @@
+#ifndef SHAREDINDICATORSEGMENT_H
+#define SHAREDINDICATORSEGMENT_H
+
+#include "indicatorStore.hh"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// =============================================================================
+// Shared-memory publication of an IndicatorStore.
+//
+// The publisher owns a POSIX shared-memory segment with two slots. Each
+// publish writes the store's columns into the inactive slot under that
+// slot's sequence counter (odd while writing), then flips the active slot.
+// Readers in other processes map the segment read-only and take zero-copy
+// views of the active slot; a view is consistent if the slot's sequence is
+// unchanged when the reader is done with it (seqlock protocol).
+// =============================================================================
+
+// Typed pointers into one slot of the mapping. Only meaningful until
+// SharedIndicatorReader::validate() says the slot was overwritten.
+struct SharedIndicatorView {
+    uint64_t        version  = 0;   // publish count that produced this slot
+    uint64_t        rows     = 0;
+    const uint64_t* cds      = nullptr;
+    const int32_t*  ints[IndicatorStore::INT_COLUMN_COUNT] = {};
+    const int64_t*  count    = nullptr;
+    const uint8_t*  isPrivateData     = nullptr;
+    const uint32_t* categoryCodes     = nullptr;
+    const uint32_t* studentGroupCodes = nullptr;
+    std::vector<std::string_view> categoryDictionary;
+    std::vector<std::string_view> studentGroupDictionary;
+
+    // Internal: slot index and the sequence observed at acquire time.
+    uint32_t slot     = 0;
+    uint64_t sequence = 0;
+};
+
+class SharedIndicatorPublisher {
+public:
+    static constexpr std::size_t DEFAULT_SLOT_BYTES = 256ull * 1024 * 1024;
+
+    ~SharedIndicatorPublisher();
+
+    // Creates (or replaces) the named segment, e.g. "/cadashboard". Each of
+    // the two slots holds up to slotBytes of column data.
+    bool create(const std::string& name, std::size_t slotBytes = DEFAULT_SLOT_BYTES);
+
+    // Copies the store into the inactive slot and makes it active. Fails if
+    // the store does not fit in a slot.
+    bool publish(const IndicatorStore& store);
+
+    // Unmaps the segment; unlink removes the name so new readers can't open it.
+    void close(bool unlink = true);
+
+    // Bytes a store needs in one slot.
+    static std::size_t requiredSlotBytes(const IndicatorStore& store);
+
+private:
+    std::string name_;
+    int         fd_        = -1;
+    void*       base_      = nullptr;
+    std::size_t mapBytes_  = 0;
+    std::size_t slotBytes_ = 0;
+};
+
+class SharedIndicatorReader {
+public:
+    ~SharedIndicatorReader();
+
+    bool open(const std::string& name);
+    void close();
+
+    // Fills `view` from the active slot. Retries briefly while the writer is
+    // mid-publish; returns false if nothing was ever published.
+    bool acquire(SharedIndicatorView& view) const;
+
+    // True if the slot behind `view` has not been rewritten since acquire().
+    // Check this after reading from a view, and re-acquire if it fails.
+    bool validate(const SharedIndicatorView& view) const;
+
+    // Number of publishes so far — cheap change detection for pollers.
+    uint64_t version() const;
+
+private:
+    int         fd_       = -1;
+    const void* base_     = nullptr;
+    std::size_t mapBytes_ = 0;
+};
+
+#endif // SHAREDINDICATORSEGMENT_H
@@ -0,0 +1,288 @@
+#include "sqliteExporter.hh"
+#include "perfRegions.hh"
+#include <sqlite3.h>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+
+// =============================================================================
+// Schema
+// =============================================================================
+
+namespace {
+
+// SQL type and bind conversion per member type, chosen the same way as
+// indicatorfields::toRecord: cdsCode is the numeric CDS, floats are rounded to
+// the fixed-point precision the API publishes, strings stay text.
+template <typename T, typename R>
+constexpr const char* sqlType() {
+    if constexpr (std::is_same_v<T, std::string> && !std::is_same_v<R, indicatorfields::none>)
+        return "INTEGER";
+    else if constexpr (std::is_same_v<T, std::string>)
+        return "TEXT";
+    else if constexpr (std::is_floating_point_v<T>)
+        return "REAL";
+    else
+        return "INTEGER";
+}
+
+template <typename T, typename R>
+inline void bindField(sqlite3_stmt* stmt, int index, const T& v) {
+    if constexpr (std::is_same_v<T, std::string> && !std::is_same_v<R, indicatorfields::none>)
+        sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(indicatorfields::parseCds(v)));
+    else if constexpr (std::is_same_v<T, std::string>)
+        sqlite3_bind_text(stmt, index, v.data(), static_cast<int>(v.size()), SQLITE_STATIC);
+    else if constexpr (std::is_floating_point_v<T>)
+        sqlite3_bind_double(stmt, index,
+                            static_cast<double>(std::lround(static_cast<double>(v) * indicatorfields::FIXED_SCALE))
+                                / indicatorfields::FIXED_SCALE);
+    else
+        sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(v));
+}
+
+// Binds every table field of `ind` starting at parameter `first`.
+inline void bindBlock(sqlite3_stmt* stmt, int first, const SummaryCard::indicator& ind) {
+    int index = first;
+#define X(type, member, key, rtype, roff, slot) bindField<type, rtype>(stmt, index++, ind.member);
+    INDICATOR_BLOCK_FIELDS(X)
+#undef X
+}
+
+// ", cdsCode INTEGER, status REAL, ..." and ", ?, ?, ..." for the field table.
+std::string fieldColumns() {
+    std::string s;
+#define X(type, member, key, rtype, roff, slot) (s += ", ") += std::string(key) + " " + sqlType<type, rtype>();
+    INDICATOR_BLOCK_FIELDS(X)
+#undef X
+    return s;
+}
+
+std::string fieldParams() {
+    std::string s;
+#define X(type, member, key, rtype, roff, slot) s += ", ?";
+    INDICATOR_BLOCK_FIELDS(X)
+#undef X
+    return s;
+}
+
+// Built by close(); dropped by open() so appends load without them.
+const char* const INDEXES[][2] = {
+    {"idx_cards_cds",            "CREATE INDEX IF NOT EXISTS idx_cards_cds ON cards(cds)"},
+    {"idx_cards_year",           "CREATE INDEX IF NOT EXISTS idx_cards_year ON cards(school_year_id)"},
+    {"idx_indicators_indicator", "CREATE INDEX IF NOT EXISTS idx_indicators_indicator ON indicators(indicator_id)"},
+};
+
+// Kept through loads: re-exporting a card replaces it, which looks up the
+// old card by key and deletes its indicators by card_id. New cards get
+// increasing card_ids, so maintaining these costs little.
+const char* const KEY_INDEXES =
+    "CREATE INDEX IF NOT EXISTS idx_indicators_card ON indicators(card_id);"
+    // Files written before cards were keyed may hold duplicates: keep the
+    // newest of each.
+    "DELETE FROM indicators WHERE card_id IN (SELECT card_id FROM cards WHERE card_id NOT IN "
+    "(SELECT MAX(card_id) FROM cards GROUP BY cds, school_year_id));"
+    "DELETE FROM cards WHERE card_id NOT IN (SELECT MAX(card_id) FROM cards GROUP BY cds, school_year_id);"
+    "CREATE UNIQUE INDEX IF NOT EXISTS idx_cards_key ON cards(cds, school_year_id);";
+
+} // namespace
+
+// =============================================================================
+// SqliteExporter
+// =============================================================================
+
+SqliteExporter::~SqliteExporter() {
+    if (db_) close();
+}
+
+bool SqliteExporter::fail(const char* what) {
+    failed_ = true;
+    std::cerr << "Error: SQLite " << what << ": " << (db_ ? sqlite3_errmsg(db_) : "no database") << std::endl;
+    return false;
+}
+
+bool SqliteExporter::exec(const char* sql) {
+    char* message = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &message) == SQLITE_OK) return true;
+    failed_ = true;
+    std::cerr << "Error: SQLite: " << (message ? message : "unknown error") << " (" << sql << ")" << std::endl;
+    sqlite3_free(message);
+    return false;
+}
+
+bool SqliteExporter::prepare(const char* sql, sqlite3_stmt** stmt) {
+    if (sqlite3_prepare_v3(db_, sql, -1, SQLITE_PREPARE_PERSISTENT, stmt, nullptr) == SQLITE_OK) return true;
+    return fail("prepare");
+}
+
+bool SqliteExporter::step(sqlite3_stmt* stmt) {
+    const int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (rc == SQLITE_DONE) return true;
+    return fail("insert");
+}
+
+bool SqliteExporter::rowsWritten(std::size_t rows) {
+    pendingRows_ += rows;
+    if (pendingRows_ < ROWS_PER_TRANSACTION) return true;
+    pendingRows_ = 0;
+    return exec("COMMIT; BEGIN");
+}
+
+bool SqliteExporter::open(const std::string& path) {
+    if (db_) close();
+    cards_ = indicators_ = pendingRows_ = 0;
+    failed_ = false;
+    statewideSeen_.clear();
+
+    if (sqlite3_open(path.c_str(), &db_) != SQLITE_OK) {
+        fail(("open " + path).c_str());
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return false;
+    }
+
+    // Nothing here is worth an fsync until close(): a failed load is rerun.
+    if (!exec("PRAGMA journal_mode = WAL;"
+              "PRAGMA synchronous = OFF;"
+              "PRAGMA temp_store = MEMORY;"
+              "PRAGMA cache_size = -262144;"))   // 256 MiB
+        return false;
+
+    const std::string fields = fieldColumns();
+    const std::string schema =
+        "CREATE TABLE IF NOT EXISTS schools ("
+        "cds INTEGER PRIMARY KEY, name TEXT, district TEXT, county TEXT);"
+        "CREATE TABLE IF NOT EXISTS cards ("
+        "card_id INTEGER PRIMARY KEY, cds INTEGER NOT NULL, school_year_id INTEGER, year TEXT);"
+        "CREATE TABLE IF NOT EXISTS indicators ("
+        "card_id INTEGER NOT NULL, indicator_id INTEGER, category TEXT" + fields + ");"
+        "CREATE TABLE IF NOT EXISTS statewide ("
+        "indicator_id INTEGER, category TEXT" + fields + ", "
+        "PRIMARY KEY (indicator_id, schoolYearId, studentGroup));";
+    if (!exec(schema.c_str()) || !exec(KEY_INDEXES)) return false;
+    for (const auto& index : INDEXES)
+        if (!exec(("DROP INDEX IF EXISTS " + std::string(index[0])).c_str())) return false;
+
+    const std::string params = fieldParams();
+    const std::string insertIndicator = "INSERT INTO indicators VALUES (?, ?, ?" + params + ")";
+    const std::string insertStatewide = "INSERT OR REPLACE INTO statewide VALUES (?, ?" + params + ")";
+    if (!prepare("INSERT OR IGNORE INTO schools VALUES (?, ?, ?, ?)", &insertSchool_) ||
+        !prepare("INSERT OR REPLACE INTO schools VALUES (?, ?, ?, ?)", &upsertSchool_) ||
+        !prepare("DELETE FROM indicators WHERE card_id IN "
+                 "(SELECT card_id FROM cards WHERE cds = ? AND school_year_id = ?)", &deleteIndicators_) ||
+        !prepare("INSERT OR REPLACE INTO cards VALUES (NULL, ?, ?, ?)", &insertCard_) ||
+        !prepare(insertIndicator.c_str(), &insertIndicator_) ||
+        !prepare(insertStatewide.c_str(), &insertStatewide_))
+        return false;
+
+    return exec("BEGIN");
+}
+
+bool SqliteExporter::addDirectory(const SchoolDirectory& directory) {
+    if (!db_ || failed_) return fail("addDirectory");
+    PerfRegion region("sqlite_directory");
+    for (std::size_t row = 0; row < directory.size(); ++row) {
+        const std::string_view name     = directory.get(row, SchoolDirectory::SCHOOL);
+        const std::string_view district = directory.get(row, SchoolDirectory::DISTRICT);
+        const std::string_view county   = directory.get(row, SchoolDirectory::COUNTY);
+        sqlite3_bind_int64(upsertSchool_, 1, static_cast<sqlite3_int64>(directory.cds(row)));
+        sqlite3_bind_text(upsertSchool_, 2, name.data(), static_cast<int>(name.size()), SQLITE_STATIC);
+        sqlite3_bind_text(upsertSchool_, 3, district.data(), static_cast<int>(district.size()), SQLITE_STATIC);
+        sqlite3_bind_text(upsertSchool_, 4, county.data(), static_cast<int>(county.size()), SQLITE_STATIC);
+        if (!step(upsertSchool_) || !rowsWritten(1)) return false;
+    }
+    return true;
+}
+
+bool SqliteExporter::addCard(const SummaryCard& card) {
+    if (!db_ || failed_) return fail("addCard");
+    const auto& indicators = card.getIndicatorVector();
+    if (indicators.empty()) return true;
+
+    const sqlite3_int64 cds = static_cast<sqlite3_int64>(indicatorfields::parseCds(indicators.front().cdsCode));
+    sqlite3_bind_int64(insertSchool_, 1, cds);
+    sqlite3_bind_text(insertSchool_, 2, card.schoolName.data(), static_cast<int>(card.schoolName.size()),
+                      SQLITE_STATIC);
+    if (!step(insertSchool_)) return false;
+
+    // A card already in the file (an earlier export of the same CDS and
+    // year) is replaced along with its indicators.
+    const sqlite3_int64 schoolYearId = static_cast<sqlite3_int64>(indicators.front().schoolYearId);
+    sqlite3_bind_int64(deleteIndicators_, 1, cds);
+    sqlite3_bind_int64(deleteIndicators_, 2, schoolYearId);
+    if (!step(deleteIndicators_)) return false;
+
+    sqlite3_bind_int64(insertCard_, 1, cds);
+    sqlite3_bind_int64(insertCard_, 2, schoolYearId);
+    sqlite3_bind_text(insertCard_, 3, card.year.data(), static_cast<int>(card.year.size()), SQLITE_STATIC);
+    if (!step(insertCard_)) return false;
+    const sqlite3_int64 cardId = sqlite3_last_insert_rowid(db_);
+    ++cards_;
+
+    for (const auto& ind : indicators) {
+        sqlite3_bind_int64(insertIndicator_, 1, cardId);
+        sqlite3_bind_int64(insertIndicator_, 2, static_cast<sqlite3_int64>(ind.indicatorId));
+        sqlite3_bind_text(insertIndicator_, 3, ind.indicatorCategory.data(),
+                          static_cast<int>(ind.indicatorCategory.size()), SQLITE_STATIC);
+        bindBlock(insertIndicator_, 4, ind);
+        if (!step(insertIndicator_)) return false;
+        ++indicators_;
+
+        // Every card of a year carries the same statewide block; only the
+        // first one for each key is parsed and inserted.
+        if (!ind.secondary.is_object()) continue;
+        std::size_t schoolYearId = 0;
+        std::string studentGroup;
+        indicatorfields::readJson(ind.secondary, "schoolYearId", schoolYearId);
+        indicatorfields::readJson(ind.secondary, "studentGroup", studentGroup);
+        if (!statewideSeen_.emplace(ind.indicatorId, schoolYearId, std::move(studentGroup)).second) continue;
+        SummaryCard::indicator block;
+        SummaryCard::parseBlock(ind.secondary, block);
+        sqlite3_bind_int64(insertStatewide_, 1, static_cast<sqlite3_int64>(ind.indicatorId));
+        sqlite3_bind_text(insertStatewide_, 2, ind.indicatorCategory.data(),
+                          static_cast<int>(ind.indicatorCategory.size()), SQLITE_STATIC);
+        bindBlock(insertStatewide_, 3, block);
+        if (!step(insertStatewide_)) return false;
+    }
+    return rowsWritten(indicators.size() + 1);
+}
+
+bool SqliteExporter::addCards(const std::vector<SummaryCard>& cards) {
+    PerfRegion region("sqlite_cards");
+    for (const auto& card : cards)
+        if (!addCard(card)) return false;
+    return true;
+}
+
+bool SqliteExporter::close(bool commit) {
+    if (!db_) return true;
+    const bool keep = commit && !failed_;
+    bool ok = keep;
+    for (sqlite3_stmt* stmt : {insertSchool_, upsertSchool_, deleteIndicators_, insertCard_, insertIndicator_,
+                               insertStatewide_})
+        sqlite3_finalize(stmt);
+    insertSchool_ = upsertSchool_ = deleteIndicators_ = insertCard_ = insertIndicator_ = insertStatewide_ = nullptr;
+
+    // After a failure the open transaction may hold half a card (its old
+    // indicators deleted, only some new ones inserted): roll back to the
+    // last batch boundary instead. Earlier batches stay, and the indexes
+    // are rebuilt either way.
+    if (sqlite3_get_autocommit(db_) == 0) {
+        if (keep) ok = exec("COMMIT") && ok;
+        else      exec("ROLLBACK");
+    }
+    {
+        PerfRegion region("sqlite_index");
+        for (const auto& index : INDEXES) ok = exec(index[1]) && ok;
+        ok = exec("ANALYZE") && ok;
+    }
+    // synchronous is per connection, so this only affects the checkpoint
+    // below: with NORMAL it is fsynced, and the load is durable once close()
+    // returns. The WAL is folded into the main database.
+    ok = exec("PRAGMA synchronous = NORMAL; PRAGMA wal_checkpoint(TRUNCATE);") && ok;
+
+    sqlite3_close(db_);
+    db_ = nullptr;
+    return ok;
+}
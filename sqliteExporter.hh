@@ -0,0 +1,86 @@
+#ifndef SQLITEEXPORTER_H
+#define SQLITEEXPORTER_H
+
+#include "schoolDirectory.hh"
+#include "summaryCard.hh"
+#include <cstddef>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// =============================================================================
+// SqliteExporter — bulk loader for SQLite.
+//
+//   schools     (cds PK, name, district, county)
+//   cards       (card_id PK, cds, school_year_id, year; UNIQUE (cds, school_year_id))
+//   indicators  (card_id, indicator_id, category, <primary block fields>)
+//   statewide   (indicator_id, school_year_id, student_group PK, <fields>)
+//
+// Indicator columns come from INDICATOR_BLOCK_FIELDS, like every other
+// exporter. The statewide "secondary" block is identical on every card of a
+// year, so it is stored once per (indicator, year, group) instead of per card.
+//
+// Loading is tuned for throughput: WAL journal with synchronous=OFF for
+// the load, one prepared statement per table reused for every row, a
+// transaction per ROWS_PER_TRANSACTION rows, and secondary indexes built
+// by close() once the data is in. Appending to an existing file works; the
+// indexes are then dropped for the load and rebuilt afterwards. A card
+// exported again (same CDS and year) replaces the earlier copy.
+// =============================================================================
+
+class SqliteExporter {
+public:
+    static constexpr std::size_t ROWS_PER_TRANSACTION = 100000;
+
+    SqliteExporter() = default;
+    ~SqliteExporter();
+    SqliteExporter(const SqliteExporter&)            = delete;
+    SqliteExporter& operator=(const SqliteExporter&) = delete;
+
+    // Opens or creates `path` and starts the load.
+    bool open(const std::string& path);
+
+    // Name, district and county for every school in the directory.
+    bool addDirectory(const SchoolDirectory& directory);
+    // One card with its indicators; the school is added from the card's
+    // metadata if the directory did not already supply it.
+    bool addCard(const SummaryCard& card);
+    bool addCards(const std::vector<SummaryCard>& cards);
+
+    // Commits, builds the indexes, makes the load durable and closes. With
+    // `commit` false, or after any add failed, the open batch is rolled back
+    // instead and close() returns false; batches committed earlier stay.
+    bool close(bool commit = true);
+
+    std::size_t cardsWritten() const      { return cards_; }
+    std::size_t indicatorsWritten() const { return indicators_; }
+
+private:
+    bool exec(const char* sql);
+    bool prepare(const char* sql, sqlite3_stmt** stmt);
+    bool step(sqlite3_stmt* stmt);
+    // Counts the rows of a finished card (or directory row) and commits
+    // every ROWS_PER_TRANSACTION rows, so a batch never ends mid-card.
+    bool rowsWritten(std::size_t rows);
+    bool fail(const char* what);
+
+    sqlite3*      db_            = nullptr;
+    sqlite3_stmt* insertSchool_  = nullptr;   // INSERT OR IGNORE (card metadata)
+    sqlite3_stmt* upsertSchool_  = nullptr;   // INSERT OR REPLACE (directory)
+    sqlite3_stmt* deleteIndicators_ = nullptr;   // of a card about to be replaced
+    sqlite3_stmt* insertCard_    = nullptr;   // INSERT OR REPLACE on (cds, school_year_id)
+    sqlite3_stmt* insertIndicator_ = nullptr;
+    sqlite3_stmt* insertStatewide_ = nullptr;
+    std::size_t   pendingRows_   = 0;
+    std::size_t   cards_         = 0;
+    std::size_t   indicators_    = 0;
+    bool          failed_        = false;   // set by fail(); close() then rolls back
+    // (indicatorId, schoolYearId, studentGroup) of statewide rows written.
+    std::set<std::tuple<std::size_t, std::size_t, std::string>> statewideSeen_;
+};
+
+#endif // SQLITEEXPORTER_H
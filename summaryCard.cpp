@@ -1,5 +1,10 @@
 #include "summaryCard.hh"
+#include "cardRecord.hh"
+#include "perfRegions.hh"
+#include "tracepoints.hh"
+#include "payloadCompressor.hh"
 #include <fstream>
+#include <sstream>
 #include <iostream>
 
 using json = nlohmann::json;
@@ -40,6 +45,8 @@ void SummaryCard::appendRawData(const char* data, size_t size) {
 
 void SummaryCard::parseRawData() {
     if (rawData.empty()) return;
+    PerfRegion region("json_parse");
+    CADASH_PROBE1(parse_start, rawData.size());
     // we safely go in and try to parseRawData input 
     try {
         rawJsonData     = json::parse(rawData);
@@ -50,17 +57,56 @@ void SummaryCard::parseRawData() {
         std::cerr << "JSON Parse Error: " << e.what() << std::endl;
         rawJsonData = json::array();
     }
+    CADASH_PROBE2(parse_done, rawData.size(), indicatorVector.size());
+}
+
+void SummaryCard::setJsonData(const json& data) {
+    rawData.clear();
+    categoryToIndicatorMap.clear();
+    rawJsonData     = data;
+    indicatorVector = parseIndicators(rawJsonData);
 }
 
 void SummaryCard::clear() {
     rawData.clear();
+    compressedRawData.clear();
+    recordData.clear();
     rawJsonData.clear();
-    indicatorsMap.clear();
     indicatorVector.clear();
     categoryToIndicatorMap.clear();
     schoolName.clear();
     year.clear();
 }
+bool SummaryCard::compressRawData(const PayloadCompressor& compressor) {
+    if (rawData.empty()) return false;
+    std::string packed;
+    if (!compressor.compress(rawData, packed)) return false;
+    compressedRawData = std::move(packed);
+    std::string().swap(rawData); // release the buffer, not just the length
+    return true;
+}
+
+bool SummaryCard::restoreRawData(const PayloadCompressor& compressor) {
+    if (compressedRawData.empty()) return !rawData.empty();
+    std::string unpacked;
+    if (!compressor.decompress(compressedRawData, unpacked)) {
+        std::cerr << "Error: Could not decompress retained raw data." << std::endl;
+        return false;
+    }
+    rawData = std::move(unpacked);
+    compressedRawData.clear();
+    return true;
+}
+
+std::string SummaryCard::categoryName(size_t indicatorId) {
+    auto it = indicatorsMap.find(static_cast<int>(indicatorId));
+    return (it != indicatorsMap.end()) ? it->second : "UNKNOWN";
+}
+
+void SummaryCard::buildRecord() {
+    CardRecordBuilder::build(*this, recordData);
+}
+
 // This helpful function will help make sure we can assign a card a schoolName and year. 
 // This can only be done by the caller since the summary cards and json do not have 
 // this information within the data. 
@@ -81,7 +127,7 @@ const json& SummaryCard::getRawJsonData() const {
     return rawJsonData;
 }
 
-std::vector<SummaryCard::indicator> SummaryCard::getIndicatorVector() const {
+const std::vector<SummaryCard::indicator>& SummaryCard::getIndicatorVector() const {
     return indicatorVector;
 }
 
@@ -116,26 +162,30 @@ bool SummaryCard::printIndicatorVector() const {
                   << "=============================\n";
     }
 
+    // Formatted locally so std::boolalpha does not stick to std::cout.
+    std::ostringstream out;
+    out << std::boolalpha;
     for (const auto& ind : indicatorVector) {
-        std::cout << "-----------------------------\n"
-                  << "Category:     " << ind.indicatorCategory << "\n"
-                  << "CDS Code:     " << ind.cdsCode           << "\n"
-                  << "Indicator ID: " << ind.indicatorId       << "\n"
-                  << "Status:       " << ind.status            << "\n"
-                  << "Change:       " << ind.change            << "\n"
-                  << "Status ID:    " << ind.statusId          << "\n"
-                  << "Performance:  " << ind.performance       << "\n"
-                  << "Total Groups: " << ind.totalGroups       << "\n"
-                  << "Count:        " << ind.count             << "\n"
-                  << "Student Group:" << ind.studentGroup      << "\n"
-                  << "Colors:       "
-                  << "R=" << ind.red    << " "
-                  << "O=" << ind.orange << " "
-                  << "Y=" << ind.yellow << " "
-                  << "G=" << ind.green  << " "
-                  << "B=" << ind.blue   << "\n"
-                  << "Private Data: " << std::boolalpha << ind.isPrivateData << "\n";
+        out << "-----------------------------\n"
+            << "Category:     " << ind.indicatorCategory << "\n"
+            << "CDS Code:     " << ind.cdsCode           << "\n"
+            << "Indicator ID: " << ind.indicatorId       << "\n"
+            << "Status:       " << ind.status            << "\n"
+            << "Change:       " << ind.change            << "\n"
+            << "Status ID:    " << ind.statusId          << "\n"
+            << "Performance:  " << ind.performance       << "\n"
+            << "Total Groups: " << ind.totalGroups       << "\n"
+            << "Count:        " << ind.count             << "\n"
+            << "Student Group:" << ind.studentGroup      << "\n"
+            << "Colors:       "
+            << "R=" << ind.red    << " "
+            << "O=" << ind.orange << " "
+            << "Y=" << ind.yellow << " "
+            << "G=" << ind.green  << " "
+            << "B=" << ind.blue   << "\n"
+            << "Private Data: " << ind.isPrivateData << "\n";
     }
+    std::cout << out.str();
     return true;
 }
 
@@ -168,47 +218,56 @@ bool SummaryCard::loadFromFile(const std::string& filename) {
     return true;
 }
 
-// =============================================================================
-// Parsing Helpers
-// =============================================================================
-
-static std::string safeString(const json& obj, const std::string& key,
-                               const std::string& defaultVal = "") {
-    if (!obj.contains(key) || obj[key].is_null()) return defaultVal;
-    if (obj[key].is_string()) return obj[key].get<std::string>();
-    return obj[key].dump();
-}
-
-static int safeInt(const json& obj, const std::string& key, int defaultVal = 0) {
-    if (!obj.contains(key) || obj[key].is_null()) return defaultVal;
-    if (obj[key].is_number()) return obj[key].get<int>();
-    return defaultVal;
+bool SummaryCard::saveCompressed(const std::string& filename,
+                                 const PayloadCompressor& compressor) const {
+    std::string packed;
+    if (!compressedRawData.empty()) {
+        packed = compressedRawData;
+    } else if (!compressor.compress(rawData.empty() ? rawJsonData.dump() : rawData, packed)) {
+        return false;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        return false;
+    }
+    file.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+    if (file.fail()) {
+        std::cerr << "Error: Failed to write to file: " << filename << std::endl;
+        return false;
+    }
+    return true;
 }
 
-static long safeLong(const json& obj, const std::string& key, long defaultVal = 0L) {
-    if (!obj.contains(key) || obj[key].is_null()) return defaultVal;
-    if (obj[key].is_number()) return obj[key].get<long>();
-    return defaultVal;
+bool SummaryCard::loadCompressed(const std::string& filename,
+                                 const PayloadCompressor& compressor) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        return false;
+    }
+    std::string packed((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    std::string content;
+    if (!compressor.decompress(packed, content)) {
+        std::cerr << "Error: Could not decompress archive: " << filename << std::endl;
+        return false;
+    }
+    setRawData(content);
+    parseRawData();
+    return true;
 }
 
-static size_t safeSizeT(const json& obj, const std::string& key, size_t defaultVal = 0) {
-    if (!obj.contains(key) || obj[key].is_null()) return defaultVal;
-    if (obj[key].is_number_unsigned()) return obj[key].get<size_t>();
-    if (obj[key].is_number())          return static_cast<size_t>(obj[key].get<long>());
-    return defaultVal;
-}
+// =============================================================================
+// Parsing Helpers
+// =============================================================================
 
-static float safeFloat(const json& obj, const std::string& key, float defaultVal = 0.0f) {
-    if (!obj.contains(key) || obj[key].is_null()) return defaultVal;
-    if (obj[key].is_number()) return obj[key].get<float>();
-    return defaultVal;
+void SummaryCard::parseBlock(const json& block, indicator& ind) {
+#define X(type, member, key, rtype, roff, slot) indicatorfields::readJson(block, key, ind.member);
+    INDICATOR_BLOCK_FIELDS(X)
+#undef X
 }
 
-static bool safeBool(const json& obj, const std::string& key, bool defaultVal = false) {
-    if (!obj.contains(key) || obj[key].is_null()) return defaultVal;
-    if (obj[key].is_boolean()) return obj[key].get<bool>();
-    return defaultVal;
-}
 // The following is used to build an indicator from the json we get from the California Dashboard
 SummaryCard::indicator SummaryCard::parseIndicator(const json& entry) {
     indicator ind;
@@ -218,34 +277,17 @@ SummaryCard::indicator SummaryCard::parseIndicator(const json& entry) {
         std::cerr << "[WARN] parseIndicator: entry is not a JSON object, skipping.\n";
         return ind;
     }
-    // We go ahead and use safe parsers to ensure we properly populate the indicator data
-    ind.indicatorId = safeSizeT(entry, "indicatorId");
-
-    auto it = indicatorsMap.find(static_cast<int>(ind.indicatorId));
-    ind.indicatorCategory = (it != indicatorsMap.end()) ? it->second : "UNKNOWN";
+    indicatorfields::readJson(entry, "indicatorId", ind.indicatorId);
+    ind.indicatorCategory = categoryName(ind.indicatorId);
 
-    ind.primary   = entry.contains("primary")   ? entry["primary"]   : json(nullptr);
-    ind.secondary = entry.contains("secondary") ? entry["secondary"] : json(nullptr);
+    auto primary   = entry.find("primary");
+    auto secondary = entry.find("secondary");
+    ind.primary   = primary   != entry.end() ? *primary   : json(nullptr);
+    ind.secondary = secondary != entry.end() ? *secondary : json(nullptr);
 
-    const json& p = ind.primary;
     // we build our indicator and populate all of our fields
-    if (!p.is_null() && p.is_object()) {
-        ind.cdsCode       = safeString(p, "cdsCode");
-        ind.status        = safeFloat (p, "status");
-        ind.change        = safeFloat (p, "change");
-        ind.changeId      = safeInt   (p, "changeId");
-        ind.statusId      = safeInt   (p, "statusId");
-        ind.performance   = safeInt   (p, "performance");
-        ind.totalGroups   = safeSizeT (p, "totalGroups");
-        ind.red           = safeInt   (p, "red");
-        ind.orange        = safeInt   (p, "orange");
-        ind.yellow        = safeInt   (p, "yellow");
-        ind.green         = safeInt   (p, "green");
-        ind.blue          = safeInt   (p, "blue");
-        ind.count         = safeLong  (p, "count");
-        ind.studentGroup  = safeString(p, "studentGroup");
-        ind.schoolYearId  = safeSizeT (p, "schoolYearId");
-        ind.isPrivateData = safeBool  (p, "isPrivateData");
+    if (ind.primary.is_object()) {
+        parseBlock(ind.primary, ind);
     } else {
         std::cerr << "[WARN] parseIndicator: missing or null 'primary' block "
                   << "for indicatorId=" << ind.indicatorId << "\n";
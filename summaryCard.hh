@@ -1,13 +1,16 @@
 #ifndef SUMMARYCARD_H
 #define SUMMARYCARD_H
+#include "indicatorFields.hh"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
 #include <map>
 
+class PayloadCompressor;
+
 class SummaryCard {
     // A helpful map to use for lookup of indciatorIDs to category
-    std::map<int, std::string> indicatorsMap = {
+    static inline const std::map<int, std::string> indicatorsMap = {
         {1, "CHRONIC_ABSENTEEISM"},
         {2, "SUSPENSION_RATE"},
         {3, "ENGLISH_LEARNER_PROGRESS"},
@@ -17,32 +20,30 @@ class SummaryCard {
         {7, "MATHEMATICS"},
         {8, "SCIENCE"}
     };
-    // our indicator struct to hold all the following data. 
+
+public:
+    // Category name for an indicatorId, or "UNKNOWN".
+    static std::string categoryName(size_t indicatorId);
+
+    // our indicator struct to hold all the following data. The per-block
+    // fields come from the table in indicatorFields.hh.
     struct indicator {
         std::string indicatorCategory;
         nlohmann::json primary;
         nlohmann::json secondary;
-        std::string cdsCode;
-        size_t indicatorId;
-        float status;
-        float change;
-        int changeId;
-        int statusId;
-        int performance;
-        size_t totalGroups;
-        int red;
-        int orange;
-        int yellow;
-        int green;
-        int blue;
-        long count;
-        std::string studentGroup;
-        size_t schoolYearId;
-        bool isPrivateData;
+        size_t indicatorId = 0;
+#define X(type, member, key, rtype, roff, slot) type member{};
+        INDICATOR_BLOCK_FIELDS(X)
+#undef X
     };
 
+    // Fills the table fields of `ind` from one "primary"/"secondary" object.
+    static void parseBlock(const nlohmann::json& block, indicator& ind);
+
 private:
     std::string rawData;
+    std::string compressedRawData; // zstd frame while rawData is compacted
+    std::string recordData;        // CardRecord image, built on request
     nlohmann::json rawJsonData;
     std::vector<SummaryCard::indicator> indicatorVector;
     SummaryCard::indicator parseIndicator(const nlohmann::json& entry);
@@ -59,6 +60,13 @@ public:
     SummaryCard();
     explicit SummaryCard(const std::string& jsonString);
 
+    // Copy and move — declared explicitly because the user-declared
+    // destructor would otherwise suppress the implicit move operations.
+    SummaryCard(const SummaryCard&)            = default;
+    SummaryCard(SummaryCard&&)                 = default;
+    SummaryCard& operator=(const SummaryCard&) = default;
+    SummaryCard& operator=(SummaryCard&&)      = default;
+
     // Destructor
     ~SummaryCard();
 
@@ -66,15 +74,30 @@ public:
     void setRawData(const std::string& data);
     void appendRawData(const char* data, size_t size);
     void parseRawData();
+    // Replaces the parsed data with an already-decoded JSON document and
+    // rebuilds the indicators from it. rawData is left empty.
+    void setJsonData(const nlohmann::json& data);
     void clear();
 
+    // Retained rawData compaction. compressRawData() swaps rawData for a
+    // dictionary-compressed copy; restoreRawData() brings it back.
+    bool compressRawData(const PayloadCompressor& compressor);
+    bool restoreRawData(const PayloadCompressor& compressor);
+    bool isRawDataCompressed() const { return !compressedRawData.empty(); }
+    const std::string& getCompressedRawData() const { return compressedRawData; }
+
+    // Builds the binary CardRecord image of the parsed indicators (see
+    // cardRecord.hh). Empty until buildRecord() is called.
+    void buildRecord();
+    const std::string& getRecord() const { return recordData; }
+
     // Stamps school name and year onto the card after fetching.
     void setMetadata(const std::string& school, const std::string& yr);
 
     // Getters
     const std::string& getRawData() const;
     const nlohmann::json& getRawJsonData() const;
-    std::vector<SummaryCard::indicator> getIndicatorVector() const;
+    const std::vector<SummaryCard::indicator>& getIndicatorVector() const;
     const std::map<std::string, SummaryCard::indicator>& getCategoryMap() const;
 
     // Print
@@ -84,6 +107,10 @@ public:
     // Export and import
     bool saveToFile(const std::string& filename) const;
     bool loadFromFile(const std::string& filename);
+
+    // Compressed archive variants of saveToFile/loadFromFile.
+    bool saveCompressed(const std::string& filename, const PayloadCompressor& compressor) const;
+    bool loadCompressed(const std::string& filename, const PayloadCompressor& compressor);
 };
 
 #endif // SUMMARYCARD_H
@@ -0,0 +1,49 @@
+#ifndef TRACEPOINTS_H
+#define TRACEPOINTS_H
+
+// =============================================================================
+// USDT static tracepoints (provider "cadashboard").
+//
+// Each probe compiles to a single nop plus an ELF note describing where its
+// arguments live, so an unattached probe costs nothing measurable. Attach
+// with bpftrace, e.g.
+//
+//   bpftrace -e 'usdt:./main:cadashboard:transfer_done { @[arg2] = count(); }'
+//
+// Probes (arguments in order):
+//   job_enqueue     url, queue_depth
+//   job_dequeue     url, queue_remaining (0 when streaming)
+//   token_acquired  url
+//   transfer_start  url, attempt
+//   transfer_done   url, attempt, curl_code, http_status, body_bytes
+//   retry           url, attempt, delay_ms, curl_code
+//   parse_start     body_bytes
+//   parse_done      body_bytes, indicator_count
+//   card_stored     indicator_count, destination (0 = results vector, 1 = spill store,
+//                   2 = streaming sink)
+//   cache_lookup    key, source (0 = hit, 1 = miss, 2 = coalesced)
+//
+// Without <sys/sdt.h> (systemtap-sdt-dev) the macros expand to nothing.
+// Define CADASHBOARD_NO_USDT to compile them out regardless.
+// =============================================================================
+
+#if !defined(CADASHBOARD_NO_USDT) && defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#    include <sys/sdt.h>
+#    define CADASHBOARD_HAVE_USDT 1
+#  endif
+#endif
+
+#ifdef CADASHBOARD_HAVE_USDT
+#  define CADASH_PROBE1(name, a)                DTRACE_PROBE1(cadashboard, name, a)
+#  define CADASH_PROBE2(name, a, b)             DTRACE_PROBE2(cadashboard, name, a, b)
+#  define CADASH_PROBE4(name, a, b, c, d)       DTRACE_PROBE4(cadashboard, name, a, b, c, d)
+#  define CADASH_PROBE5(name, a, b, c, d, e)    DTRACE_PROBE5(cadashboard, name, a, b, c, d, e)
+#else
+#  define CADASH_PROBE1(name, a)                do {} while (0)
+#  define CADASH_PROBE2(name, a, b)             do {} while (0)
+#  define CADASH_PROBE4(name, a, b, c, d)       do {} while (0)
+#  define CADASH_PROBE5(name, a, b, c, d, e)    do {} while (0)
+#endif
+
+#endif // TRACEPOINTS_H